@@ -0,0 +1,119 @@
+// Inbound decode throughput, end to end: a raw frame client (the phi-core side
+// of the socket) streams request frames while the dispatcher decodes them into
+// typed requests on the poll thread. Prints MB/s of payload per frame shape.
+//
+//     ./sdk_inbound_parse_bench
+//     PHI_ADAPTER_SDK_JSON_SCAN=scalar ./sdk_inbound_parse_bench
+#include "json_scan.h"
+#include "phi/adapter/sdk/sidecar.h"
+#include "phi/adapter/v1/ipc_command.h"
+#include "test_support.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace sdk = phicore::adapter::sdk;
+namespace v1 = phicore::adapter::v1;
+using phitest::TestClient;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct BenchCase {
+    const char *name;
+    std::string body;
+    int frames;
+};
+
+std::string cmd(v1::IpcCommand command)
+{
+    return std::to_string(v1::toUint16(command));
+}
+
+// Config-shaped JSON: an array of discovery/device records with string-heavy
+// members and the occasional escape, as staticConfig and params carry them.
+std::string configObject(std::size_t records)
+{
+    std::string out = "{\"devices\":[";
+    for (std::size_t i = 0; i < records; ++i) {
+        if (i != 0)
+            out += ',';
+        const std::string n = std::to_string(i);
+        out += "{\"id\":\"dev-" + n + "\",\"name\":\"Living Room Light \\\"" + n
+            + "\\\"\",\"model\":\"LTG-002\",\"manufacturer\":\"Acme Lighting GmbH\","
+              "\"address\":\"00:17:88:01:0a:" + n + "\",\"enabled\":true,\"level\":" + n
+            + ",\"tags\":[\"light\",\"dimmable\",\"color\"]}";
+    }
+    out += "]}";
+    return out;
+}
+
+double runCase(const BenchCase &bench)
+{
+    const std::string path = phitest::uniqueSocketPath("bench");
+    sdk::SidecarDispatcher dispatcher(path);
+    TestClient client;
+    bool connected = false;
+    int seen = 0;
+
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected = true; };
+    handlers.onChannelInvoke = [&seen](const sdk::ChannelInvokeRequest &) { ++seen; };
+    handlers.onAdapterActionInvoke = [&seen](const sdk::AdapterActionInvokeRequest &) { ++seen; };
+    handlers.onConfigChanged = [&seen](const sdk::ConfigChangedRequest &) { ++seen; };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    if (!dispatcher.start(&err) || !client.connectTo(path))
+        return 0.0;
+    while (!connected)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+
+    const auto t0 = Clock::now();
+    std::thread sender([&client, &bench]() {
+        for (int i = 0; i < bench.frames; ++i)
+            client.sendFrame(v1::MessageType::Request, static_cast<std::uint64_t>(i + 1), bench.body);
+    });
+    while (seen < bench.frames)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    sender.join();
+    dispatcher.stop();
+
+    const double megabytes = static_cast<double>(bench.body.size()) * bench.frames / 1e6;
+    return megabytes / seconds;
+}
+
+} // namespace
+
+int main()
+{
+    const BenchCase cases[] = {
+        {"channel_invoke",
+         "{\"command\":" + cmd(v1::IpcCommand::CmdChannelInvoke)
+             + ",\"cmdId\":1,\"payload\":{\"externalId\":\"inst-1\",\"deviceExternalId\":\"dev-9\","
+               "\"channelExternalId\":\"ch-2\",\"value\":42.5}}",
+         200000},
+        {"action_params_4k",
+         "{\"command\":" + cmd(v1::IpcCommand::CmdAdapterActionInvoke)
+             + ",\"cmdId\":1,\"payload\":{\"externalId\":\"inst-1\",\"actionId\":\"import\",\"params\":"
+             + configObject(20) + "}}",
+         50000},
+        {"config_changed_1m",
+         "{\"command\":" + cmd(v1::IpcCommand::SyncAdapterConfigChanged)
+             + ",\"cmdId\":1,\"payload\":{\"adapterId\":42,\"externalId\":\"inst-1\",\"staticConfig\":"
+             + configObject(5000) + "}}",
+         200},
+    };
+
+    std::printf("inbound_parse_bench: scanner kernel %s\n",
+                sdk::json::StructuralIndex::kernelName(sdk::json::StructuralIndex::activeKernel()));
+    for (const BenchCase &bench : cases) {
+        const double mbPerSecond = runCase(bench);
+        std::printf("%-20s %8zu B/frame %8d frames %10.1f MB/s\n",
+                    bench.name, bench.body.size(), bench.frames, mbPerSecond);
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Instance execution backends at scale: the default one thread per instance
+// against the shared worker pool (createPooledInstanceExecutionBackend). For
+// 10, 100 and 1000 started instances prints the process thread count, RSS and
+// virtual size, then the latency from execute() to task start and the task
+// rate while every instance receives one task per round.
+//
+// Each configuration runs in a forked child so thread count and memory are
+// measured from a clean process.
+//
+//     ./sdk_instance_execution_bench
+#include "phi/adapter/sdk/sidecar.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace sdk = phicore::adapter::sdk;
+namespace v1 = phicore::adapter::v1;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// Exposes the factory default, i.e. the dedicated-thread backend.
+class ThreadBackendSource final : public sdk::AdapterFactory
+{
+public:
+    using sdk::AdapterFactory::createInstanceExecutionBackend;
+
+protected:
+    v1::Utf8String pluginType() const override { return "bench.execution"; }
+    std::unique_ptr<sdk::AdapterInstance> createInstance(const v1::ExternalId &) override { return nullptr; }
+};
+
+// Value of a `/proc/self/status` line such as `Threads:` or `VmRSS:` (kB).
+long procStatus(const char *key)
+{
+    FILE *file = std::fopen("/proc/self/status", "r");
+    if (!file)
+        return -1;
+    char line[256];
+    long value = -1;
+    const std::size_t keyLen = std::strlen(key);
+    while (std::fgets(line, sizeof(line), file)) {
+        if (std::strncmp(line, key, keyLen) == 0) {
+            value = std::strtol(line + keyLen, nullptr, 10);
+            break;
+        }
+    }
+    std::fclose(file);
+    return value;
+}
+
+void runConfig(bool pooled, std::size_t instances)
+{
+    ThreadBackendSource factory;
+    std::vector<std::unique_ptr<sdk::InstanceExecutionBackend>> backends;
+    backends.reserve(instances);
+    v1::Utf8String error;
+    for (std::size_t i = 0; i < instances; ++i) {
+        backends.push_back(pooled ? sdk::createPooledInstanceExecutionBackend()
+                                  : factory.createInstanceExecutionBackend("inst-" + std::to_string(i)));
+        if (!backends.back()->start(&error)) {
+            std::printf("start failed: %s\n", error.c_str());
+            std::exit(1);
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const long threads = procStatus("Threads:");
+    const long rssKb = procStatus("VmRSS:");
+    const long vszKb = procStatus("VmSize:");
+
+    const std::size_t rounds = std::max<std::size_t>(20, 20000 / instances);
+    std::vector<std::vector<std::int64_t>> latencies(instances);
+    for (auto &perInstance : latencies)
+        perInstance.reserve(rounds);
+    std::atomic<std::size_t> pending{0};
+    const auto t0 = Clock::now();
+    for (std::size_t round = 0; round < rounds; ++round) {
+        pending.store(instances, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < instances; ++i) {
+            std::vector<std::int64_t> &out = latencies[i];
+            const auto queuedAt = Clock::now();
+            backends[i]->execute([&out, &pending, queuedAt]() {
+                out.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - queuedAt).count());
+                pending.fetch_sub(1, std::memory_order_release);
+            }, &error);
+        }
+        while (pending.load(std::memory_order_acquire) != 0)
+            std::this_thread::yield();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    for (auto &backend : backends)
+        backend->stop(std::chrono::seconds(5), &error);
+
+    std::vector<std::int64_t> all;
+    all.reserve(instances * rounds);
+    for (const auto &perInstance : latencies)
+        all.insert(all.end(), perInstance.begin(), perInstance.end());
+    std::sort(all.begin(), all.end());
+    const auto percentileUs = [&all](double p) {
+        return all.empty() ? 0.0 : all[static_cast<std::size_t>(p * (all.size() - 1))] / 1000.0;
+    };
+    std::printf("%-7s %5zu instances  threads %5ld  rss %7.1f MiB  vsz %8.1f MiB  "
+                "p50 %8.1f us  p99 %9.1f us  %9.0f tasks/s\n",
+                pooled ? "pool" : "thread", instances, threads, rssKb / 1024.0, vszKb / 1024.0,
+                percentileUs(0.50), percentileUs(0.99), all.size() / seconds);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("instance_execution_bench: %u hardware threads\n", std::thread::hardware_concurrency());
+    std::fflush(stdout);
+    for (const std::size_t instances : {std::size_t{10}, std::size_t{100}, std::size_t{1000}}) {
+        for (const bool pooled : {false, true}) {
+            const pid_t child = ::fork();
+            if (child == 0) {
+                runConfig(pooled, instances);
+                std::fflush(stdout);
+                ::_exit(0);
+            }
+            int status = 0;
+            if (child < 0 || ::waitpid(child, &status, 0) != child || !WIFEXITED(status)
+                || WEXITSTATUS(status) != 0) {
+                std::printf("%s %zu instances: child failed\n", pooled ? "pool" : "thread", instances);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Per-request decode cost of the typed payload decoders, without the socket:
+// the same structural index and field tables the dispatcher uses on the poll
+// thread, timed in a tight loop. Prints ns per decoded request.
+//
+//     ./sdk_request_decode_bench
+#include "json_scan.h"
+#include "phi/adapter/sdk/sidecar.h"
+#include "wire_schema.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace sdk = phicore::adapter::sdk;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+template <typename Request>
+double nsPerDecode(const std::string &payload, int iterations)
+{
+    sdk::json::StructuralIndex index;
+    Request request;
+    std::size_t sink = 0;
+    const auto t0 = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        index.build(payload);
+        const sdk::json::ScopedActiveIndex scope(index);
+        sdk::wire::decodeRequest(payload, &request);
+        sink += request.externalId.size();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    if (sink == 0)
+        std::printf("(decode produced no externalId)\n");
+    return seconds * 1e9 / iterations;
+}
+
+} // namespace
+
+int main()
+{
+    const std::string channelInvoke =
+        "{\"externalId\":\"hue-bridge-001788fffe4a2b3c\",\"deviceExternalId\":\"00:17:88:01:0a:4b:2c:1d-0b\","
+        "\"channelExternalId\":\"brightness\",\"value\":42.5}";
+    const std::string channelInvokeString =
+        "{\"externalId\":\"hue-bridge-001788fffe4a2b3c\",\"deviceExternalId\":\"00:17:88:01:0a:4b:2c:1d-0b\","
+        "\"channelExternalId\":\"scene\",\"value\":\"Living Room \\\"Evening\\\"\"}";
+    const std::string nameUpdate =
+        "{\"externalId\":\"hue-bridge-001788fffe4a2b3c\",\"deviceExternalId\":\"00:17:88:01:0a:4b:2c:1d-0b\","
+        "\"name\":\"K\\u00fcche Decke\"}";
+
+    std::printf("request_decode_bench: scanner kernel %s\n",
+                sdk::json::StructuralIndex::kernelName(sdk::json::StructuralIndex::activeKernel()));
+    std::printf("%-28s %8.1f ns/request\n", "channel_invoke_number",
+                nsPerDecode<sdk::ChannelInvokeRequest>(channelInvoke, 2000000));
+    std::printf("%-28s %8.1f ns/request\n", "channel_invoke_string",
+                nsPerDecode<sdk::ChannelInvokeRequest>(channelInvokeString, 2000000));
+    std::printf("%-28s %8.1f ns/request\n", "device_name_update",
+                nsPerDecode<sdk::DeviceNameUpdateRequest>(nameUpdate, 2000000));
+    return 0;
+}
@@ -2,13 +2,18 @@
 
 #include <atomic>
 #include <chrono>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <variant>
 
@@ -40,6 +45,193 @@ using Room = phicore::adapter::v1::Room;
 using Group = phicore::adapter::v1::Group;
 using Scene = phicore::adapter::v1::Scene;
 
+/**
+ * @brief Raw JSON value of a request, viewed in place in the request frame.
+ *
+ * Nested request JSON (action params, static config) is not copied out of the
+ * frame when a request is decoded: the value keeps a reference on the frame
+ * bytes and views its slice. Copying a request - into an execution backend
+ * task, say - shares the frame instead of copying the text, and the frame is
+ * released with the last request that uses it. Immutable, so copies may be
+ * used from any thread.
+ *
+ * Text is only copied when asked for: `str()`, or the implicit conversion for
+ * APIs that take a `JsonText`. Parsers that accept a view or pointer/length
+ * should use `view()` / `data()` + `size()` and never copy.
+ */
+class JsonRef
+{
+public:
+    JsonRef() = default;
+    /// Owns a copy of `text`.
+    JsonRef(phicore::adapter::v1::JsonText text);
+    JsonRef(const char *text);
+    /// Views `text`, which must lie inside `*storage`.
+    JsonRef(std::shared_ptr<const std::string> storage, std::string_view text) noexcept;
+
+    std::string_view view() const noexcept { return m_text; }
+    const char *data() const noexcept { return m_text.data(); }
+    std::size_t size() const noexcept { return m_text.size(); }
+    bool empty() const noexcept { return m_text.empty(); }
+
+    /// Copies the text out.
+    phicore::adapter::v1::JsonText str() const { return phicore::adapter::v1::JsonText(m_text); }
+    operator phicore::adapter::v1::JsonText() const { return str(); }
+
+    /**
+     * @brief Raw value of member `key` when this is a JSON object.
+     *
+     * Scans the object on each call and shares the frame with the result; empty
+     * when the member is absent or this is not an object.
+     */
+    JsonRef member(std::string_view key) const;
+
+    friend bool operator==(const JsonRef &lhs, std::string_view rhs) noexcept { return lhs.m_text == rhs; }
+
+private:
+    std::shared_ptr<const std::string> m_storage;
+    std::string_view m_text;
+};
+
+/**
+ * @brief JSON text known to be one valid value, sent without re-checking.
+ *
+ * Comes from a complete `JsonWriter` (`takeTrusted()`), from `validate()`, or
+ * from `assumeValid()` for text the adapter vouches for (constants, output of
+ * its own serializer). Send overloads taking a `TrustedJson` skip the
+ * per-fragment parse in release builds of the SDK; debug builds, and any
+ * build with `setOutboundJsonValidation(true)`, still verify it, so a broken
+ * promise shows up in tests. Only `sendStreamData` and
+ * `sendAdapterMetaUpdated` have such overloads; the other `JsonText`
+ * members (`metaJson`, `formValuesJson`, `fieldsJson`, ...) are always
+ * subject to the policy. Empty text is sent as the field default.
+ */
+class TrustedJson
+{
+public:
+    TrustedJson() = default;
+
+    static TrustedJson assumeValid(phicore::adapter::v1::JsonText text) { return TrustedJson(std::move(text)); }
+    /// Parses `text` once; nullopt (and `*error`) when it is not one JSON value.
+    static std::optional<TrustedJson> validate(phicore::adapter::v1::JsonText text,
+                                               phicore::adapter::v1::Utf8String *error = nullptr);
+
+    std::string_view view() const noexcept { return m_text; }
+    const phicore::adapter::v1::JsonText &text() const noexcept { return m_text; }
+    bool empty() const noexcept { return m_text.empty(); }
+
+private:
+    explicit TrustedJson(phicore::adapter::v1::JsonText text) noexcept
+        : m_text(std::move(text))
+    {
+    }
+
+    phicore::adapter::v1::JsonText m_text;
+};
+
+/**
+ * @brief Whether caller-supplied `JsonText` fragments are parsed before send.
+ *
+ * Applies to every raw JSON member of outbound frames (`fieldsJson`,
+ * `metaJson`, `metaPatchJson`, stream data, `formValuesJson`, ...). A
+ * fragment that is not one JSON value is replaced by the member's default
+ * and reported on stderr (`[sidecar][invalidOutboundJson][host]`), so it
+ * never reaches the core. Identical fragments validated recently on the same
+ * thread are recognized and not parsed again. Process-wide and
+ * off by default; `PHI_ADAPTER_SDK_VALIDATE_JSON=1` in the environment turns
+ * it on at startup.
+ */
+void setOutboundJsonValidation(bool enabled) noexcept;
+bool outboundJsonValidation() noexcept;
+
+/**
+ * @brief Builds JSON text that is well-formed by construction.
+ *
+ * Meant for `fieldsJson`, `metaJson`, `resultValueJson`, stream data and the
+ * like instead of concatenating strings by hand: the writer separates members
+ * and elements and escapes strings. A call that would make the text invalid (a
+ * value where an object key is expected, an unbalanced end, a second
+ * top-level value) marks the writer failed instead; `complete()` tells whether
+ * the text is exactly one closed JSON value.
+ *
+ * Writes into a buffer of its own, which keeps its capacity across `clear()`
+ * so a writer reused per event stops allocating, or appends to a caller's
+ * string - such as the outbound frame, see `sendStreamData(..., writeData)`.
+ */
+class JsonWriter
+{
+public:
+    JsonWriter() noexcept;
+    /// Appends to `out`; text already in `out` is left alone.
+    explicit JsonWriter(std::string &out) noexcept;
+    JsonWriter(const JsonWriter &) = delete;
+    JsonWriter &operator=(const JsonWriter &) = delete;
+
+    JsonWriter &beginObject();
+    JsonWriter &endObject();
+    JsonWriter &beginArray();
+    JsonWriter &endArray();
+    JsonWriter &key(std::string_view name);
+
+    JsonWriter &value(std::string_view text);
+    JsonWriter &value(const char *text) { return value(std::string_view(text)); }
+    JsonWriter &value(bool flag);
+    JsonWriter &value(double number);
+    JsonWriter &value(const phicore::adapter::v1::ScalarValue &scalar);
+    template <std::integral Integer>
+        requires(!std::same_as<Integer, bool>)
+    JsonWriter &value(Integer number)
+    {
+        if constexpr (std::is_signed_v<Integer>)
+            return signedValue(static_cast<std::int64_t>(number));
+        else
+            return unsignedValue(static_cast<std::uint64_t>(number));
+    }
+    JsonWriter &null();
+
+    /// `key(name)` followed by `value(v)`.
+    template <typename Value>
+    JsonWriter &member(std::string_view name, const Value &v)
+    {
+        key(name);
+        return value(v);
+    }
+
+    /// No call so far would have made the text invalid.
+    bool ok() const noexcept { return !m_failed; }
+    /// `ok()`, and exactly one top-level value has been written and closed.
+    bool complete() const noexcept { return !m_failed && m_done; }
+
+    /// Text written by this writer (not what was in a caller's string before).
+    std::string_view view() const noexcept;
+    /// Moves the text out (copies it when appending to a caller's string) and
+    /// resets the writer.
+    phicore::adapter::v1::JsonText take();
+    /// `take()` as `TrustedJson`; empty (text discarded) unless `complete()`.
+    TrustedJson takeTrusted();
+    /// Drops the text and resets the writer; its own buffer keeps its capacity.
+    void clear() noexcept;
+
+private:
+    static constexpr std::uint8_t kMaxDepth = 64;
+
+    bool beginValue();
+    void endValue() noexcept;
+    JsonWriter &endContainer(bool object, char close);
+    JsonWriter &signedValue(std::int64_t number);
+    JsonWriter &unsignedValue(std::uint64_t number);
+
+    std::string m_buffer;
+    std::string *m_out;
+    std::size_t m_start = 0;
+    std::uint64_t m_objects = 0; // bit n set: container at depth n is an object
+    std::uint8_t m_depth = 0;
+    bool m_needComma = false;
+    bool m_expectValue = false;
+    bool m_done = false;
+    bool m_failed = false;
+};
+
 /**
  * @brief Bootstrap payload sent by phi-core right after IPC connect.
  */
@@ -54,7 +246,10 @@ struct BootstrapRequest {
     phicore::adapter::v1::Adapter adapter;
     /// Static adapter config JSON (`<pluginType>-config.json`) as raw JSON text.
     /// This is provided during bootstrap so factory scope is immediately functional.
-    phicore::adapter::v1::JsonText staticConfigJson;
+    JsonRef staticConfigJson;
+    /// Core expands interned logs (`EventLogTemplate` / `EventLogRef`) for this
+    /// session; the dispatcher switches its log frames over on its own.
+    bool logTemplates = false;
 };
 
 /**
@@ -77,7 +272,7 @@ struct ConfigChangedRequest {
     phicore::adapter::v1::Adapter adapter;
     /// Reserved for future static-config delta transport.
     /// In v1, phi-core sends static config only in `BootstrapRequest::staticConfigJson`.
-    phicore::adapter::v1::JsonText staticConfigJson;
+    JsonRef staticConfigJson;
 };
 
 /**
@@ -127,7 +322,7 @@ struct AdapterActionInvokeRequest {
     /// Action identifier from adapter capabilities.
     phicore::adapter::v1::Utf8String actionId;
     /// Raw JSON object for action params.
-    phicore::adapter::v1::JsonText paramsJson;
+    JsonRef paramsJson;
 };
 
 /**
@@ -159,7 +354,7 @@ struct DeviceEffectInvokeRequest {
     /// Vendor effect identifier, when provided by caller.
     phicore::adapter::v1::Utf8String effectId;
     /// Raw JSON object for effect params.
-    phicore::adapter::v1::JsonText paramsJson;
+    JsonRef paramsJson;
 };
 
 /**
@@ -195,7 +390,7 @@ struct AdaptersStreamStartRequest {
     /// Stream kind (`adapter.log`, `camera.live`, ...).
     phicore::adapter::v1::Utf8String kind;
     /// Raw JSON object for stream params.
-    phicore::adapter::v1::JsonText paramsJson;
+    JsonRef paramsJson;
 };
 
 /**
@@ -317,6 +512,56 @@ struct LogFilterCache {
     std::uint16_t categoryMask = 0;
 };
 
+/**
+ * @brief Lowest `LogLevel` value the `PHI_LOG_*` macros compile in.
+ *
+ * Evaluated in the adapter's translation unit. Defaults to `Debug` (2) when
+ * `NDEBUG` is defined, so `PHI_LOG_TRACE` vanishes from release builds, and
+ * to `Trace` (1) otherwise. `Error` is always compiled in.
+ */
+#ifndef PHI_LOG_COMPILE_MIN_LEVEL
+#ifdef NDEBUG
+#define PHI_LOG_COMPILE_MIN_LEVEL 2
+#else
+#define PHI_LOG_COMPILE_MIN_LEVEL 1
+#endif
+#endif
+
+/**
+ * @brief Opt-in collapsing of repeated log lines (see `AdapterInstance::setLogDedupe`).
+ *
+ * Lines are identical when level, category, message template and ctx match
+ * (params may differ). Within `window` only the first is sent; the number held
+ * back is reported as `fields.suppressedCount` on the next one sent after the
+ * window, or on a summary of the last held-back line. `Error` logs and
+ * `sendError` incidents are always sent and carry `fields.repeatCount`.
+ */
+struct LogDedupeOptions {
+    /// Length of a dedupe window (`0` => no dedupe).
+    std::chrono::milliseconds window{0};
+    /// Send one in this many `Trace` logs (`1` => all); the next one sent
+    /// carries the skipped count as `fields.suppressedCount`.
+    std::uint32_t traceSampleEvery = 1;
+};
+
+/**
+ * @brief In-memory recording of logs the log filter rejects (see
+ * `AdapterInstance::setFlightRecorder`).
+ *
+ * Entries live in a fixed ring of 256-byte binary slots: message, ctx and
+ * params are cut to fit a slot (the entry is then marked `truncated`), and
+ * `fields` are kept only when they fit whole.
+ */
+struct FlightRecorderOptions {
+    /// Entries kept, rounded up to a power of two (`0` => off).
+    std::size_t capacity = 0;
+    /// Least severe level recorded.
+    LogLevel minLevel = LogLevel::Trace;
+    /// Most recent entries attached to the next `sendError` incident as
+    /// `fields.flightRecorder`; attaching empties the recorder (`0` => never).
+    std::size_t incidentEntries = 0;
+};
+
 struct LogEntry {
     LogLevel level = LogLevel::Info;
     LogCategory category = LogCategory::Internal;
@@ -330,6 +575,88 @@ struct LogEntry {
     std::int64_t tsMs = 0;
 };
 
+/// One channel value of a batched state update (see `sendChannelStatesUpdated`).
+struct ChannelStateUpdate {
+    phicore::adapter::v1::ExternalId deviceExternalId;
+    phicore::adapter::v1::ExternalId channelExternalId;
+    phicore::adapter::v1::ScalarValue value;
+    /// Timestamp in ms since epoch (`0` => now).
+    std::int64_t tsMs = 0;
+};
+
+/**
+ * @brief Opt-in suppression of unchanged channel states (see
+ * `AdapterInstance::setChannelStateDedupe`).
+ *
+ * Values compare like the core compares them: bools leniently (non-zero
+ * integer, `"true"/"on"/"yes"/"1"` and their negations, case-insensitive),
+ * integers and floats numerically, strings exactly.
+ */
+struct ChannelStateDedupeOptions {
+    bool enabled = false;
+    /// An unchanged value is sent again once this long has passed since it
+    /// was last sent (`0` => never).
+    std::chrono::milliseconds refreshInterval{60000};
+};
+
+/// Counters of the channel state dedupe cache.
+struct ChannelStateDedupeStats {
+    /// Updates that changed the value (or had none cached) and were sent.
+    std::uint64_t sent = 0;
+    /// Unchanged updates that were dropped before encoding.
+    std::uint64_t suppressed = 0;
+    /// Unchanged updates sent anyway because the refresh interval had passed.
+    std::uint64_t refreshed = 0;
+};
+
+/**
+ * @brief Publish filter for one numeric channel (see `AdapterInstance::setChannelFilter`).
+ *
+ * Applies to integer and float values; other values pass unchanged, and
+ * integers are rounded in integer arithmetic. A value is held back while it
+ * stays within any configured deadband of the last published value, or while
+ * `minInterval` has not passed since that publish. Filtering happens inside
+ * the send call; `SidecarHost::pollOnce` publishes a held-back change once
+ * `minInterval` has passed, and the last value again once it is `maxAge` old.
+ */
+struct NumericChannelFilter {
+    /// Changes up to this size are held back (`0` => off).
+    double absoluteDeadband = 0.0;
+    /// Changes up to this fraction of the last published value are held back (`0` => off).
+    double relativeDeadband = 0.0;
+    /// Minimum time between two published values (`0` => no limit).
+    std::chrono::milliseconds minInterval{0};
+    /// Publish even an unchanged value once the last publish is this old (`0` => never).
+    std::chrono::milliseconds maxAge{0};
+    /// Published values are rounded to a multiple of this step (`0` => unrounded).
+    double quantizationStep = 0.0;
+};
+
+/**
+ * @brief Filter derived from channel metadata.
+ *
+ * Quantizes to `stepValue`, so changes of less than half a step are held
+ * back. Without a step, a valid `minValue`/`maxValue` range gives a deadband
+ * of 0.1% of the range. Returns an inactive filter when neither is set.
+ */
+NumericChannelFilter makeNumericChannelFilter(const phicore::adapter::v1::Channel &channel);
+
+/**
+ * @brief Counters of the topology cache behind `sendDeviceUpdated`.
+ *
+ * A cache hit is a call answered by `deltaSends` or `skippedSends`.
+ */
+struct TopologyCacheStats {
+    /// Calls sent as a full `EventDeviceUpdated` snapshot (miss or changed shape).
+    std::uint64_t fullSends = 0;
+    /// Calls sent as `EventChannelUpdated` frames for the changed channels only.
+    std::uint64_t deltaSends = 0;
+    /// Calls that sent nothing because nothing changed.
+    std::uint64_t skippedSends = 0;
+    /// Unchanged channels not re-sent by delta and skipped calls.
+    std::uint64_t skippedChannels = 0;
+};
+
 /**
  * @brief Build canonical source-location fields JSON for debug/trace logs.
  *
@@ -378,6 +705,31 @@ struct SidecarHandlers {
     std::function<void(const UnknownRequest &)> onUnknownRequest;
 };
 
+/**
+ * @brief Process-wide wall clock behind every default `tsMs` stamp.
+ *
+ * Every `tsMs = 0` passed to a send helper, log or result is stamped from
+ * `nowMs()`. By default it reads `CLOCK_REALTIME_COARSE`, a value the kernel
+ * keeps per tick (a few ms granularity) and serves without a syscall.
+ * `SidecarDispatcher::pollOnce` re-anchors the steady -> wall mapping once per
+ * step, so adapters that keep `steady_clock` time points can convert them
+ * without reading the wall clock themselves.
+ */
+class SidecarClock
+{
+public:
+    using Source = std::int64_t (*)() noexcept;
+
+    /// Wall time in ms since epoch.
+    static std::int64_t nowMs() noexcept;
+    /// Wall time in ms since epoch that corresponds to `timePoint`.
+    static std::int64_t wallMs(std::chrono::steady_clock::time_point timePoint) noexcept;
+    /// Re-anchors the steady -> wall mapping when the wall clock was stepped.
+    static void refresh() noexcept;
+    /// Replaces the time source, for deterministic tests (`nullptr` => system clock).
+    static void setSource(Source source) noexcept;
+};
+
 /**
  * @brief High-level typed IPC helper for adapter sidecars.
  *
@@ -478,11 +830,29 @@ public:
 
     /**
      * @brief Publish structured adapter log (`command=EventLog`).
+     *
+     * Sent as `EventLogRef` (after one `EventLogTemplate` per template) when
+     * core announced `logTemplates` at bootstrap.
      */
     bool sendLog(const phicore::adapter::v1::ExternalId &externalId,
                  const phicore::adapter::v1::Utf8String &plugin,
                  const LogEntry &entry,
                  phicore::adapter::v1::Utf8String *error = nullptr);
+    /// Moves the entry's strings into the queued event instead of copying them.
+    bool sendLog(const phicore::adapter::v1::ExternalId &externalId,
+                 const phicore::adapter::v1::Utf8String &plugin,
+                 LogEntry &&entry,
+                 phicore::adapter::v1::Utf8String *error = nullptr);
+
+    /**
+     * @brief Least severe log level forwarded under outbound queue pressure.
+     *
+     * `Trace` normally. Rises to `Debug` once the send backlog reaches a
+     * quarter of the queue cap and to `Info` at half of it; steps back once
+     * the backlog stayed below half of that threshold for a second. Adapter
+     * `log(...)` calls and `isLogEnabled()` apply it before building a frame.
+     */
+    LogLevel logThrottleLevel() const noexcept;
 
     /**
      * @brief Publish adapter meta patch (`command=EventAdapterMetaUpdated`).
@@ -494,6 +864,9 @@ public:
     bool sendAdapterMetaUpdated(const phicore::adapter::v1::ExternalId &externalId,
                                 const phicore::adapter::v1::JsonText &metaPatchJson,
                                 phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendAdapterMetaUpdated(const phicore::adapter::v1::ExternalId &externalId,
+                                const TrustedJson &metaPatchJson,
+                                phicore::adapter::v1::Utf8String *error = nullptr);
 
     /**
      * @brief Publish runtime descriptor update (`command=EventFactoryDescriptorUpdated`).
@@ -513,6 +886,12 @@ public:
                                  const phicore::adapter::v1::ScalarValue &value,
                                  std::int64_t tsMs = 0,
                                  phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendChannelStateUpdated(const phicore::adapter::v1::ExternalId &externalId,
+                                 const phicore::adapter::v1::ExternalId &deviceExternalId,
+                                 const phicore::adapter::v1::ExternalId &channelExternalId,
+                                 phicore::adapter::v1::ScalarValue &&value,
+                                 std::int64_t tsMs = 0,
+                                 phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendChannelColorStateUpdated(const phicore::adapter::v1::ExternalId &externalId,
                                       const phicore::adapter::v1::ExternalId &deviceExternalId,
                                       const phicore::adapter::v1::ExternalId &channelExternalId,
@@ -522,8 +901,30 @@ public:
                                       std::int64_t tsMs = 0,
                                       phicore::adapter::v1::Utf8String *error = nullptr);
 
+    /**
+     * @brief Publish several channel state updates at once.
+     *
+     * Writes one standard `EventChannelStateUpdated` frame per update, in
+     * order, and queues them together under a single lock and wakeup; no other
+     * frame is interleaved. Returns `false` if any frame was refused (see
+     * `queueOutboundFrame` shed policy); the others are still sent.
+     */
+    bool sendChannelStatesUpdated(const phicore::adapter::v1::ExternalId &externalId,
+                                  std::span<const ChannelStateUpdate> updates,
+                                  phicore::adapter::v1::Utf8String *error = nullptr);
+    /// Same as above; ids and values are moved out of `updates`.
+    bool sendChannelStatesUpdated(const phicore::adapter::v1::ExternalId &externalId,
+                                  std::vector<ChannelStateUpdate> &&updates,
+                                  phicore::adapter::v1::Utf8String *error = nullptr);
+
     /**
      * @brief Publish full device snapshot (`command=EventDeviceUpdated`).
+     *
+     * The device and channel records last sent per instance are cached. A
+     * snapshot identical to the cached one sends nothing; one where only
+     * channel records changed (same channel ids, same order) sends an
+     * `EventChannelUpdated` per changed channel. Anything else goes out in
+     * full. The cache is dropped whenever the core connection changes.
      */
     bool sendDeviceUpdated(const phicore::adapter::v1::ExternalId &externalId,
                            const phicore::adapter::v1::Device &device,
@@ -545,6 +946,10 @@ public:
                             const phicore::adapter::v1::Channel &channel,
                             phicore::adapter::v1::Utf8String *error = nullptr);
 
+    /// Forget the topology sent for `externalId`; its next snapshots go out in full.
+    void invalidateTopologyCache(const phicore::adapter::v1::ExternalId &externalId);
+    TopologyCacheStats topologyCacheStats() const;
+
     /**
      * @brief Publish room upsert (`command=EventRoomUpdated`).
      */
@@ -601,6 +1006,27 @@ public:
                         const phicore::adapter::v1::JsonText &payloadJson,
                         std::int64_t tsMs = 0,
                         phicore::adapter::v1::Utf8String *error = nullptr);
+    /**
+     * @brief Stream data whose `data` value `writeData` writes straight into
+     * the outbound frame, with no intermediate string.
+     *
+     * Nothing written sends `{}`; a writer that is not `complete()` afterwards
+     * refuses the frame.
+     */
+    bool sendStreamData(const phicore::adapter::v1::ExternalId &externalId,
+                        const phicore::adapter::v1::Utf8String &streamId,
+                        const phicore::adapter::v1::Utf8String &cmd,
+                        std::int64_t seq,
+                        const std::function<void(JsonWriter &)> &writeData,
+                        std::int64_t tsMs = 0,
+                        phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendStreamData(const phicore::adapter::v1::ExternalId &externalId,
+                        const phicore::adapter::v1::Utf8String &streamId,
+                        const phicore::adapter::v1::Utf8String &cmd,
+                        std::int64_t seq,
+                        const TrustedJson &payloadJson,
+                        std::int64_t tsMs = 0,
+                        phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendStreamError(const phicore::adapter::v1::ExternalId &externalId,
                          const phicore::adapter::v1::Utf8String &streamId,
                          const phicore::adapter::v1::Utf8String &cmd,
@@ -618,6 +1044,11 @@ public:
 private:
     friend class SidecarHost;
 
+    /// Channel state or log event kept as data until `flushSendQueue` writes it.
+    struct DeferredEvent;
+    /// Per-thread buffer of log frames, drained into the send order at flush.
+    struct LogRing;
+
     struct OutboundFrame {
         phicore::adapter::v1::MessageType type = phicore::adapter::v1::MessageType::Event;
         phicore::adapter::v1::CorrelationId correlationId = 0;
@@ -627,6 +1058,10 @@ private:
         phicore::adapter::v1::ExternalId externalId;
         phicore::adapter::v1::Utf8String message;
         std::string payload;
+        /// Set instead of `payload` until the frame is encoded.
+        std::shared_ptr<const DeferredEvent> deferred;
+        /// Enqueue order across the send queue and the log rings.
+        std::uint64_t seq = 0;
     };
 
     /**
@@ -639,14 +1074,43 @@ private:
                                phicore::adapter::v1::CorrelationId correlationId,
                                phicore::adapter::v1::Utf8String *error);
 
+    /// Instance-scoped request that has been routed but not decoded yet.
+    struct RoutedRequest;
+    using RequestRouter = std::function<bool(const RoutedRequest &)>;
+
+    /**
+     * @brief Offer instance-scoped requests to `router` before decoding them.
+     *
+     * Called on the polling thread with only command, cmdId and
+     * `payload.externalId` parsed. Returning true hands the request over; the
+     * router then owns the typed decode and the reply if it cannot run the
+     * request. Returning false falls back to the
+     * regular decode and handler dispatch. Internal hook used by `SidecarHost`.
+     */
+    void setRequestRouter(RequestRouter router);
+
     bool handleRequestFrame(const phicore::adapter::v1::FrameHeader &header,
-                            std::span<const std::byte> payload);
+                            std::span<const std::byte> payload,
+                            const std::shared_ptr<const std::string> &buffer);
     bool sendJson(phicore::adapter::v1::MessageType type,
                   phicore::adapter::v1::CorrelationId correlationId,
-                  std::string_view json,
+                  std::string json,
                   phicore::adapter::v1::Utf8String *error);
     bool queueOutboundFrame(OutboundFrame frame, phicore::adapter::v1::Utf8String *error = nullptr);
+    /// Queues `frames` back to back under one lock and one wakeup.
+    bool queueOutboundFrames(std::span<OutboundFrame> frames, phicore::adapter::v1::Utf8String *error = nullptr);
     bool flushSendQueue(phicore::adapter::v1::Utf8String *error = nullptr);
+    /// Hands a log frame to the calling thread's ring; only a drain of that
+    /// ring can make it wait.
+    bool queueLogFrame(OutboundFrame frame, phicore::adapter::v1::Utf8String *error = nullptr);
+    LogRing &threadLogRing();
+    /// Moves buffered log frames into `queue` by enqueue order. Flush thread.
+    void drainLogRings(std::deque<OutboundFrame> *queue);
+    /// Sheds a flushed queue back to kHostQueueMaxDepth, logs first.
+    void shedOverCap(std::deque<OutboundFrame> *queue);
+    /// Moves the log throttle by the current send backlog; only the flush
+    /// (`mayRelax`) loosens it.
+    void updateLogThrottle(std::size_t backlog, bool mayRelax);
 
     /**
      * @brief Interrupt a blocking pollOnce() from any thread.
@@ -686,6 +1150,24 @@ public:
                       phicore::adapter::v1::Utf8String *error = nullptr) = 0;
 };
 
+/**
+ * @brief Instance backend running on a process-wide worker pool.
+ *
+ * The default backend starts one thread per instance. Backends created here
+ * share one pool of `hardware_concurrency()` workers (at least two) instead.
+ * Each backend is a serial strand: its tasks run one at a time, in submission
+ * order, as on a dedicated thread. Different instances run in parallel.
+ * Return it from `AdapterFactory::createInstanceExecutionBackend(...)`.
+ *
+ * A task holds its worker for as long as it runs, so adapters whose tasks
+ * block (synchronous I/O, nested event loops) should keep the default
+ * backend. A `stop(...)` that times out drops the instance's queued tasks
+ * unrun, retires the worker stuck in that instance and starts a
+ * replacement; the stuck thread is counted by
+ * `reapAbandonedExecutionThreads(...)`.
+ */
+std::unique_ptr<InstanceExecutionBackend> createPooledInstanceExecutionBackend();
+
 class AdapterInstance;
 
 /**
@@ -721,6 +1203,11 @@ public:
     /// Whether bootstrap payload has been received.
     bool hasBootstrap() const;
 
+    /// Whether `log(level, category, ...)` would forward, from the cached
+    /// filter of the current config. The `PHI_LOG_*` macros check it before
+    /// building any log argument. `Error` is always enabled.
+    bool isLogEnabled(LogLevel level, LogCategory category) const noexcept;
+
     /// Structured log helper for adapter implementers.
     /// `params` replace `%1`, `%2`, ... in `message`; `ctx` is the translation context.
     bool log(LogLevel level,
@@ -806,17 +1293,23 @@ protected:
                    std::int64_t tsMs = 0,
                    phicore::adapter::v1::Utf8String *error = nullptr);
     AdapterDescriptor factoryDescriptor() const;
+    /// Factory counterpart of `AdapterInstance::setLogDedupe`.
+    void setLogDedupe(const LogDedupeOptions &options);
+    /// Sends the pending suppression summaries now.
+    bool flushLogDedupe(phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendFactoryDescriptorUpdated(phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendFactoryDescriptorUpdated(const AdapterDescriptor &descriptor,
                                       phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendResult(const phicore::adapter::v1::ActionResponse &response,
                     phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendResult(phicore::adapter::v1::ActionResponse &&response,
+                    phicore::adapter::v1::Utf8String *error = nullptr);
 
 private:
     friend class SidecarHost;
 
     void bindDispatcher(SidecarDispatcher *dispatcher);
-    void bindResultSubmitter(std::function<void(const phicore::adapter::v1::ActionResponse &)> actionSubmitter);
+    void bindResultSubmitter(std::function<void(phicore::adapter::v1::ActionResponse &&)> actionSubmitter);
     void cacheBootstrap(const BootstrapRequest &request);
     void cacheFactoryConfig(const ConfigChangedRequest &request);
 
@@ -879,6 +1372,14 @@ public:
     const phicore::adapter::v1::ExternalId &externalId() const;
     const ConfigChangedRequest &config() const;
     bool hasConfig() const;
+    /// Counters of the channel state dedupe cache (see `setChannelStateDedupe`).
+    ChannelStateDedupeStats channelStateDedupeStats() const;
+
+    /// Whether `log(level, category, ...)` would forward, from the cached
+    /// filter of the current config, or record it (see `setFlightRecorder`).
+    /// The `PHI_LOG_*` macros check it before building any log argument.
+    /// `Error` is always enabled.
+    bool isLogEnabled(LogLevel level, LogCategory category) const noexcept;
 
     /// Structured log helper for adapter implementers.
     /// `params` replace `%1`, `%2`, ... in `message`; `ctx` is the translation context.
@@ -919,11 +1420,18 @@ protected:
                    phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendAdapterMetaUpdated(const phicore::adapter::v1::JsonText &metaPatchJson,
                                 phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendAdapterMetaUpdated(const TrustedJson &metaPatchJson,
+                                phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendChannelStateUpdated(const phicore::adapter::v1::ExternalId &deviceExternalId,
                                  const phicore::adapter::v1::ExternalId &channelExternalId,
                                  const phicore::adapter::v1::ScalarValue &value,
                                  std::int64_t tsMs = 0,
                                  phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendChannelStateUpdated(const phicore::adapter::v1::ExternalId &deviceExternalId,
+                                 const phicore::adapter::v1::ExternalId &channelExternalId,
+                                 phicore::adapter::v1::ScalarValue &&value,
+                                 std::int64_t tsMs = 0,
+                                 phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendChannelColorStateUpdated(const phicore::adapter::v1::ExternalId &deviceExternalId,
                                       const phicore::adapter::v1::ExternalId &channelExternalId,
                                       double r,
@@ -931,6 +1439,10 @@ protected:
                                       double b,
                                       std::int64_t tsMs = 0,
                                       phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendChannelStatesUpdated(std::span<const ChannelStateUpdate> updates,
+                                  phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendChannelStatesUpdated(std::vector<ChannelStateUpdate> &&updates,
+                                  phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendDeviceUpdated(const phicore::adapter::v1::Device &device,
                            const phicore::adapter::v1::ChannelList &channels,
                            phicore::adapter::v1::Utf8String *error = nullptr);
@@ -939,6 +1451,70 @@ protected:
     bool sendChannelUpdated(const phicore::adapter::v1::ExternalId &deviceExternalId,
                             const phicore::adapter::v1::Channel &channel,
                             phicore::adapter::v1::Utf8String *error = nullptr);
+    /// Make the next `sendDeviceUpdated` calls send full snapshots again.
+    void invalidateTopologyCache();
+
+    /**
+     * @brief Drop channel state updates that repeat the last value sent.
+     *
+     * Applies to `sendChannelStateUpdated`, `sendChannelColorStateUpdated` and
+     * `sendChannelStatesUpdated`; a dropped update returns `true`. The cache is
+     * keyed by device and channel id and cleared on every (re)connect and
+     * whenever the options change.
+     */
+    void setChannelStateDedupe(const ChannelStateDedupeOptions &options);
+
+    /**
+     * @brief Collapse repeated `log(...)` lines and sample `Trace` logs.
+     *
+     * Summaries of closed windows go out with the next log call or at
+     * `flushLogDedupe()`; changing the options flushes first.
+     */
+    void setLogDedupe(const LogDedupeOptions &options);
+    /// Sends the pending suppression summaries now.
+    bool flushLogDedupe(phicore::adapter::v1::Utf8String *error = nullptr);
+
+    /**
+     * @brief Keep logs rejected by the log filter in a bounded in-memory ring.
+     *
+     * Recording neither locks nor allocates. Recorded levels count as enabled
+     * in `isLogEnabled()`, so `PHI_LOG_*` calls reach the recorder. Configure
+     * before the instance logs from other threads; new options drop what was
+     * recorded.
+     */
+    void setFlightRecorder(const FlightRecorderOptions &options);
+    /**
+     * @brief Send the recording as `adapter.log` stream data and empty it.
+     *
+     * Entries go out oldest first, up to 64 per frame, as
+     * `{"entries":[...],"dropped":N}`; `dropped` counts entries overwritten
+     * before they were read. At least one frame is sent. `*seq` is the
+     * stream seq of the first frame and is advanced past the last.
+     */
+    bool flushFlightRecorder(const phicore::adapter::v1::Utf8String &streamId,
+                             const phicore::adapter::v1::Utf8String &cmd,
+                             std::int64_t *seq,
+                             phicore::adapter::v1::Utf8String *error = nullptr);
+
+    /**
+     * @brief Filter numeric state updates of one channel before they are sent.
+     *
+     * Applies to `sendChannelStateUpdated` and `sendChannelStatesUpdated`,
+     * before the dedupe cache; a held-back update returns `true`.
+     */
+    void setChannelFilter(const phicore::adapter::v1::ExternalId &deviceExternalId,
+                          const phicore::adapter::v1::ExternalId &channelExternalId,
+                          const NumericChannelFilter &filter);
+    void clearChannelFilter(const phicore::adapter::v1::ExternalId &deviceExternalId,
+                            const phicore::adapter::v1::ExternalId &channelExternalId);
+    /**
+     * @brief Send held-back changes whose `minInterval` has passed, and last
+     * values older than `maxAge`.
+     *
+     * `SidecarHost::pollOnce` already posts this to the instance's execution
+     * backend when something is due; call it directly to publish sooner.
+     */
+    bool publishHeldChannelStates(phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendRoomUpdated(const phicore::adapter::v1::Room &room, phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendRoomRemoved(const phicore::adapter::v1::ExternalId &roomExternalId,
                          phicore::adapter::v1::Utf8String *error = nullptr);
@@ -961,6 +1537,18 @@ protected:
                         const phicore::adapter::v1::JsonText &payloadJson,
                         std::int64_t tsMs = 0,
                         phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendStreamData(const phicore::adapter::v1::Utf8String &streamId,
+                        const phicore::adapter::v1::Utf8String &cmd,
+                        std::int64_t seq,
+                        const std::function<void(JsonWriter &)> &writeData,
+                        std::int64_t tsMs = 0,
+                        phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendStreamData(const phicore::adapter::v1::Utf8String &streamId,
+                        const phicore::adapter::v1::Utf8String &cmd,
+                        std::int64_t seq,
+                        const TrustedJson &payloadJson,
+                        std::int64_t tsMs = 0,
+                        phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendStreamError(const phicore::adapter::v1::Utf8String &streamId,
                          const phicore::adapter::v1::Utf8String &cmd,
                          const phicore::adapter::v1::Utf8String &message,
@@ -972,17 +1560,23 @@ protected:
                        const phicore::adapter::v1::Utf8String &cmd,
                        const phicore::adapter::v1::Utf8String &reason,
                        phicore::adapter::v1::Utf8String *error = nullptr);
+    /// Rvalue overloads hand the response (e.g. large `formValuesJson`) to
+    /// the host's result queue without copying it.
     bool sendResult(const phicore::adapter::v1::CmdResponse &response,
                     phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendResult(phicore::adapter::v1::CmdResponse &&response,
+                    phicore::adapter::v1::Utf8String *error = nullptr);
     bool sendResult(const phicore::adapter::v1::ActionResponse &response,
                     phicore::adapter::v1::Utf8String *error = nullptr);
+    bool sendResult(phicore::adapter::v1::ActionResponse &&response,
+                    phicore::adapter::v1::Utf8String *error = nullptr);
 
 private:
     friend class SidecarHost;
 
     void bindDispatcher(SidecarDispatcher *dispatcher);
-    void bindResultSubmitters(std::function<void(const phicore::adapter::v1::CmdResponse &)> cmdSubmitter,
-                              std::function<void(const phicore::adapter::v1::ActionResponse &)> actionSubmitter);
+    void bindResultSubmitters(std::function<void(phicore::adapter::v1::CmdResponse &&)> cmdSubmitter,
+                              std::function<void(phicore::adapter::v1::ActionResponse &&)> actionSubmitter);
     void bindContext(int adapterId,
                      phicore::adapter::v1::Utf8String pluginType,
                      phicore::adapter::v1::ExternalId externalId);
@@ -1004,6 +1598,10 @@ private:
     void hostOnAdaptersStreamStart(const AdaptersStreamStartRequest &request);
     void hostOnAdaptersStreamStop(const AdaptersStreamStopRequest &request);
     void hostOnUnknownRequest(const UnknownRequest &request);
+    // Filtered channel states due for publishing, driven by SidecarHost::pollOnce.
+    std::chrono::steady_clock::time_point hostNextChannelStateDue() const;
+    bool hostClaimDueChannelStates(std::chrono::steady_clock::time_point now);
+    void hostPublishDueChannelStates();
 
     // State is hidden so the SDK can evolve without breaking the ABI of
     // adapter subclasses.
@@ -1092,8 +1690,8 @@ private:
     struct InstanceRuntime;
     struct Impl;
 
-    static phicore::adapter::v1::CmdResponse normalizeCmdResponse(const phicore::adapter::v1::CmdResponse &response);
-    static phicore::adapter::v1::ActionResponse normalizeActionResponse(const phicore::adapter::v1::ActionResponse &response);
+    static phicore::adapter::v1::CmdResponse normalizeCmdResponse(phicore::adapter::v1::CmdResponse response);
+    static phicore::adapter::v1::ActionResponse normalizeActionResponse(phicore::adapter::v1::ActionResponse response);
     AdapterInstance *ensureInstance(const ConfigChangedRequest &request);
     bool createInstanceRuntime(const ConfigChangedRequest &request,
                                phicore::adapter::v1::Utf8String *error = nullptr);
@@ -1105,6 +1703,9 @@ private:
                           std::function<void()> task,
                           phicore::adapter::v1::Utf8String *error = nullptr);
     void executeOnAllRuntimes(const std::function<void(AdapterInstance &)> &fn);
+    // Posts publishHeldChannelStates() to instances with filtered states due;
+    // returns when the next one is due.
+    std::chrono::steady_clock::time_point publishDueChannelStates();
     // Runs `task` on the factory execution backend, or inline on the calling
     // thread when the factory did not provide one.
     bool executeOnFactory(std::function<void()> task,
@@ -1176,14 +1777,22 @@ int runSidecarMain(SidecarHost &host, const SidecarMainOptions &options = {});
 
 } // namespace phicore::adapter::sdk
 
+// The PHI_LOG_* macros skip argument construction (message, params, ctx and
+// the source-location JSON) for levels below PHI_LOG_COMPILE_MIN_LEVEL and
+// for logs the target's filter drops; they then yield `true` like a filtered
+// `log()`. `target`, `level` and `category` may be evaluated more than once.
 #ifndef PHI_LOG_WITH_SOURCE
 #define PHI_LOG_WITH_SOURCE(target, level, category, message, params, ctx)                                     \
-    (target).log((level),                                                                                      \
-                 (category),                                                                                   \
-                 (message),                                                                                    \
-                 (params),                                                                                     \
-                 (ctx),                                                                                        \
-                 ::phicore::adapter::sdk::makeSourceLocationFieldsJson(__FILE__, __LINE__, __func__))
+    (((static_cast<int>(level) >= PHI_LOG_COMPILE_MIN_LEVEL                                                   \
+       || (level) == ::phicore::adapter::sdk::LogLevel::Error)                                                 \
+      && (target).isLogEnabled((level), (category)))                                                          \
+         ? (target).log((level),                                                                               \
+                        (category),                                                                            \
+                        (message),                                                                             \
+                        (params),                                                                              \
+                        (ctx),                                                                                 \
+                        ::phicore::adapter::sdk::makeSourceLocationFieldsJson(__FILE__, __LINE__, __func__))  \
+         : true)
 #endif
 
 #ifndef PHI_LOG_DEBUG
@@ -28,6 +28,11 @@ enum class IpcCommand : std::uint16_t {
     EventAdapterMetaUpdated = 0x1003,
     EventConnectionStateChanged = 0x1004,
     EventLog = 0x1005,
+    // Interned logs, only after core announced `logTemplates` in bootstrap:
+    // a template frame registers message+ctx+category under an id, ref frames
+    // carry the id plus the per-call members.
+    EventLogTemplate = 0x1006,
+    EventLogRef = 0x1007,
 
     EventDeviceUpdated = 0x1101,
     EventDeviceRemoved = 0x1102,
@@ -0,0 +1,369 @@
+#include "json_scan.h"
+
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define PHI_JSON_SCAN_X86 1
+#endif
+
+namespace phicore::adapter::sdk::json {
+
+namespace {
+
+using Kernel = StructuralIndex::Kernel;
+
+constexpr std::size_t kBlockSize = 64;
+
+// Classifies `blocks` full 64-byte blocks starting at `text`.
+using ClassifyFn = void (*)(const char *text,
+                            std::size_t blocks,
+                            std::uint64_t *quotes,
+                            std::uint64_t *backslashes);
+
+void classifyScalar(const char *text, std::size_t blocks, std::uint64_t *quotes, std::uint64_t *backslashes)
+{
+    for (std::size_t block = 0; block < blocks; ++block) {
+        const char *p = text + block * kBlockSize;
+        std::uint64_t q = 0;
+        std::uint64_t b = 0;
+        for (std::size_t i = 0; i < kBlockSize; ++i) {
+            q |= static_cast<std::uint64_t>(p[i] == '"') << i;
+            b |= static_cast<std::uint64_t>(p[i] == '\\') << i;
+        }
+        quotes[block] = q;
+        backslashes[block] = b;
+    }
+}
+
+#if defined(PHI_JSON_SCAN_X86)
+
+// SSE2 is part of the x86-64 baseline, so this kernel needs no target switch.
+void classifySse2(const char *text, std::size_t blocks, std::uint64_t *quotes, std::uint64_t *backslashes)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (std::size_t block = 0; block < blocks; ++block) {
+        const char *p = text + block * kBlockSize;
+        std::uint64_t q = 0;
+        std::uint64_t b = 0;
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + lane * 16));
+            const auto qm = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)));
+            const auto bm = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)));
+            q |= static_cast<std::uint64_t>(qm) << (lane * 16);
+            b |= static_cast<std::uint64_t>(bm) << (lane * 16);
+        }
+        quotes[block] = q;
+        backslashes[block] = b;
+    }
+}
+
+__attribute__((target("avx2"))) void classifyAvx2(const char *text,
+                                                  std::size_t blocks,
+                                                  std::uint64_t *quotes,
+                                                  std::uint64_t *backslashes)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    for (std::size_t block = 0; block < blocks; ++block) {
+        const char *p = text + block * kBlockSize;
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+        const auto qlo = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote)));
+        const auto qhi = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)));
+        const auto blo = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, backslash)));
+        const auto bhi = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, backslash)));
+        quotes[block] = qlo | (static_cast<std::uint64_t>(qhi) << 32);
+        backslashes[block] = blo | (static_cast<std::uint64_t>(bhi) << 32);
+    }
+}
+
+#endif
+
+// First byte in [p, end) that needs an escape, or `end`.
+using FindEscapeFn = const char *(*)(const char *p, const char *end);
+
+const char *findEscapeScalar(const char *p, const char *end)
+{
+    for (; p != end; ++p) {
+        const auto ch = static_cast<unsigned char>(*p);
+        if (ch < 0x20 || ch == '"' || ch == '\\')
+            return p;
+    }
+    return end;
+}
+
+#if defined(PHI_JSON_SCAN_X86)
+
+const char *findEscapeSse2(const char *p, const char *end)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        // Unsigned ch <= 0x1f exactly when min(ch, 0x1f) == ch.
+        const __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(special));
+        if (mask != 0)
+            return p + std::countr_zero(mask);
+        p += 16;
+    }
+    return findEscapeScalar(p, end);
+}
+
+__attribute__((target("avx2"))) const char *findEscapeAvx2(const char *p, const char *end)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1f);
+    while (end - p >= 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i special = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control), chunk));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(special));
+        if (mask != 0)
+            return p + std::countr_zero(mask);
+        p += 32;
+    }
+    return findEscapeSse2(p, end);
+}
+
+#endif
+
+Kernel supportedKernel(Kernel wanted) noexcept
+{
+    const Kernel best = StructuralIndex::bestKernel();
+    return static_cast<std::uint8_t>(wanted) <= static_cast<std::uint8_t>(best) ? wanted : best;
+}
+
+ClassifyFn classifierFor(Kernel kernel) noexcept
+{
+#if defined(PHI_JSON_SCAN_X86)
+    switch (supportedKernel(kernel)) {
+    case Kernel::Avx2:
+        return &classifyAvx2;
+    case Kernel::Sse2:
+        return &classifySse2;
+    case Kernel::Scalar:
+        break;
+    }
+#else
+    (void)kernel;
+#endif
+    return &classifyScalar;
+}
+
+FindEscapeFn escapeFinderFor(Kernel kernel) noexcept
+{
+#if defined(PHI_JSON_SCAN_X86)
+    switch (supportedKernel(kernel)) {
+    case Kernel::Avx2:
+        return &findEscapeAvx2;
+    case Kernel::Sse2:
+        return &findEscapeSse2;
+    case Kernel::Scalar:
+        break;
+    }
+#else
+    (void)kernel;
+#endif
+    return &findEscapeScalar;
+}
+
+void appendEscape(std::string &out, unsigned char ch)
+{
+    switch (ch) {
+    case '"': out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\b': out += "\\b"; break;
+    case '\f': out += "\\f"; break;
+    case '\n': out += "\\n"; break;
+    case '\r': out += "\\r"; break;
+    case '\t': out += "\\t"; break;
+    default: {
+        constexpr char kHex[] = "0123456789abcdef";
+        out += "\\u00";
+        out.push_back(kHex[(ch >> 4) & 0x0f]);
+        out.push_back(kHex[ch & 0x0f]);
+        break;
+    }
+    }
+}
+
+void appendQuotedWith(std::string &out, std::string_view text, FindEscapeFn findEscape)
+{
+    out.push_back('"');
+    const char *p = text.data();
+    const char *const end = text.data() + text.size();
+    for (;;) {
+        const char *hit = findEscape(p, end);
+        out.append(p, hit);
+        if (hit == end)
+            break;
+        appendEscape(out, static_cast<unsigned char>(*hit));
+        p = hit + 1;
+    }
+    out.push_back('"');
+}
+
+Kernel kernelFromEnvironment() noexcept
+{
+    const Kernel best = StructuralIndex::bestKernel();
+    const char *value = std::getenv("PHI_ADAPTER_SDK_JSON_SCAN");
+    if (!value)
+        return best;
+    const std::string_view name(value);
+    if (name == "scalar")
+        return Kernel::Scalar;
+    if (name == "sse2")
+        return supportedKernel(Kernel::Sse2);
+    return best;
+}
+
+// Drops quotes escaped by a backslash. A backslash escapes the next byte
+// unless it is itself escaped, so runs are resolved in ascending order with
+// the escape state carried across block boundaries. Backslashes are rare in
+// this protocol, so the loop is proportional to their count, not to the text.
+void resolveEscapes(std::uint64_t *quotes, const std::uint64_t *backslashes, std::size_t blocks)
+{
+    std::uint64_t carry = 0;
+    for (std::size_t block = 0; block < blocks; ++block) {
+        std::uint64_t escaped = carry;
+        carry = 0;
+        std::uint64_t pending = backslashes[block];
+        while (pending != 0) {
+            const int bit = std::countr_zero(pending);
+            pending &= pending - 1;
+            if ((escaped >> bit) & 1U)
+                continue;
+            if (bit == 63)
+                carry = 1;
+            else
+                escaped |= std::uint64_t{1} << (bit + 1);
+        }
+        quotes[block] &= ~escaped;
+    }
+}
+
+} // namespace
+
+void StructuralIndex::build(std::string_view text)
+{
+    build(text, activeKernel());
+}
+
+void StructuralIndex::build(std::string_view text, Kernel kernel)
+{
+    m_text = text;
+    const std::size_t fullBlocks = text.size() / kBlockSize;
+    const std::size_t tail = text.size() % kBlockSize;
+    const std::size_t blocks = fullBlocks + (tail != 0 ? 1 : 0);
+    m_quotes.resize(blocks);
+    m_backslashes.resize(blocks);
+
+    const ClassifyFn classify = classifierFor(kernel);
+    classify(text.data(), fullBlocks, m_quotes.data(), m_backslashes.data());
+    if (tail != 0) {
+        // Pad the last partial block; spaces classify as nothing.
+        char padded[kBlockSize];
+        std::memset(padded, ' ', sizeof(padded));
+        std::memcpy(padded, text.data() + fullBlocks * kBlockSize, tail);
+        classify(padded, 1, m_quotes.data() + fullBlocks, m_backslashes.data() + fullBlocks);
+    }
+    resolveEscapes(m_quotes.data(), m_backslashes.data(), blocks);
+}
+
+void StructuralIndex::reset() noexcept
+{
+    m_text = {};
+    m_quotes.clear();
+    m_backslashes.clear();
+}
+
+const char *StructuralIndex::nextQuote(const char *p) const noexcept
+{
+    const std::size_t pos = static_cast<std::size_t>(p - m_text.data());
+    std::size_t block = pos >> 6;
+    const unsigned bit = static_cast<unsigned>(pos & 63);
+    std::uint64_t bits = bit == 63 ? 0 : m_quotes[block] & (~std::uint64_t{0} << (bit + 1));
+    while (bits == 0) {
+        if (++block >= m_quotes.size())
+            return nullptr;
+        bits = m_quotes[block];
+    }
+    return m_text.data() + (block << 6) + static_cast<std::size_t>(std::countr_zero(bits));
+}
+
+bool StructuralIndex::anyBackslash(const char *begin, const char *end) const noexcept
+{
+    if (begin >= end)
+        return false;
+    const std::size_t first = static_cast<std::size_t>(begin - m_text.data());
+    const std::size_t last = static_cast<std::size_t>(end - m_text.data()) - 1;
+    const std::size_t firstBlock = first >> 6;
+    const std::size_t lastBlock = last >> 6;
+    for (std::size_t block = firstBlock; block <= lastBlock; ++block) {
+        std::uint64_t bits = m_backslashes[block];
+        if (block == firstBlock)
+            bits &= ~std::uint64_t{0} << (first & 63);
+        if (block == lastBlock && (last & 63) != 63)
+            bits &= (std::uint64_t{1} << ((last & 63) + 1)) - 1;
+        if (bits != 0)
+            return true;
+    }
+    return false;
+}
+
+StructuralIndex::Kernel StructuralIndex::bestKernel() noexcept
+{
+#if defined(PHI_JSON_SCAN_X86)
+    static const Kernel best = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? Kernel::Avx2 : Kernel::Sse2;
+    }();
+    return best;
+#else
+    return Kernel::Scalar;
+#endif
+}
+
+StructuralIndex::Kernel StructuralIndex::activeKernel() noexcept
+{
+    static const Kernel active = kernelFromEnvironment();
+    return active;
+}
+
+void appendQuoted(std::string &out, std::string_view text)
+{
+    static const FindEscapeFn findEscape = escapeFinderFor(StructuralIndex::activeKernel());
+    appendQuotedWith(out, text, findEscape);
+}
+
+void appendQuoted(std::string &out, std::string_view text, StructuralIndex::Kernel kernel)
+{
+    appendQuotedWith(out, text, escapeFinderFor(kernel));
+}
+
+const char *StructuralIndex::kernelName(Kernel kernel) noexcept
+{
+    switch (kernel) {
+    case Kernel::Scalar:
+        return "scalar";
+    case Kernel::Sse2:
+        return "sse2";
+    case Kernel::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+} // namespace phicore::adapter::sdk::json
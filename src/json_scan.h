@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace phicore::adapter::sdk::json {
+
+/**
+ * @brief Vectorized structural index over one JSON text (stage 1).
+ *
+ * One pass classifies the text in 64-byte blocks into bitmaps of string
+ * delimiting quotes (quotes not escaped by a backslash) and backslashes.
+ * The recursive-descent helpers in sidecar.cpp still validate every token,
+ * but no longer walk string contents byte by byte: finding the end of a
+ * string becomes a bit scan. Strings are where the bytes of a payload are,
+ * so this is where the inbound parser spent its time.
+ *
+ * The index holds views only; the indexed text must outlive every lookup.
+ * Storage is kept across build() calls so steady-state indexing does not
+ * allocate.
+ */
+class StructuralIndex
+{
+public:
+    enum class Kernel : std::uint8_t {
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    /// Index `text` with the process-wide kernel (see activeKernel()).
+    void build(std::string_view text);
+    /// Index `text` with an explicit kernel; an unsupported one falls back to
+    /// the best supported kernel below it. Used by tests and benchmarks.
+    void build(std::string_view text, Kernel kernel);
+    void reset() noexcept;
+
+    /// Whether `p` points into the indexed text.
+    [[nodiscard]] bool covers(const char *p) const noexcept
+    {
+        return !m_text.empty() && p >= m_text.data() && p < m_text.data() + m_text.size();
+    }
+
+    [[nodiscard]] std::string_view text() const noexcept { return m_text; }
+
+    /// Whether the byte at `p` is a string delimiting (unescaped) quote.
+    [[nodiscard]] bool isQuote(const char *p) const noexcept
+    {
+        const std::size_t pos = static_cast<std::size_t>(p - m_text.data());
+        return (m_quotes[pos >> 6] >> (pos & 63)) & 1U;
+    }
+
+    /// First string delimiting quote strictly after `p`, or nullptr.
+    [[nodiscard]] const char *nextQuote(const char *p) const noexcept;
+
+    /// Whether [begin, end) contains a backslash; both must be covered or end
+    /// one past the text.
+    [[nodiscard]] bool anyBackslash(const char *begin, const char *end) const noexcept;
+
+    /// Raw bitmaps, one word per 64-byte block (bit i = byte 64 * block + i).
+    [[nodiscard]] const std::vector<std::uint64_t> &quoteBits() const noexcept { return m_quotes; }
+    [[nodiscard]] const std::vector<std::uint64_t> &backslashBits() const noexcept { return m_backslashes; }
+
+    /// Best kernel the running CPU supports.
+    [[nodiscard]] static Kernel bestKernel() noexcept;
+    /// Kernel used by build(text): bestKernel(), unless lowered with
+    /// PHI_ADAPTER_SDK_JSON_SCAN=scalar|sse2 (read once per process).
+    [[nodiscard]] static Kernel activeKernel() noexcept;
+    [[nodiscard]] static const char *kernelName(Kernel kernel) noexcept;
+
+private:
+    std::string_view m_text;
+    std::vector<std::uint64_t> m_quotes;
+    std::vector<std::uint64_t> m_backslashes;
+};
+
+/**
+ * @brief Appends `text` to `out` as a quoted JSON string.
+ *
+ * Bytes that need an escape (`"`, `\`, controls below 0x20) are searched for
+ * 16 (SSE2) or 32 (AVX2) bytes at a time and the clean runs between them are
+ * copied with one append each. Every kernel produces the same output; the
+ * default uses StructuralIndex::activeKernel().
+ */
+void appendQuoted(std::string &out, std::string_view text);
+void appendQuoted(std::string &out, std::string_view text, StructuralIndex::Kernel kernel);
+
+namespace detail {
+inline thread_local const StructuralIndex *t_activeIndex = nullptr;
+} // namespace detail
+
+/// Index the parse helpers on this thread consult, or nullptr.
+[[nodiscard]] inline const StructuralIndex *activeIndex() noexcept
+{
+    return detail::t_activeIndex;
+}
+
+/// Publishes an index to the parse helpers on this thread for one scope.
+class ScopedActiveIndex
+{
+public:
+    explicit ScopedActiveIndex(const StructuralIndex &index) noexcept
+        : m_previous(detail::t_activeIndex)
+    {
+        detail::t_activeIndex = &index;
+    }
+    ~ScopedActiveIndex() { detail::t_activeIndex = m_previous; }
+
+    ScopedActiveIndex(const ScopedActiveIndex &) = delete;
+    ScopedActiveIndex &operator=(const ScopedActiveIndex &) = delete;
+
+private:
+    const StructuralIndex *m_previous;
+};
+
+} // namespace phicore::adapter::sdk::json
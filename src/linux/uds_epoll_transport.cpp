@@ -138,8 +138,7 @@ bool UdsEpollServer::start(std::string *error)
     }
 
     m_notifyDisconnect = false;
-    m_rxBuffer.clear();
-    m_rxOffset = 0;
+    clearRxBuffer();
     return true;
 }
 
@@ -160,8 +159,7 @@ void UdsEpollServer::stop()
     if (!m_socketPath.empty())
         ::unlink(m_socketPath.c_str());
     m_notifyDisconnect = false;
-    m_rxBuffer.clear();
-    m_rxOffset = 0;
+    clearRxBuffer();
 }
 
 void UdsEpollServer::wakeup() noexcept
@@ -222,8 +220,7 @@ bool UdsEpollServer::acceptClient(const std::function<void()> &onDisconnected,
         return false;
     }
 
-    m_rxBuffer.clear();
-    m_rxOffset = 0;
+    clearRxBuffer();
     if (newClientOut)
         *newClientOut = true;
     return true;
@@ -233,11 +230,11 @@ bool UdsEpollServer::readClient(const FrameHandler &onFrame,
                                 const std::function<void()> &onDisconnected,
                                 std::string *error)
 {
-    std::byte tmp[4096];
+    char tmp[4096];
     for (;;) {
         const ssize_t n = ::read(m_clientFd, tmp, sizeof(tmp));
         if (n > 0) {
-            m_rxBuffer.insert(m_rxBuffer.end(), tmp, tmp + n);
+            writableRxBuffer().append(tmp, static_cast<std::size_t>(n));
             continue;
         }
         if (n == 0) {
@@ -254,12 +251,15 @@ bool UdsEpollServer::readClient(const FrameHandler &onFrame,
         return false;
     }
 
+    // Held for the batch: a handler that closes the connection swaps the
+    // buffer out instead of clearing bytes a payload span points into.
+    const std::shared_ptr<const std::string> buffer = m_rxBuffer;
     for (;;) {
-        const std::size_t available = m_rxBuffer.size() - m_rxOffset;
+        const std::size_t available = buffer->size() - m_rxOffset;
         if (available < phicore::adapter::v1::kFrameHeaderSize)
             break;
 
-        const std::byte *frameStart = m_rxBuffer.data() + m_rxOffset;
+        const auto *frameStart = reinterpret_cast<const std::byte *>(buffer->data()) + m_rxOffset;
         phicore::adapter::v1::FrameHeader header{};
         std::memcpy(&header, frameStart, phicore::adapter::v1::kFrameHeaderSize);
 
@@ -280,18 +280,20 @@ bool UdsEpollServer::readClient(const FrameHandler &onFrame,
         const std::span<const std::byte> payload(frameStart + phicore::adapter::v1::kFrameHeaderSize,
                                                  header.payloadSize);
         if (onFrame)
-            onFrame(header, payload);
+            onFrame(header, payload, buffer);
         if (m_clientFd < 0)
             return true; // handler closed the connection
     }
 
-    // One compaction per read batch instead of one per frame.
+    // One compaction per read batch instead of one per frame. A buffer a
+    // handler kept is left to it; the remainder moves to fresh storage.
     if (m_rxOffset > 0) {
-        if (m_rxOffset >= m_rxBuffer.size()) {
-            m_rxBuffer.clear();
+        if (buffer.use_count() > 2) {
+            writableRxBuffer();
+        } else if (m_rxOffset >= m_rxBuffer->size()) {
+            m_rxBuffer->clear();
         } else {
-            m_rxBuffer.erase(m_rxBuffer.begin(),
-                             m_rxBuffer.begin() + static_cast<std::ptrdiff_t>(m_rxOffset));
+            m_rxBuffer->erase(0, m_rxOffset);
         }
         m_rxOffset = 0;
     }
@@ -299,6 +301,24 @@ bool UdsEpollServer::readClient(const FrameHandler &onFrame,
     return true;
 }
 
+void UdsEpollServer::clearRxBuffer()
+{
+    if (m_rxBuffer.use_count() > 1)
+        m_rxBuffer = std::make_shared<std::string>();
+    else
+        m_rxBuffer->clear();
+    m_rxOffset = 0;
+}
+
+std::string &UdsEpollServer::writableRxBuffer()
+{
+    if (m_rxBuffer.use_count() > 1) {
+        m_rxBuffer = std::make_shared<std::string>(*m_rxBuffer, m_rxOffset);
+        m_rxOffset = 0;
+    }
+    return *m_rxBuffer;
+}
+
 bool UdsEpollServer::writeAll(const std::byte *data,
                               std::size_t size,
                               std::chrono::steady_clock::time_point deadline,
@@ -394,8 +414,7 @@ void UdsEpollServer::closeClient(const std::function<void()> &onDisconnected)
         m_clientFd = -1;
     }
     m_notifyDisconnect = false;
-    m_rxBuffer.clear();
-    m_rxOffset = 0;
+    clearRxBuffer();
     if (onDisconnected)
         onDisconnected();
 }
@@ -410,8 +429,7 @@ void UdsEpollServer::closeClientDeferred()
         // the notification on its next invocation.
         m_notifyDisconnect = true;
     }
-    m_rxBuffer.clear();
-    m_rxOffset = 0;
+    clearRxBuffer();
 }
 
 bool UdsEpollServer::pollOnce(std::chrono::milliseconds timeout,
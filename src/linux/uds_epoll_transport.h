@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <span>
 #include <string>
 #include <vector>
@@ -15,7 +16,11 @@ namespace phicore::adapter::sdk::linuxio {
 class UdsEpollServer
 {
 public:
-    using FrameHandler = std::function<void(const phicore::adapter::v1::FrameHeader &, std::span<const std::byte>)>;
+    /// `payload` lies inside `*buffer`; a handler that keeps views into the
+    /// payload past its return shares `buffer` instead of copying the bytes.
+    using FrameHandler = std::function<void(const phicore::adapter::v1::FrameHeader &header,
+                                            std::span<const std::byte> payload,
+                                            const std::shared_ptr<const std::string> &buffer)>;
 
     explicit UdsEpollServer(std::string socketPath);
     ~UdsEpollServer();
@@ -66,6 +71,10 @@ private:
     void closeClient(const std::function<void()> &onDisconnected);
     void closeClientDeferred();
     void drainWakeFd();
+    void clearRxBuffer();
+    /// The receive buffer, first moved to fresh storage if a handler still
+    /// shares it; only the unconsumed bytes are carried over.
+    std::string &writableRxBuffer();
 
     std::string m_socketPath;
     int m_serverFd = -1;
@@ -73,7 +82,9 @@ private:
     int m_clientFd = -1;
     int m_wakeFd = -1;
     bool m_notifyDisconnect = false;
-    std::vector<std::byte> m_rxBuffer;
+    // Shared with frame handlers that retain payload views, so it is never
+    // modified while another owner holds it (see writableRxBuffer()).
+    std::shared_ptr<std::string> m_rxBuffer = std::make_shared<std::string>();
     // Read cursor into m_rxBuffer: frames are consumed by advancing it and the
     // buffer is compacted once per read batch instead of memmoving the
     // remainder for every single frame.
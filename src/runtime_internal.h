@@ -15,7 +15,11 @@ namespace phicore::adapter::sdk {
 struct RuntimeCallbacks {
     std::function<void()> onConnected;
     std::function<void()> onDisconnected;
-    std::function<void(const phicore::adapter::v1::FrameHeader &, std::span<const std::byte>)> onFrame;
+    /// The payload lies inside the shared receive buffer (see UdsEpollServer::FrameHandler).
+    std::function<void(const phicore::adapter::v1::FrameHeader &,
+                       std::span<const std::byte>,
+                       const std::shared_ptr<const std::string> &)>
+        onFrame;
 };
 
 class SidecarRuntime
@@ -1,5 +1,7 @@
 #include "phi/adapter/sdk/sidecar.h"
+#include "json_scan.h"
 #include "runtime_internal.h"
+#include "wire_schema.h"
 
 #include <algorithm>
 #include <array>
@@ -10,13 +12,18 @@
 #include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <list>
 #include <locale>
 #include <sstream>
 #include <string_view>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -29,6 +36,7 @@ using phicore::adapter::v1::ActionResultType;
 using phicore::adapter::v1::Adapter;
 using phicore::adapter::v1::AdapterActionDescriptor;
 using phicore::adapter::v1::AdapterCapabilities;
+using phicore::adapter::v1::AdapterConfigOption;
 using phicore::adapter::v1::Channel;
 using phicore::adapter::v1::ChannelList;
 using phicore::adapter::v1::CmdId;
@@ -37,6 +45,7 @@ using phicore::adapter::v1::CmdStatus;
 using phicore::adapter::v1::CorrelationId;
 using phicore::adapter::v1::Device;
 using phicore::adapter::v1::DeviceEffect;
+using phicore::adapter::v1::DeviceEffectDescriptor;
 using phicore::adapter::v1::Group;
 using phicore::adapter::v1::IpcCommand;
 using phicore::adapter::v1::MessageType;
@@ -79,7 +88,16 @@ constexpr std::size_t kHostQueueWarnThreshold = 512;
 // (then the oldest event frame) is shed; Response frames (Result*/descriptor)
 // are never shed and may exceed the cap.
 constexpr std::size_t kHostQueueMaxDepth = 4096;
+// Log frames one thread may buffer between two flushes; further logs are
+// dropped and counted. Matches the queue cap so a burst loses no more than a
+// queued one would.
+constexpr std::size_t kLogRingCapacity = 4096;
 constexpr std::int64_t kHostDiagRateLimitMs = 5000;
+// Send backlog at which Trace, then Debug logs are throttled. A stage is left
+// below half its threshold, once the backlog stayed there this long.
+constexpr std::size_t kLogThrottleTraceBacklog = kHostQueueMaxDepth / 4;
+constexpr std::size_t kLogThrottleDebugBacklog = kHostQueueMaxDepth / 2;
+constexpr std::int64_t kLogThrottleCalmMs = 1000;
 
 // Enum and wire share one numbering since F-39, so this is a straight mapping -
 // kept explicit (rather than a cast) so an out-of-range value cannot reach the
@@ -112,6 +130,14 @@ std::uint8_t encodeWireCategory(LogCategory category, bool incident)
 
 std::string jsonQuoted(std::string_view text);
 
+template <typename Integer>
+void appendInteger(std::string &out, Integer value)
+{
+    std::array<char, 24> buf{};
+    const auto result = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+    out.append(buf.data(), result.ptr);
+}
+
 std::string_view fileNameOnly(std::string_view path)
 {
     std::size_t slashPos = path.find_last_of('/');
@@ -164,12 +190,39 @@ struct MemberMap {
     }
 };
 
-std::int64_t nowMs()
+// ---------------------------------------------------------------------------
+// Wall clock
+// ---------------------------------------------------------------------------
+
+std::atomic<SidecarClock::Source> g_clockSource{nullptr};
+
+constexpr std::int64_t kClockUnanchored = std::numeric_limits<std::int64_t>::min();
+// Wall minus steady ms. Only moved when the wall clock drifted further than
+// kClockReanchorMs from it, so converted steady stamps stay ordered.
+std::atomic<std::int64_t> g_steadyToWallOffsetMs{kClockUnanchored};
+constexpr std::int64_t kClockReanchorMs = 50;
+
+std::int64_t systemWallMs() noexcept
 {
+#ifdef CLOCK_REALTIME_COARSE
+    timespec ts{};
+    if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0)
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#endif
     const auto now = std::chrono::system_clock::now();
     return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
 }
 
+std::int64_t steadyMs(std::chrono::steady_clock::time_point timePoint) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(timePoint.time_since_epoch()).count();
+}
+
+std::int64_t nowMs()
+{
+    return SidecarClock::nowMs();
+}
+
 void hostStderrLine(const std::string &line)
 {
     std::cerr << line << std::endl;
@@ -465,8 +518,271 @@ private:
     std::thread m_thread;
 };
 
+// ---------------------------------------------------------------------------
+// Worker pool
+// ---------------------------------------------------------------------------
+
+// Process-wide workers shared by every pooled backend. Each backend is a
+// strand: its tasks form one queue, and the strand sits in the ready queue at
+// most once, so a single worker runs it at a time and in order. A worker runs
+// one task per turn and re-queues the strand at the back, so a busy instance
+// cannot starve the others.
+//
+// Like the abandoned thread registry the pool is never destroyed; idle workers
+// only ever wait on its condition variable.
+class InstanceWorkerPool
+{
+public:
+    struct Worker {
+        std::thread thread;
+        bool retire = false;
+        bool exited = false;
+    };
+
+    struct Strand {
+        std::deque<std::function<void()>> tasks;
+        std::condition_variable idleCv;
+        bool started = false;
+        bool stopRequested = false;
+        // In the ready queue or running on a worker.
+        bool scheduled = false;
+        // Given up by a timed-out stop(); never runs another task.
+        bool abandoned = false;
+        Worker *runningOn = nullptr;
+    };
+
+    static InstanceWorkerPool &instance()
+    {
+        static InstanceWorkerPool *pool = new InstanceWorkerPool(
+            std::max<std::size_t>(2, std::thread::hardware_concurrency()));
+        return *pool;
+    }
+
+    std::mutex &mutex() { return m_mutex; }
+
+    // Queues the strand behind the others unless it is already scheduled.
+    // Caller holds mutex().
+    void schedule(const std::shared_ptr<Strand> &strand)
+    {
+        if (strand->scheduled)
+            return;
+        strand->scheduled = true;
+        m_ready.push_back(strand);
+        m_taskCv.notify_one();
+    }
+
+    // Takes the strand out of the pool after a timed-out stop(): its queued
+    // tasks are handed back (to be destroyed outside the lock) and a worker
+    // stuck inside it is retired. Caller holds mutex().
+    std::deque<std::function<void()>> abandon(const std::shared_ptr<Strand> &strand)
+    {
+        strand->abandoned = true;
+        if (!strand->runningOn && strand->scheduled) {
+            m_ready.erase(std::remove(m_ready.begin(), m_ready.end(), strand), m_ready.end());
+            strand->scheduled = false;
+        }
+        retireWorkerOf(*strand);
+        return std::exchange(strand->tasks, {});
+    }
+
+private:
+    explicit InstanceWorkerPool(std::size_t workers)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < workers; ++i)
+            spawnWorker();
+    }
+
+    // The worker stuck inside `strand` leaves the pool once its task returns
+    // and a fresh worker takes its place. Caller holds m_mutex.
+    void retireWorkerOf(Strand &strand)
+    {
+        Worker *stuck = strand.runningOn;
+        if (!stuck || stuck->retire)
+            return;
+        stuck->retire = true;
+        for (auto it = m_workers.begin(); it != m_workers.end(); ++it) {
+            if (it->get() != stuck)
+                continue;
+            std::shared_ptr<Worker> worker = std::move(*it);
+            m_workers.erase(it);
+            AbandonedThreadRegistry::instance().adopt(std::move(worker->thread), [this, worker]() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return worker->exited;
+            });
+            break;
+        }
+        spawnWorker();
+    }
+
+    // Caller holds m_mutex. A failed spawn leaves the pool one worker short
+    // rather than failing the caller; the remaining workers keep draining.
+    void spawnWorker()
+    {
+        auto worker = std::make_shared<Worker>();
+        try {
+            worker->thread = std::thread([this, worker]() { run(*worker); });
+        } catch (const std::exception &ex) {
+            hostStderrLine(std::string("[sidecar][workerPool][host] spawn failed: ") + ex.what());
+            return;
+        }
+        m_workers.push_back(std::move(worker));
+    }
+
+    void run(Worker &worker)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!worker.retire) {
+            m_taskCv.wait(lock, [this]() { return !m_ready.empty(); });
+            std::shared_ptr<Strand> strand = std::move(m_ready.front());
+            m_ready.pop_front();
+            std::function<void()> task = std::move(strand->tasks.front());
+            strand->tasks.pop_front();
+            strand->runningOn = &worker;
+            lock.unlock();
+            try {
+                task();
+            } catch (...) {
+                // Adapter exceptions are contained so the worker remains alive.
+            }
+            task = nullptr;
+            lock.lock();
+            strand->runningOn = nullptr;
+            if (strand->abandoned || strand->tasks.empty()) {
+                strand->scheduled = false;
+                strand->idleCv.notify_all();
+            } else {
+                m_ready.push_back(std::move(strand));
+                if (worker.retire)
+                    m_taskCv.notify_one();
+            }
+        }
+        worker.exited = true;
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskCv;
+    std::deque<std::shared_ptr<Strand>> m_ready;
+    std::vector<std::shared_ptr<Worker>> m_workers;
+};
+
+class PooledInstanceExecutionBackend final : public InstanceExecutionBackend
+{
+public:
+    ~PooledInstanceExecutionBackend() override
+    {
+        phicore::adapter::v1::Utf8String ignoreError;
+        stop(kShutdownBudget, &ignoreError);
+    }
+
+    bool start(phicore::adapter::v1::Utf8String *error = nullptr) override
+    {
+        (void)error;
+        std::lock_guard<std::mutex> lock(m_pool.mutex());
+        m_strand->started = true;
+        m_strand->stopRequested = false;
+        return true;
+    }
+
+    bool execute(std::function<void()> task, phicore::adapter::v1::Utf8String *error = nullptr) override
+    {
+        if (!task) {
+            if (error)
+                *error = "Execution task is empty";
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_pool.mutex());
+        if (!m_strand->started) {
+            if (error)
+                *error = "Execution backend not started";
+            return false;
+        }
+        if (m_strand->stopRequested) {
+            if (error)
+                *error = "Execution backend is stopping";
+            return false;
+        }
+        m_strand->tasks.push_back(std::move(task));
+        m_pool.schedule(m_strand);
+        return true;
+    }
+
+    bool stop(std::chrono::milliseconds timeout,
+              phicore::adapter::v1::Utf8String *error = nullptr) override
+    {
+        std::unique_lock<std::mutex> lock(m_pool.mutex());
+        const std::shared_ptr<Strand> strand = m_strand;
+        if (!strand->started)
+            return true;
+        strand->stopRequested = true;
+        const auto effectiveTimeout = timeout < std::chrono::milliseconds::zero()
+            ? std::chrono::milliseconds::zero()
+            : timeout;
+        // Queued tasks still run before the strand counts as stopped, as on
+        // the dedicated-thread backend.
+        if (!strand->idleCv.wait_for(lock, effectiveTimeout, [&strand]() { return !strand->scheduled; })) {
+            // Tasks still queued are dropped rather than run after stop()
+            // returned; a fresh strand lets this backend start again without
+            // waiting for a stuck task.
+            std::deque<std::function<void()>> dropped = m_pool.abandon(strand);
+            m_strand = std::make_shared<Strand>();
+            lock.unlock();
+            dropped.clear();
+            if (error)
+                *error = "Timed out waiting for execution backend stop";
+            return false;
+        }
+        strand->started = false;
+        strand->stopRequested = false;
+        return true;
+    }
+
+private:
+    using Strand = InstanceWorkerPool::Strand;
+
+    InstanceWorkerPool &m_pool = InstanceWorkerPool::instance();
+    std::shared_ptr<Strand> m_strand = std::make_shared<Strand>();
+};
+
 } // namespace
 
+std::int64_t SidecarClock::nowMs() noexcept
+{
+    const Source source = g_clockSource.load(std::memory_order_acquire);
+    return source ? source() : systemWallMs();
+}
+
+std::int64_t SidecarClock::wallMs(std::chrono::steady_clock::time_point timePoint) noexcept
+{
+    std::int64_t offset = g_steadyToWallOffsetMs.load(std::memory_order_relaxed);
+    if (offset == kClockUnanchored) {
+        refresh();
+        offset = g_steadyToWallOffsetMs.load(std::memory_order_relaxed);
+    }
+    return steadyMs(timePoint) + offset;
+}
+
+void SidecarClock::refresh() noexcept
+{
+    const std::int64_t offset = nowMs() - steadyMs(std::chrono::steady_clock::now());
+    std::int64_t current = g_steadyToWallOffsetMs.load(std::memory_order_relaxed);
+    while (current == kClockUnanchored || std::abs(offset - current) > kClockReanchorMs) {
+        if (g_steadyToWallOffsetMs.compare_exchange_weak(current, offset, std::memory_order_relaxed))
+            return;
+    }
+}
+
+void SidecarClock::setSource(Source source) noexcept
+{
+    g_clockSource.store(source, std::memory_order_release);
+    g_steadyToWallOffsetMs.store(kClockUnanchored, std::memory_order_relaxed);
+}
+
+std::unique_ptr<InstanceExecutionBackend> createPooledInstanceExecutionBackend()
+{
+    return std::make_unique<PooledInstanceExecutionBackend>();
+}
+
 std::size_t reapAbandonedExecutionThreads(std::chrono::milliseconds grace)
 {
     return AbandonedThreadRegistry::instance().reap(
@@ -479,16 +795,28 @@ phicore::adapter::v1::JsonText makeSourceLocationFieldsJson(const char *file,
 {
     const std::string_view fileView = file ? std::string_view(file) : std::string_view();
     const std::string_view fnView = functionName ? std::string_view(functionName) : std::string_view();
-    const std::string body = std::string("{\"file\":")
-        + jsonQuoted(std::string(fileNameOnly(fileView)))
-        + ",\"line\":"
-        + std::to_string(line > 0 ? line : 0)
-        + ",\"func\":"
-        + jsonQuoted(std::string(fnView))
-        + "}";
+    std::string body = "{\"file\":";
+    json::appendQuoted(body, fileNameOnly(fileView));
+    body += ",\"line\":";
+    appendInteger(body, line > 0 ? line : 0);
+    body += ",\"func\":";
+    json::appendQuoted(body, fnView);
+    body.push_back('}');
     return body;
 }
 
+NumericChannelFilter makeNumericChannelFilter(const phicore::adapter::v1::Channel &channel)
+{
+    NumericChannelFilter filter;
+    if (std::isfinite(channel.stepValue) && channel.stepValue > 0.0) {
+        filter.quantizationStep = channel.stepValue;
+    } else if (std::isfinite(channel.minValue) && std::isfinite(channel.maxValue)
+               && channel.maxValue > channel.minValue) {
+        filter.absoluteDeadband = (channel.maxValue - channel.minValue) / 1000.0;
+    }
+    return filter;
+}
+
 namespace {
 
 void skipWs(std::string_view text, std::size_t &i)
@@ -515,6 +843,18 @@ bool skipStringToken(std::string_view text, std::size_t &i, std::string *error)
             *error = "Expected JSON string";
         return false;
     }
+    // Inside an indexed frame the closing quote is one bit scan away. The
+    // index must agree that this quote opens a string; anything it cannot
+    // answer (no delimiter inside this slice) takes the scalar walk, which
+    // also produces the error text.
+    if (const json::StructuralIndex *index = json::activeIndex();
+        index && index->covers(text.data() + i) && index->isQuote(text.data() + i)) {
+        const char *close = index->nextQuote(text.data() + i);
+        if (close && close < text.data() + text.size()) {
+            i = static_cast<std::size_t>(close - text.data()) + 1;
+            return true;
+        }
+    }
     ++i;
     while (i < text.size()) {
         const char ch = text[i++];
@@ -678,6 +1018,154 @@ bool skipValueToken(std::string_view text, std::size_t &i, std::string *error)
     return false;
 }
 
+constexpr std::size_t kMaxJsonCheckDepth = 512;
+
+bool skipLiteralOrNumber(std::string_view text, std::size_t &i)
+{
+    for (const std::string_view literal : {std::string_view("true"), std::string_view("false"), std::string_view("null")}) {
+        if (text.substr(i, literal.size()) == literal) {
+            i += literal.size();
+            return true;
+        }
+    }
+    return skipNumberToken(text, i);
+}
+
+// Object member key and ':'; leaves `i` before the member value.
+bool skipMemberKey(std::string_view text, std::size_t &i)
+{
+    skipWs(text, i);
+    if (!skipStringToken(text, i, nullptr))
+        return false;
+    skipWs(text, i);
+    if (i >= text.size() || text[i] != ':')
+        return false;
+    ++i;
+    return true;
+}
+
+// True when `text` is exactly one JSON value (surrounding whitespace allowed),
+// as lenient as the request decoder. Iterative with a fixed container stack,
+// so hostile nesting cannot exhaust the thread stack; deeper than
+// kMaxJsonCheckDepth is rejected.
+bool isJsonValue(std::string_view text)
+{
+    std::array<char, kMaxJsonCheckDepth> open{};
+    std::size_t depth = 0;
+    std::size_t i = 0;
+    for (;;) {
+        skipWs(text, i);
+        if (i >= text.size())
+            return false;
+        const char ch = text[i];
+        if (ch == '{' || ch == '[') {
+            if (depth == open.size())
+                return false;
+            ++i;
+            skipWs(text, i);
+            const char close = ch == '{' ? '}' : ']';
+            if (i >= text.size() || text[i] != close) {
+                open[depth++] = close;
+                if (close == '}' && !skipMemberKey(text, i))
+                    return false;
+                continue;
+            }
+            ++i;
+        } else if (ch == '"') {
+            if (!skipStringToken(text, i, nullptr))
+                return false;
+        } else if (!skipLiteralOrNumber(text, i)) {
+            return false;
+        }
+        // One value done: close finished containers, then expect the next
+        // element or member.
+        for (;;) {
+            skipWs(text, i);
+            if (depth == 0)
+                return i == text.size();
+            if (i >= text.size())
+                return false;
+            const char close = open[depth - 1];
+            if (text[i] == close) {
+                ++i;
+                --depth;
+                continue;
+            }
+            if (text[i] != ',')
+                return false;
+            ++i;
+            if (close == '}' && !skipMemberKey(text, i))
+                return false;
+            break;
+        }
+    }
+}
+
+// Outbound validation of caller JsonText (setOutboundJsonValidation). Off
+// unless enabled in code or with PHI_ADAPTER_SDK_VALIDATE_JSON=1.
+bool outboundJsonValidationFromEnvironment() noexcept
+{
+    const char *value = std::getenv("PHI_ADAPTER_SDK_VALIDATE_JSON");
+    return value && std::string_view(value) == "1";
+}
+
+std::atomic_bool g_outboundJsonValidation{outboundJsonValidationFromEnvironment()};
+std::atomic<std::int64_t> g_lastInvalidJsonDiagTsMs{0};
+std::atomic<std::uint64_t> g_invalidJsonSuppressed{0};
+
+// Fragments sent repeatedly (static metaJson, configSchemaJson, field
+// templates) are remembered once they passed, so the second send costs a
+// hash and a compare instead of a parse. Slots keep the text itself and a
+// hit needs equal bytes; a hash match alone never skips the parse.
+// Direct-mapped and per thread: no locking, a colliding fragment simply
+// evicts the slot. Short fragments parse faster than a lookup, and long ones
+// are not worth keeping a copy of.
+constexpr std::size_t kValidJsonMemoMinBytes = 64;
+constexpr std::size_t kValidJsonMemoMaxBytes = 4096;
+constexpr std::size_t kValidJsonMemoSlots = 64;
+
+thread_local std::array<std::string, kValidJsonMemoSlots> t_validJsonMemo{};
+
+void reportInvalidOutboundJson(std::string_view token)
+{
+    const std::int64_t tsMs = nowMs();
+    std::int64_t last = g_lastInvalidJsonDiagTsMs.load(std::memory_order_relaxed);
+    if (tsMs - last < kHostDiagRateLimitMs
+        || !g_lastInvalidJsonDiagTsMs.compare_exchange_strong(last, tsMs, std::memory_order_relaxed)) {
+        g_invalidJsonSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const std::uint64_t suppressed = g_invalidJsonSuppressed.exchange(0, std::memory_order_relaxed);
+    hostStderrLine("[sidecar][invalidOutboundJson][host] bytes=" + std::to_string(token.size())
+                   + " suppressed=" + std::to_string(suppressed) + " json=" + shortened(token));
+}
+
+// `token` is trimmed and non-empty. Reports and returns false when it is not
+// one JSON value.
+bool verifiedJson(std::string_view token)
+{
+    if (token.size() < kValidJsonMemoMinBytes || token.size() > kValidJsonMemoMaxBytes) {
+        if (isJsonValue(token))
+            return true;
+        reportInvalidOutboundJson(token);
+        return false;
+    }
+    std::string &slot = t_validJsonMemo[std::hash<std::string_view>{}(token) % kValidJsonMemoSlots];
+    if (slot == token)
+        return true;
+    if (!isJsonValue(token)) {
+        reportInvalidOutboundJson(token);
+        return false;
+    }
+    slot.assign(token);
+    return true;
+}
+
+bool outboundJsonRejected(std::string_view token)
+{
+    return g_outboundJsonValidation.load(std::memory_order_relaxed) && !verifiedJson(token);
+}
+
 bool parseHex4(std::string_view text, std::size_t pos, std::uint32_t *out)
 {
     if (pos + 4 > text.size())
@@ -722,6 +1210,16 @@ void appendUtf8(std::string *out, std::uint32_t codePoint)
     out->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
 }
 
+// True when [begin, end) holds a backslash, i.e. a string slice needs escape
+// decoding. Answered from the frame's structural index when it covers the
+// slice, otherwise by memchr.
+bool hasBackslash(const char *begin, const char *end)
+{
+    if (const json::StructuralIndex *index = json::activeIndex(); index && index->covers(begin))
+        return index->anyBackslash(begin, end);
+    return std::memchr(begin, '\\', static_cast<std::size_t>(end - begin)) != nullptr;
+}
+
 bool decodeJsonString(std::string_view token, std::string *out, std::string *error)
 {
     token = trim(token);
@@ -731,14 +1229,25 @@ bool decodeJsonString(std::string_view token, std::string *out, std::string *err
         return false;
     }
 
+    // Escape-free strings (nearly every ID and name) are one copy.
+    const std::string_view body = token.substr(1, token.size() - 2);
+    if (!hasBackslash(body.data(), body.data() + body.size())) {
+        out->assign(body);
+        return true;
+    }
+
     out->clear();
-    out->reserve(token.size() - 2);
+    out->reserve(body.size());
     for (std::size_t i = 1; i + 1 < token.size(); ++i) {
-        const char ch = token[i];
-        if (ch != '\\') {
-            out->push_back(ch);
-            continue;
-        }
+        // Copy the run up to the next escape in one append.
+        const char *run = token.data() + i;
+        const void *escape = std::memchr(run, '\\', token.size() - 1 - i);
+        const std::size_t runLength =
+            escape ? static_cast<std::size_t>(static_cast<const char *>(escape) - run) : token.size() - 1 - i;
+        out->append(run, runLength);
+        i += runLength;
+        if (i + 1 >= token.size())
+            break;
         if (i + 1 >= token.size() - 1) {
             if (error)
                 *error = "Invalid JSON escape";
@@ -796,7 +1305,12 @@ bool decodeJsonString(std::string_view token, std::string *out, std::string *err
     return true;
 }
 
-bool parseObjectMembers(std::string_view objectJson, MemberMap *out, std::string *error)
+// Walks the members of one JSON object in document order and hands each
+// (key, value token) pair to `onMember(key, value, keyIsOwned)`. Keys and values
+// are views into `objectJson`; a key with escapes is decoded into scratch
+// storage that only lives for the callback (`keyIsOwned` is then true).
+template <typename OnMember>
+bool forEachObjectMember(std::string_view objectJson, OnMember &&onMember, std::string *error)
 {
     objectJson = trim(objectJson);
     std::size_t i = 0;
@@ -807,25 +1321,24 @@ bool parseObjectMembers(std::string_view objectJson, MemberMap *out, std::string
     }
     ++i;
     skipWs(objectJson, i);
-    out->clear();
     if (i < objectJson.size() && objectJson[i] == '}')
         return true;
 
+    std::string decodedKey;
     while (i < objectJson.size()) {
         const std::size_t keyStart = i;
         if (!skipStringToken(objectJson, i, error))
             return false;
         const std::string_view keyToken = objectJson.substr(keyStart, i - keyStart);
         std::string_view key;
-        if (keyToken.find('\\') == std::string_view::npos) {
+        const bool keyHasEscape = hasBackslash(keyToken.data(), keyToken.data() + keyToken.size());
+        if (!keyHasEscape) {
             // Common case: the raw text between the quotes is the key.
             key = keyToken.substr(1, keyToken.size() - 2);
         } else {
-            std::string decoded;
-            if (!decodeJsonString(keyToken, &decoded, error))
+            if (!decodeJsonString(keyToken, &decodedKey, error))
                 return false;
-            out->ownedKeys.push_back(std::move(decoded));
-            key = out->ownedKeys.back();
+            key = decodedKey;
         }
 
         skipWs(objectJson, i);
@@ -841,7 +1354,7 @@ bool parseObjectMembers(std::string_view objectJson, MemberMap *out, std::string
         if (!skipValueToken(objectJson, i, error))
             return false;
         const std::size_t valueEnd = i;
-        out->insertOrAssign(key, trim(objectJson.substr(valueStart, valueEnd - valueStart)));
+        onMember(key, trim(objectJson.substr(valueStart, valueEnd - valueStart)), keyHasEscape);
 
         skipWs(objectJson, i);
         if (i < objectJson.size() && objectJson[i] == ',') {
@@ -861,6 +1374,27 @@ bool parseObjectMembers(std::string_view objectJson, MemberMap *out, std::string
     return false;
 }
 
+bool parseObjectMembers(std::string_view objectJson, MemberMap *out, std::string *error)
+{
+    const std::string_view trimmed = trim(objectJson);
+    if (trimmed.empty() || trimmed.front() != '{') {
+        if (error)
+            *error = "Expected JSON object";
+        return false;
+    }
+    out->clear();
+    return forEachObjectMember(
+        trimmed,
+        [out](std::string_view key, std::string_view value, bool keyIsOwned) {
+            if (keyIsOwned) {
+                out->ownedKeys.emplace_back(key);
+                key = out->ownedKeys.back();
+            }
+            out->insertOrAssign(key, value);
+        },
+        error);
+}
+
 bool parseArrayElements(std::string_view arrayJson, std::vector<std::string_view> *out, std::string *error)
 {
     arrayJson = trim(arrayJson);
@@ -937,30 +1471,16 @@ bool parseUInt64(std::string_view token, std::uint64_t *value)
 bool parseDouble(std::string_view token, double *value)
 {
     token = trim(token);
+    // JSON has no leading '+', but the token scanner has always let one
+    // through; from_chars does not take it.
+    if (token.size() > 1 && token.front() == '+' && token[1] != '-')
+        token.remove_prefix(1);
     if (token.empty())
         return false;
-
-#if defined(__cpp_lib_to_chars) && (__cpp_lib_to_chars >= 201611L)
-    {
-        double parsed = 0.0;
-        const char *begin = token.data();
-        const char *end = token.data() + token.size();
-        const auto result = std::from_chars(begin, end, parsed, std::chars_format::general);
-        if (result.ec == std::errc() && result.ptr == end) {
-            *value = parsed;
-            return true;
-        }
-    }
-#endif
-
-    std::istringstream iss{std::string(token)};
-    iss.imbue(std::locale::classic());
     double parsed = 0.0;
-    iss >> parsed;
-    if (iss.fail())
-        return false;
-    iss >> std::ws;
-    if (!iss.eof())
+    const char *end = token.data() + token.size();
+    const auto result = std::from_chars(token.data(), end, parsed, std::chars_format::general);
+    if (result.ec != std::errc() || result.ptr != end)
         return false;
     *value = parsed;
     return true;
@@ -998,7 +1518,7 @@ bool parseScalarValueToken(std::string_view token, ScalarValue *value)
         std::string text;
         if (!decodeJsonString(token, &text, nullptr))
             return false;
-        *value = text;
+        *value = std::move(text);
         return true;
     }
     if (token == "true") {
@@ -1013,17 +1533,21 @@ bool parseScalarValueToken(std::string_view token, ScalarValue *value)
         *value = std::monostate{};
         return true;
     }
-    if (token.find_first_of(".eE") != std::string_view::npos) {
-        double d = 0.0;
-        if (!parseDouble(token, &d))
-            return false;
-        *value = d;
+    // Integers are the common case; a fraction or exponent stops the integer
+    // parse and the token is re-read as a double.
+    std::int64_t i = 0;
+    const char *end = token.data() + token.size();
+    const auto result = std::from_chars(token.data(), end, i);
+    if (result.ec == std::errc() && result.ptr == end) {
+        *value = i;
         return true;
     }
-    std::int64_t i = 0;
-    if (!parseInt64(token, &i))
+    if (token.find_first_of(".eE") == std::string_view::npos)
+        return false;
+    double d = 0.0;
+    if (!parseDouble(token, &d))
         return false;
-    *value = i;
+    *value = d;
     return true;
 }
 
@@ -1037,6 +1561,14 @@ std::string decodeStringOrDefault(std::string_view token, std::string_view def =
     return value;
 }
 
+// Decodes into an existing string, reusing its capacity; an invalid token
+// leaves it empty.
+void decodeStringInto(std::string_view token, std::string *out)
+{
+    if (token.empty() || !decodeJsonString(token, out, nullptr))
+        out->clear();
+}
+
 std::int64_t parseIntOrDefault(std::string_view token, std::int64_t fallback = 0)
 {
     std::int64_t value = fallback;
@@ -1269,33 +1801,18 @@ bool shouldForwardLog(const LogFilterCache &cache, LogLevel level, LogCategory c
     return (cache.categoryMask & static_cast<std::uint16_t>(1U << idx)) != 0;
 }
 
+// The configured filter, tightened while the dispatcher's send backlog is high.
+bool forwardsLog(const LogFilterCache &cache, const SidecarDispatcher *dispatcher, LogLevel level, LogCategory category)
+{
+    return shouldForwardLog(cache, level, category)
+        && (!dispatcher || static_cast<int>(level) >= static_cast<int>(dispatcher->logThrottleLevel()));
+}
+
 std::string jsonQuoted(std::string_view text)
 {
     std::string out;
     out.reserve(text.size() + 2);
-    out.push_back('"');
-    for (const char ch : text) {
-        switch (ch) {
-        case '"': out += "\\\""; break;
-        case '\\': out += "\\\\"; break;
-        case '\b': out += "\\b"; break;
-        case '\f': out += "\\f"; break;
-        case '\n': out += "\\n"; break;
-        case '\r': out += "\\r"; break;
-        case '\t': out += "\\t"; break;
-        default:
-            if (static_cast<unsigned char>(ch) < 0x20) {
-                out += "\\u00";
-                constexpr char kHex[] = "0123456789abcdef";
-                out.push_back(kHex[(ch >> 4) & 0x0f]);
-                out.push_back(kHex[ch & 0x0f]);
-            } else {
-                out.push_back(ch);
-            }
-            break;
-        }
-    }
-    out.push_back('"');
+    json::appendQuoted(out, text);
     return out;
 }
 
@@ -1304,41 +1821,108 @@ void appendFieldPrefix(std::string &out, bool &first, std::string_view key)
     if (!first)
         out.push_back(',');
     first = false;
-    out += jsonQuoted(key);
+    json::appendQuoted(out, key);
     out.push_back(':');
 }
 
 void appendCommandField(std::string &out, bool &first, IpcCommand command)
 {
     appendFieldPrefix(out, first, "command");
-    out += std::to_string(phicore::adapter::v1::toUint16(command));
+    appendInteger(out, phicore::adapter::v1::toUint16(command));
 }
 
+// Running size of recent frames per command. openEnvelope() reserves the
+// buffer from it, so a frame is normally encoded into a single allocation that
+// is then queued as is. Only a hint: relaxed, racy updates are fine.
+class FrameSizeStats
+{
+public:
+    std::size_t estimate(IpcCommand command) const noexcept
+    {
+        return m_sizes[slot(command)].load(std::memory_order_relaxed);
+    }
+
+    // Follows growth at once and decays by 1/8 per smaller frame, so a command
+    // whose size varies is reserved for its recent larger frames.
+    void record(IpcCommand command, std::size_t size) noexcept
+    {
+        std::atomic<std::uint32_t> &estimate = m_sizes[slot(command)];
+        const std::uint32_t previous = estimate.load(std::memory_order_relaxed);
+        const auto sample = static_cast<std::uint32_t>(std::min(size, kMaxReserve));
+        estimate.store(sample >= previous ? sample : previous - (previous - sample) / 8,
+                       std::memory_order_relaxed);
+    }
+
+private:
+    // Large frames (descriptors, stream data) grow normally past this.
+    static constexpr std::size_t kMaxReserve = 64 * 1024;
+
+    // Command class in the high byte (< 0x40), index within it in the low bits.
+    static std::size_t slot(IpcCommand command) noexcept
+    {
+        const std::uint16_t raw = phicore::adapter::v1::toUint16(command);
+        return (static_cast<std::size_t>((raw >> 8) & 0x3fU) << 3) | (raw & 0x7U);
+    }
+
+    std::array<std::atomic<std::uint32_t>, 512> m_sizes{};
+};
+
+constinit FrameSizeStats g_frameSizes;
+
+// Envelope head of `Command`, spelled out at compile time: `{"command":N` and
+// the event form `{"command":N,"payload":{`.
+template <IpcCommand Command>
+struct EnvelopePrefix {
+    static constexpr std::uint16_t kRaw = phicore::adapter::v1::toUint16(Command);
+    static constexpr std::size_t kDigits = kRaw >= 10000 ? 5 : kRaw >= 1000 ? 4 : kRaw >= 100 ? 3 : kRaw >= 10 ? 2 : 1;
+    static constexpr std::string_view kHead = "{\"command\":";
+    static constexpr std::string_view kPayload = ",\"payload\":{";
+
+    static constexpr auto kText = [] {
+        std::array<char, kHead.size() + kDigits + kPayload.size()> text{};
+        std::size_t pos = 0;
+        for (const char ch : kHead)
+            text[pos++] = ch;
+        for (std::size_t i = kDigits, raw = kRaw; i > 0; --i, raw /= 10)
+            text[pos + i - 1] = static_cast<char>('0' + raw % 10);
+        pos += kDigits;
+        for (const char ch : kPayload)
+            text[pos++] = ch;
+        return text;
+    }();
+
+    static constexpr std::string_view command{kText.data(), kHead.size() + kDigits};
+    static constexpr std::string_view event{kText.data(), kText.size()};
+};
+
 // Unified v1 envelope: {"command":N[,"cmdId":N],"payload":{...}}
 // All domain fields (including externalId) live inside "payload"; cmdId is a
 // JSON number and appears only for correlated Result* frames. The frame
 // header's correlationId remains the transport-level copy.
-void openEnvelope(std::string &out, IpcCommand command, bool &payloadFirst)
+template <IpcCommand Command>
+void openEnvelope(std::string &out, bool &payloadFirst)
 {
-    out += "{\"command\":";
-    out += std::to_string(phicore::adapter::v1::toUint16(command));
-    out += ",\"payload\":{";
+    out.reserve(g_frameSizes.estimate(Command));
+    out += EnvelopePrefix<Command>::event;
     payloadFirst = true;
 }
 
-void openEnvelopeWithCmdId(std::string &out, IpcCommand command, CmdId cmdId, bool &payloadFirst)
+template <IpcCommand Command>
+void openEnvelopeWithCmdId(std::string &out, CmdId cmdId, bool &payloadFirst)
 {
-    out += "{\"command\":";
-    out += std::to_string(phicore::adapter::v1::toUint16(command));
+    out.reserve(g_frameSizes.estimate(Command));
+    out += EnvelopePrefix<Command>::command;
     out += ",\"cmdId\":";
-    out += std::to_string(cmdId);
-    out += ",\"payload\":{";
+    appendInteger(out, cmdId);
+    out += EnvelopePrefix<Command>::kPayload;
     payloadFirst = true;
 }
 
+template <IpcCommand Command>
 void closeEnvelope(std::string &out)
 {
     out += "}}";
+    g_frameSizes.record(Command, out.size());
 }
 
 void appendDoubleJson(std::string &out, double value)
@@ -1377,14 +1961,14 @@ void appendScalarJson(std::string &out, const ScalarValue &value)
         return;
     }
     if (const auto *i = std::get_if<std::int64_t>(&value)) {
-        out += std::to_string(*i);
+        appendInteger(out, *i);
         return;
     }
     if (const auto *d = std::get_if<double>(&value)) {
         appendDoubleJson(out, *d);
         return;
     }
-    out += jsonQuoted(std::get<std::string>(value));
+    json::appendQuoted(out, std::get<std::string>(value));
 }
 
 void appendScalarListJson(std::string &out, const ScalarList &values)
@@ -1400,9 +1984,10 @@ void appendScalarListJson(std::string &out, const ScalarList &values)
     out.push_back(']');
 }
 
-void appendMetaJson(std::string &out, const std::string &json)
+void appendMetaJson(std::string &out, std::string_view json)
 {
-    if (trim(json).empty()) {
+    const std::string_view token = trim(json);
+    if (token.empty() || outboundJsonRejected(token)) {
         out += "{}";
         return;
     }
@@ -1417,218 +2002,645 @@ void appendArrayOfStrings(std::string &out, const std::vector<std::string> &valu
         if (!first)
             out.push_back(',');
         first = false;
-        out += jsonQuoted(value);
+        json::appendQuoted(out, value);
     }
     out.push_back(']');
 }
 
-std::string deviceToJson(const Device &device)
+// Appends a caller-supplied JSON value verbatim, or `fallback` when it is blank
+// (or, with outbound validation on, not one JSON value).
+void appendJsonToken(std::string &out, std::string_view json, std::string_view fallback)
 {
-    std::string out;
-    out.push_back('{');
-    bool first = true;
-    appendFieldPrefix(out, first, "externalId");
-    out += jsonQuoted(device.externalId);
-    appendFieldPrefix(out, first, "name");
-    out += jsonQuoted(device.name);
-    appendFieldPrefix(out, first, "deviceClass");
-    out += std::to_string(static_cast<int>(device.deviceClass));
-    appendFieldPrefix(out, first, "flags");
-    out += std::to_string(static_cast<int>(device.flags));
-    appendFieldPrefix(out, first, "manufacturer");
-    out += jsonQuoted(device.manufacturer);
-    appendFieldPrefix(out, first, "firmware");
-    out += jsonQuoted(device.firmware);
-    appendFieldPrefix(out, first, "model");
-    out += jsonQuoted(device.model);
-    appendFieldPrefix(out, first, "meta");
-    appendMetaJson(out, device.metaJson);
-    appendFieldPrefix(out, first, "effects");
-    out.push_back('[');
-    bool firstEffect = true;
-    for (const auto &effect : device.effects) {
-        if (!firstEffect)
-            out.push_back(',');
-        firstEffect = false;
-        out.push_back('{');
-        bool firstField = true;
-        appendFieldPrefix(out, firstField, "effect");
-        out += std::to_string(static_cast<int>(effect.effect));
-        appendFieldPrefix(out, firstField, "id");
-        out += jsonQuoted(effect.id);
-        appendFieldPrefix(out, firstField, "label");
-        out += jsonQuoted(effect.label);
-        appendFieldPrefix(out, firstField, "description");
-        out += jsonQuoted(effect.description);
-        appendFieldPrefix(out, firstField, "requiresParams");
-        out += (effect.requiresParams ? "true" : "false");
-        appendFieldPrefix(out, firstField, "meta");
-        appendMetaJson(out, effect.metaJson);
-        out.push_back('}');
-    }
-    out.push_back(']');
-    out.push_back('}');
-    return out;
+    const std::string_view token = trim(json);
+    out += token.empty() || outboundJsonRejected(token) ? fallback : token;
 }
 
-std::string channelToJson(const Channel &channel)
+// TrustedJson is only checked in SDK debug builds or with validation opted
+// in, so a broken promise surfaces in tests rather than on the wire.
+void appendTrustedJson(std::string &out, const TrustedJson &json, std::string_view fallback)
 {
-    std::string out;
-    out.push_back('{');
-    bool first = true;
-    appendFieldPrefix(out, first, "externalId");
-    out += jsonQuoted(channel.externalId);
-    appendFieldPrefix(out, first, "name");
-    out += jsonQuoted(channel.name);
-    appendFieldPrefix(out, first, "kind");
-    out += std::to_string(static_cast<int>(channel.kind));
-    appendFieldPrefix(out, first, "dataType");
-    out += std::to_string(static_cast<int>(channel.dataType));
-    appendFieldPrefix(out, first, "flags");
-    out += std::to_string(static_cast<int>(channel.flags));
-    appendFieldPrefix(out, first, "unit");
-    out += jsonQuoted(channel.unit);
-    appendFieldPrefix(out, first, "minValue");
-    appendDoubleJson(out, channel.minValue);
-    appendFieldPrefix(out, first, "maxValue");
-    appendDoubleJson(out, channel.maxValue);
-    appendFieldPrefix(out, first, "stepValue");
-    appendDoubleJson(out, channel.stepValue);
-    appendFieldPrefix(out, first, "meta");
-    appendMetaJson(out, channel.metaJson);
-    appendFieldPrefix(out, first, "choices");
-    out.push_back('[');
-    bool firstChoice = true;
-    for (const auto &choice : channel.choices) {
-        if (!firstChoice)
-            out.push_back(',');
-        firstChoice = false;
-        out += "{\"value\":";
-        out += jsonQuoted(choice.value);
-        out += ",\"label\":";
-        out += jsonQuoted(choice.label);
-        out.push_back('}');
+    const std::string_view token = trim(json.view());
+#ifdef NDEBUG
+    const bool verify = g_outboundJsonValidation.load(std::memory_order_relaxed);
+#else
+    const bool verify = true;
+#endif
+    out += token.empty() || (verify && !verifiedJson(token)) ? fallback : token;
+}
+
+// ---------------------------------------------------------------------------
+// Wire field tables
+// ---------------------------------------------------------------------------
+//
+// One table per wire struct names its members and binds each to a decoder and
+// an encoder (wire_schema.h). Request payloads are decoded through the tables
+// in a single pass over the object; records and results are encoded through
+// them, so a member cannot be renamed or retyped in one direction only. The
+// tables are also exported to the golden-wire tests (wire::payloadSchema()).
+
+template <typename T, std::size_t N>
+bool decodeObject(const wire::Table<T, N> &table, std::string_view objectJson, T &target, std::string *error = nullptr)
+{
+    return forEachObjectMember(
+        objectJson,
+        [&table, &target](std::string_view key, std::string_view value, bool) {
+            const wire::Field<T> *field = table.find(key);
+            if (field && field->decode)
+                field->decode(target, value);
+        },
+        error);
+}
+
+template <typename T, std::size_t N>
+void encodeFields(std::string &out, bool &first, const wire::Table<T, N> &table, const T &source)
+{
+    for (const wire::Field<T> &field : table.fields()) {
+        if (field.present && !field.present(source))
+            continue;
+        appendFieldPrefix(out, first, field.key);
+        field.encode(out, source);
     }
-    out.push_back(']');
-    appendFieldPrefix(out, first, "lastValue");
-    appendScalarJson(out, channel.lastValue);
-    appendFieldPrefix(out, first, "lastUpdateMs");
-    out += std::to_string(channel.lastUpdateMs);
-    appendFieldPrefix(out, first, "hasValue");
-    out += (channel.hasValue ? "true" : "false");
-    out.push_back('}');
-    return out;
 }
 
-std::string roomToJson(const Room &room)
+template <typename T, std::size_t N>
+void encodeObject(std::string &out, const wire::Table<T, N> &table, const T &source)
 {
-    std::string out;
     out.push_back('{');
     bool first = true;
-    appendFieldPrefix(out, first, "externalId");
-    out += jsonQuoted(room.externalId);
-    appendFieldPrefix(out, first, "name");
-    out += jsonQuoted(room.name);
-    appendFieldPrefix(out, first, "zone");
-    out += jsonQuoted(room.zone);
-    appendFieldPrefix(out, first, "deviceExternalIds");
-    appendArrayOfStrings(out, room.deviceExternalIds);
-    appendFieldPrefix(out, first, "meta");
-    appendMetaJson(out, room.metaJson);
+    encodeFields(out, first, table, source);
     out.push_back('}');
-    return out;
 }
 
-std::string groupToJson(const Group &group)
+template <typename>
+struct MemberPointerTraits;
+
+template <typename C, typename M>
+struct MemberPointerTraits<M C::*> {
+    using Class = C;
+    using Type = M;
+};
+
+template <auto Member>
+using MemberClass = typename MemberPointerTraits<decltype(Member)>::Class;
+
+template <auto Member>
+using MemberType = typename MemberPointerTraits<decltype(Member)>::Type;
+
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> stringField(std::string_view key)
+{
+    using T = MemberClass<Member>;
+    return {key, wire::FieldKind::String,
+            [](T &target, std::string_view token) { decodeStringInto(token, &(target.*Member)); },
+            [](std::string &out, const T &source) { json::appendQuoted(out, source.*Member); }};
+}
+
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> integerField(std::string_view key)
 {
-    std::string out;
-    out.push_back('{');
-    bool first = true;
-    appendFieldPrefix(out, first, "externalId");
-    out += jsonQuoted(group.externalId);
-    appendFieldPrefix(out, first, "name");
-    out += jsonQuoted(group.name);
-    appendFieldPrefix(out, first, "zone");
-    out += jsonQuoted(group.zone);
-    appendFieldPrefix(out, first, "deviceExternalIds");
-    appendArrayOfStrings(out, group.deviceExternalIds);
-    appendFieldPrefix(out, first, "meta");
-    appendMetaJson(out, group.metaJson);
-    out.push_back('}');
-    return out;
+    using T = MemberClass<Member>;
+    using V = MemberType<Member>;
+    return {key, wire::FieldKind::Integer,
+            [](T &target, std::string_view token) { target.*Member = static_cast<V>(parseIntOrDefault(token, 0)); },
+            [](std::string &out, const T &source) {
+                if constexpr (std::is_enum_v<V>)
+                    appendInteger(out, static_cast<int>(source.*Member));
+                else
+                    appendInteger(out, source.*Member);
+            }};
 }
 
-std::string sceneToJson(const Scene &scene)
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> booleanField(std::string_view key)
 {
-    std::string out;
-    out.push_back('{');
-    bool first = true;
-    appendFieldPrefix(out, first, "externalId");
-    out += jsonQuoted(scene.externalId);
-    appendFieldPrefix(out, first, "name");
-    out += jsonQuoted(scene.name);
-    appendFieldPrefix(out, first, "description");
-    out += jsonQuoted(scene.description);
-    appendFieldPrefix(out, first, "scopeExternalId");
-    out += jsonQuoted(scene.scopeExternalId);
-    appendFieldPrefix(out, first, "scopeType");
-    out += jsonQuoted(scene.scopeType);
-    appendFieldPrefix(out, first, "avatarColor");
-    out += jsonQuoted(scene.avatarColor);
-    appendFieldPrefix(out, first, "image");
-    out += jsonQuoted(scene.image);
-    appendFieldPrefix(out, first, "presetTag");
-    out += jsonQuoted(scene.presetTag);
-    appendFieldPrefix(out, first, "state");
-    out += std::to_string(static_cast<int>(scene.state));
-    appendFieldPrefix(out, first, "flags");
-    out += std::to_string(static_cast<int>(scene.flags));
-    appendFieldPrefix(out, first, "meta");
-    appendMetaJson(out, scene.metaJson);
-    out.push_back('}');
-    return out;
+    using T = MemberClass<Member>;
+    return {key, wire::FieldKind::Boolean,
+            [](T &target, std::string_view token) { target.*Member = trim(token) == "true"; },
+            [](std::string &out, const T &source) { out += (source.*Member ? "true" : "false"); }};
 }
 
-std::string jsonTokenOrDefault(const std::string &json, std::string_view fallback)
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> numberField(std::string_view key)
+{
+    using T = MemberClass<Member>;
+    return {key, wire::FieldKind::Number,
+            [](T &target, std::string_view token) {
+                double value = 0.0;
+                parseDouble(token, &value);
+                target.*Member = value;
+            },
+            [](std::string &out, const T &source) { appendDoubleJson(out, source.*Member); }};
+}
+
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> scalarField(std::string_view key)
+{
+    using T = MemberClass<Member>;
+    return {key, wire::FieldKind::Scalar,
+            [](T &target, std::string_view token) {
+                ScalarValue value;
+                if (!parseScalarValueToken(token, &value))
+                    value = std::monostate{};
+                target.*Member = std::move(value);
+            },
+            [](std::string &out, const T &source) { appendScalarJson(out, source.*Member); }};
+}
+
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> scalarListField(std::string_view key)
+{
+    using T = MemberClass<Member>;
+    return {key, wire::FieldKind::ScalarList,
+            [](T &target, std::string_view token) {
+                ScalarList values;
+                std::vector<std::string_view> elements;
+                if (parseArrayElements(token, &elements, nullptr)) {
+                    values.reserve(elements.size());
+                    for (const std::string_view element : elements) {
+                        ScalarValue value;
+                        if (!parseScalarValueToken(element, &value))
+                            value = std::monostate{};
+                        values.push_back(std::move(value));
+                    }
+                }
+                target.*Member = std::move(values);
+            },
+            [](std::string &out, const T &source) { appendScalarListJson(out, source.*Member); }};
+}
+
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> stringListField(std::string_view key)
+{
+    using T = MemberClass<Member>;
+    return {key, wire::FieldKind::StringList,
+            [](T &target, std::string_view token) {
+                std::vector<std::string> values;
+                std::vector<std::string_view> elements;
+                if (parseArrayElements(token, &elements, nullptr)) {
+                    values.reserve(elements.size());
+                    for (const std::string_view element : elements)
+                        values.push_back(decodeStringOrDefault(element));
+                }
+                target.*Member = std::move(values);
+            },
+            [](std::string &out, const T &source) { appendArrayOfStrings(out, source.*Member); }};
+}
+
+// Request frame retained by the dispatch in progress on this thread; JsonRef
+// members decoded from it view the frame instead of copying out of it.
+thread_local const std::shared_ptr<const std::string> *t_requestFrame = nullptr;
+
+class ScopedRequestFrame
+{
+public:
+    explicit ScopedRequestFrame(const std::shared_ptr<const std::string> &frame)
+        : m_previous(t_requestFrame)
+    {
+        t_requestFrame = &frame;
+    }
+    ~ScopedRequestFrame() { t_requestFrame = m_previous; }
+
+    ScopedRequestFrame(const ScopedRequestFrame &) = delete;
+    ScopedRequestFrame &operator=(const ScopedRequestFrame &) = delete;
+
+private:
+    const std::shared_ptr<const std::string> *m_previous;
+};
+
+JsonRef jsonRefFromToken(std::string_view token)
 {
-    const std::string_view token = trim(json);
     if (token.empty())
-        return std::string(fallback);
-    return std::string(token);
+        return {};
+    if (t_requestFrame && *t_requestFrame) {
+        const std::string &frame = **t_requestFrame;
+        if (token.data() >= frame.data() && token.data() + token.size() <= frame.data() + frame.size())
+            return JsonRef(*t_requestFrame, token);
+    }
+    return JsonRef(std::string(token));
+}
+
+// Raw JSON text: decoded as the verbatim value token, encoded with `{}` for an
+// empty member.
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> jsonField(std::string_view key)
+{
+    using T = MemberClass<Member>;
+    using V = MemberType<Member>;
+    return {key, wire::FieldKind::Json,
+            [](T &target, std::string_view token) {
+                if constexpr (std::is_same_v<V, JsonRef>)
+                    target.*Member = jsonRefFromToken(token);
+                else
+                    (target.*Member).assign(token);
+            },
+            [](std::string &out, const T &source) {
+                if constexpr (std::is_same_v<V, JsonRef>)
+                    appendMetaJson(out, (source.*Member).view());
+                else
+                    appendMetaJson(out, source.*Member);
+            }};
+}
+
+template <auto Member, const auto &ElementTable>
+constexpr wire::Field<MemberClass<Member>> objectListField(std::string_view key)
+{
+    using T = MemberClass<Member>;
+    using List = MemberType<Member>;
+    return {key, wire::FieldKind::ObjectList,
+            [](T &target, std::string_view token) {
+                List values;
+                std::vector<std::string_view> elements;
+                if (parseArrayElements(token, &elements, nullptr)) {
+                    values.reserve(elements.size());
+                    for (const std::string_view element : elements) {
+                        typename List::value_type value;
+                        if (decodeObject(ElementTable, element, value))
+                            values.push_back(std::move(value));
+                    }
+                }
+                target.*Member = std::move(values);
+            },
+            [](std::string &out, const T &source) {
+                out.push_back('[');
+                bool first = true;
+                for (const auto &value : source.*Member) {
+                    if (!first)
+                        out.push_back(',');
+                    first = false;
+                    encodeObject(out, ElementTable, value);
+                }
+                out.push_back(']');
+            }};
 }
 
-std::string actionToJson(const AdapterActionDescriptor &action)
+// Views into the frame for the envelope members; only live for one dispatch.
+struct RequestEnvelope {
+    std::string_view command;
+    std::string_view cmdId;
+    std::string_view payload;
+};
+
+template <auto Member>
+constexpr wire::Field<MemberClass<Member>> tokenField(std::string_view key, wire::FieldKind kind)
+{
+    using T = MemberClass<Member>;
+    return {key, kind,
+            [](T &target, std::string_view token) { target.*Member = token; },
+            [](std::string &out, const T &source) { out += source.*Member; }};
+}
+
+constexpr wire::Table kRequestEnvelopeFields{std::array{
+    tokenField<&RequestEnvelope::command>("command", wire::FieldKind::Integer),
+    tokenField<&RequestEnvelope::cmdId>("cmdId", wire::FieldKind::Integer),
+    tokenField<&RequestEnvelope::payload>("payload", wire::FieldKind::Object),
+}};
+
+// The one payload member the poll thread needs to pick an instance.
+struct RequestRoute {
+    std::string externalId;
+};
+
+constexpr wire::Table kRequestRouteFields{std::array{
+    stringField<&RequestRoute::externalId>("externalId"),
+}};
+
+// Requests a single instance handles on its own execution backend.
+bool isInstanceRoutable(IpcCommand command)
+{
+    switch (command) {
+    case IpcCommand::CmdChannelInvoke:
+    case IpcCommand::CmdAdapterActionInvoke:
+    case IpcCommand::CmdDeviceNameUpdate:
+    case IpcCommand::CmdDeviceEffectInvoke:
+    case IpcCommand::CmdSceneInvoke:
+    case IpcCommand::CmdAdaptersStreamStart:
+    case IpcCommand::CmdAdaptersStreamStop:
+        return true;
+    default:
+        return false;
+    }
+}
+
+constexpr wire::Table kAdapterFields{std::array{
+    stringField<&Adapter::name>("name"),
+    stringField<&Adapter::host>("host"),
+    stringField<&Adapter::ip>("ip"),
+    integerField<&Adapter::port>("port"),
+    stringField<&Adapter::user>("user"),
+    stringField<&Adapter::password>("password"),
+    stringField<&Adapter::token>("token"),
+    stringField<&Adapter::pluginType>("pluginType"),
+    stringField<&Adapter::externalId>("externalId"),
+    jsonField<&Adapter::metaJson>("meta"),
+    integerField<&Adapter::flags>("flags"),
+}};
+
+// Bootstrap and config frames name the target both inside "adapter" and at
+// payload level; the adapter object wins and the payload-level copy fills gaps.
+template <typename Request>
+struct AdapterScopedPayload {
+    Request request;
+    phicore::adapter::v1::Utf8String pluginType;
+    phicore::adapter::v1::ExternalId externalId;
+};
+
+template <typename Request>
+consteval auto adapterScopedFields()
+{
+    using P = AdapterScopedPayload<Request>;
+    const std::array common{
+        wire::Field<P>{"adapterId", wire::FieldKind::Integer,
+                       [](P &target, std::string_view token) {
+                           target.request.adapterId = static_cast<int>(parseIntOrDefault(token, 0));
+                       },
+                       [](std::string &out, const P &source) { appendInteger(out, source.request.adapterId); }},
+        wire::Field<P>{"staticConfig", wire::FieldKind::Json,
+                       [](P &target, std::string_view token) { target.request.staticConfigJson = jsonRefFromToken(token); },
+                       [](std::string &out, const P &source) { appendMetaJson(out, source.request.staticConfigJson.view()); }},
+        wire::Field<P>{"adapter", wire::FieldKind::Object,
+                       [](P &target, std::string_view token) {
+                           Adapter adapter;
+                           if (!decodeObject(kAdapterFields, token, adapter))
+                               adapter = Adapter{};
+                           target.request.adapter = std::move(adapter);
+                       },
+                       [](std::string &out, const P &source) { encodeObject(out, kAdapterFields, source.request.adapter); }},
+        stringField<&P::pluginType>("pluginType"),
+        stringField<&P::externalId>("externalId"),
+    };
+    if constexpr (std::is_same_v<Request, BootstrapRequest>) {
+        // Session capabilities are announced once, at bootstrap.
+        return wire::Table{std::array{
+            common[0], common[1], common[2], common[3], common[4],
+            wire::Field<P>{"logTemplates", wire::FieldKind::Boolean,
+                           [](P &target, std::string_view token) { target.request.logTemplates = trim(token) == "true"; },
+                           [](std::string &out, const P &source) { out += (source.request.logTemplates ? "true" : "false"); }},
+        }};
+    } else {
+        return wire::Table{common};
+    }
+}
+
+template <typename Request>
+constexpr auto kAdapterScopedFields = adapterScopedFields<Request>();
+
+constexpr wire::Table kInstanceRemovedFields{std::array{
+    integerField<&InstanceRemovedRequest::adapterId>("adapterId"),
+    stringField<&InstanceRemovedRequest::pluginType>("pluginType"),
+    stringField<&InstanceRemovedRequest::externalId>("externalId"),
+}};
+
+constexpr wire::Table kChannelInvokeFields{std::array{
+    stringField<&ChannelInvokeRequest::externalId>("externalId"),
+    stringField<&ChannelInvokeRequest::deviceExternalId>("deviceExternalId"),
+    stringField<&ChannelInvokeRequest::channelExternalId>("channelExternalId"),
+    // The raw token is kept next to the scalar for non-scalar payloads.
+    wire::Field<ChannelInvokeRequest>{"value", wire::FieldKind::Scalar,
+        [](ChannelInvokeRequest &target, std::string_view token) {
+            target.valueJson.assign(token);
+            target.value = std::monostate{};
+            target.hasScalarValue = parseScalarValueToken(token, &target.value);
+        },
+        [](std::string &out, const ChannelInvokeRequest &source) {
+            if (!trim(source.valueJson).empty())
+                out += trim(source.valueJson);
+            else
+                appendScalarJson(out, source.value);
+        }},
+}};
+
+constexpr wire::Table kAdapterActionInvokeFields{std::array{
+    stringField<&AdapterActionInvokeRequest::externalId>("externalId"),
+    stringField<&AdapterActionInvokeRequest::actionId>("actionId"),
+    jsonField<&AdapterActionInvokeRequest::paramsJson>("params"),
+}};
+
+constexpr wire::Table kDeviceNameUpdateFields{std::array{
+    stringField<&DeviceNameUpdateRequest::externalId>("externalId"),
+    stringField<&DeviceNameUpdateRequest::deviceExternalId>("deviceExternalId"),
+    stringField<&DeviceNameUpdateRequest::name>("name"),
+}};
+
+constexpr wire::Table kDeviceEffectInvokeFields{std::array{
+    stringField<&DeviceEffectInvokeRequest::externalId>("externalId"),
+    stringField<&DeviceEffectInvokeRequest::deviceExternalId>("deviceExternalId"),
+    integerField<&DeviceEffectInvokeRequest::effect>("effect"),
+    stringField<&DeviceEffectInvokeRequest::effectId>("effectId"),
+    jsonField<&DeviceEffectInvokeRequest::paramsJson>("params"),
+}};
+
+constexpr wire::Table kSceneInvokeFields{std::array{
+    stringField<&SceneInvokeRequest::externalId>("externalId"),
+    stringField<&SceneInvokeRequest::sceneExternalId>("sceneExternalId"),
+    stringField<&SceneInvokeRequest::groupExternalId>("groupExternalId"),
+    stringField<&SceneInvokeRequest::action>("action"),
+}};
+
+constexpr wire::Table kAdaptersStreamStartFields{std::array{
+    stringField<&AdaptersStreamStartRequest::externalId>("externalId"),
+    stringField<&AdaptersStreamStartRequest::streamId>("streamId"),
+    stringField<&AdaptersStreamStartRequest::kind>("kind"),
+    jsonField<&AdaptersStreamStartRequest::paramsJson>("params"),
+}};
+
+constexpr wire::Table kAdaptersStreamStopFields{std::array{
+    stringField<&AdaptersStreamStopRequest::externalId>("externalId"),
+    stringField<&AdaptersStreamStopRequest::streamId>("streamId"),
+}};
+
+constexpr wire::Table kUnknownRequestFields{std::array{
+    stringField<&UnknownRequest::externalId>("externalId"),
+}};
+
+constexpr wire::Table kCmdResponseFields{std::array{
+    integerField<&CmdResponse::status>("status"),
+    stringField<&CmdResponse::error>("error"),
+    stringField<&CmdResponse::errorContext>("errorCtx"),
+    scalarListField<&CmdResponse::errorParams>("errorParams"),
+    scalarField<&CmdResponse::finalValue>("finalValue"),
+    wire::Field<CmdResponse>{"tsMs", wire::FieldKind::Integer,
+        [](CmdResponse &target, std::string_view token) { target.tsMs = parseIntOrDefault(token, 0); },
+        [](std::string &out, const CmdResponse &source) {
+            appendInteger(out, source.tsMs > 0 ? source.tsMs : nowMs());
+        }},
+}};
+
+constexpr wire::Table kActionResponseFields{std::array{
+    integerField<&ActionResponse::status>("status"),
+    stringField<&ActionResponse::error>("error"),
+    stringField<&ActionResponse::errorContext>("errorCtx"),
+    scalarListField<&ActionResponse::errorParams>("errorParams"),
+    integerField<&ActionResponse::resultType>("resultType"),
+    // A raw JSON result wins over the scalar one.
+    wire::Field<ActionResponse>{"resultValue", wire::FieldKind::Json, nullptr,
+        [](std::string &out, const ActionResponse &source) {
+            if (!trim(source.resultValueJson).empty())
+                appendJsonToken(out, source.resultValueJson, "null");
+            else
+                appendScalarJson(out, source.resultValue);
+        }},
+    wire::Field<ActionResponse>{"formValues", wire::FieldKind::Json, nullptr,
+        [](std::string &out, const ActionResponse &source) { appendMetaJson(out, trim(source.formValuesJson)); },
+        [](const ActionResponse &source) { return !trim(source.formValuesJson).empty(); }},
+    wire::Field<ActionResponse>{"fieldChoices", wire::FieldKind::Json, nullptr,
+        [](std::string &out, const ActionResponse &source) { appendMetaJson(out, trim(source.fieldChoicesJson)); },
+        [](const ActionResponse &source) { return !trim(source.fieldChoicesJson).empty(); }},
+    wire::Field<ActionResponse>{"reloadLayout", wire::FieldKind::Boolean, nullptr,
+        [](std::string &out, const ActionResponse &) { out += "true"; },
+        [](const ActionResponse &source) { return source.reloadLayout; }},
+    wire::Field<ActionResponse>{"tsMs", wire::FieldKind::Integer, nullptr,
+        [](std::string &out, const ActionResponse &source) {
+            appendInteger(out, source.tsMs > 0 ? source.tsMs : nowMs());
+        }},
+}};
+
+constexpr wire::Table kDeviceEffectFields{std::array{
+    integerField<&DeviceEffectDescriptor::effect>("effect"),
+    stringField<&DeviceEffectDescriptor::id>("id"),
+    stringField<&DeviceEffectDescriptor::label>("label"),
+    stringField<&DeviceEffectDescriptor::description>("description"),
+    booleanField<&DeviceEffectDescriptor::requiresParams>("requiresParams"),
+    jsonField<&DeviceEffectDescriptor::metaJson>("meta"),
+}};
+
+constexpr wire::Table kDeviceFields{std::array{
+    stringField<&Device::externalId>("externalId"),
+    stringField<&Device::name>("name"),
+    integerField<&Device::deviceClass>("deviceClass"),
+    integerField<&Device::flags>("flags"),
+    stringField<&Device::manufacturer>("manufacturer"),
+    stringField<&Device::firmware>("firmware"),
+    stringField<&Device::model>("model"),
+    jsonField<&Device::metaJson>("meta"),
+    objectListField<&Device::effects, kDeviceEffectFields>("effects"),
+}};
+
+constexpr wire::Table kConfigOptionFields{std::array{
+    stringField<&AdapterConfigOption::value>("value"),
+    stringField<&AdapterConfigOption::label>("label"),
+}};
+
+constexpr wire::Table kChannelFields{std::array{
+    stringField<&Channel::externalId>("externalId"),
+    stringField<&Channel::name>("name"),
+    integerField<&Channel::kind>("kind"),
+    integerField<&Channel::dataType>("dataType"),
+    integerField<&Channel::flags>("flags"),
+    stringField<&Channel::unit>("unit"),
+    numberField<&Channel::minValue>("minValue"),
+    numberField<&Channel::maxValue>("maxValue"),
+    numberField<&Channel::stepValue>("stepValue"),
+    jsonField<&Channel::metaJson>("meta"),
+    objectListField<&Channel::choices, kConfigOptionFields>("choices"),
+    scalarField<&Channel::lastValue>("lastValue"),
+    integerField<&Channel::lastUpdateMs>("lastUpdateMs"),
+    booleanField<&Channel::hasValue>("hasValue"),
+}};
+
+constexpr wire::Table kRoomFields{std::array{
+    stringField<&Room::externalId>("externalId"),
+    stringField<&Room::name>("name"),
+    stringField<&Room::zone>("zone"),
+    stringListField<&Room::deviceExternalIds>("deviceExternalIds"),
+    jsonField<&Room::metaJson>("meta"),
+}};
+
+constexpr wire::Table kGroupFields{std::array{
+    stringField<&Group::externalId>("externalId"),
+    stringField<&Group::name>("name"),
+    stringField<&Group::zone>("zone"),
+    stringListField<&Group::deviceExternalIds>("deviceExternalIds"),
+    jsonField<&Group::metaJson>("meta"),
+}};
+
+constexpr wire::Table kSceneFields{std::array{
+    stringField<&Scene::externalId>("externalId"),
+    stringField<&Scene::name>("name"),
+    stringField<&Scene::description>("description"),
+    stringField<&Scene::scopeExternalId>("scopeExternalId"),
+    stringField<&Scene::scopeType>("scopeType"),
+    stringField<&Scene::avatarColor>("avatarColor"),
+    stringField<&Scene::image>("image"),
+    stringField<&Scene::presetTag>("presetTag"),
+    integerField<&Scene::state>("state"),
+    integerField<&Scene::flags>("flags"),
+    jsonField<&Scene::metaJson>("meta"),
+}};
+
+// Every decoder maps an empty token to the member's default, so feeding one
+// per field resets a struct without giving up the capacity of its strings.
+template <typename T, std::size_t N>
+void resetFields(const wire::Table<T, N> &table, T &target)
+{
+    for (const wire::Field<T> &field : table.fields()) {
+        if (field.decode)
+            field.decode(target, {});
+    }
+}
+
+// Decodes into `request` in place, so a request object that is reused across
+// frames decodes repeated IDs without allocating. Members outside the table
+// (cmdId, correlationId) are left alone. A payload that is not a JSON object
+// decodes as an empty request.
+template <typename Request, std::size_t N>
+void decodePayloadInto(const wire::Table<Request, N> &table, std::string_view payloadJson, Request &request)
+{
+    resetFields(table, request);
+    if (!decodeObject(table, payloadJson, request))
+        resetFields(table, request);
+}
+
+template <typename Request, std::size_t N>
+Request decodePayload(const wire::Table<Request, N> &table, std::string_view payloadJson)
+{
+    Request request;
+    decodePayloadInto(table, payloadJson, request);
+    return request;
+}
+
+template <typename Request>
+Request decodeAdapterScopedPayload(std::string_view payloadJson)
+{
+    AdapterScopedPayload<Request> payload;
+    if (!decodeObject(kAdapterScopedFields<Request>, payloadJson, payload))
+        payload = AdapterScopedPayload<Request>{};
+    Request &request = payload.request;
+    if (request.adapter.pluginType.empty())
+        request.adapter.pluginType = std::move(payload.pluginType);
+    if (request.adapter.externalId.empty())
+        request.adapter.externalId = std::move(payload.externalId);
+    return std::move(payload.request);
+}
+
+void appendActionJson(std::string &out, const AdapterActionDescriptor &action)
 {
-    std::string out;
     out.push_back('{');
     bool first = true;
     appendFieldPrefix(out, first, "id");
-    out += jsonQuoted(action.id);
+    json::appendQuoted(out, action.id);
     appendFieldPrefix(out, first, "label");
-    out += jsonQuoted(action.label);
+    json::appendQuoted(out, action.label);
     appendFieldPrefix(out, first, "description");
-    out += jsonQuoted(action.description);
+    json::appendQuoted(out, action.description);
     appendFieldPrefix(out, first, "hasForm");
     out += (action.hasForm ? "true" : "false");
     appendFieldPrefix(out, first, "danger");
     out += (action.danger ? "true" : "false");
     appendFieldPrefix(out, first, "cooldownMs");
-    out += std::to_string(action.cooldownMs);
+    appendInteger(out, action.cooldownMs);
     if (!trim(action.confirmJson).empty()) {
         appendFieldPrefix(out, first, "confirm");
-        out += jsonTokenOrDefault(action.confirmJson, "{}");
+        appendJsonToken(out, action.confirmJson, "{}");
     }
     if (!trim(action.metaJson).empty()) {
         appendFieldPrefix(out, first, "meta");
-        out += jsonTokenOrDefault(action.metaJson, "{}");
+        appendJsonToken(out, action.metaJson, "{}");
     }
     out.push_back('}');
-    return out;
 }
 
-std::string actionListToJson(const std::vector<AdapterActionDescriptor> &actions)
+void appendActionListJson(std::string &out, const std::vector<AdapterActionDescriptor> &actions)
 {
-    std::string out;
     out.push_back('[');
     bool first = true;
     for (const AdapterActionDescriptor &action : actions) {
@@ -1637,109 +2649,2137 @@ std::string actionListToJson(const std::vector<AdapterActionDescriptor> &actions
         if (!first)
             out.push_back(',');
         first = false;
-        out += actionToJson(action);
+        appendActionJson(out, action);
     }
     out.push_back(']');
-    return out;
 }
 
-std::string capabilitiesToJson(const AdapterCapabilities &caps)
+void appendCapabilitiesJson(std::string &out, const AdapterCapabilities &caps)
 {
-    std::string out;
     out.push_back('{');
     bool first = true;
     appendFieldPrefix(out, first, "required");
-    out += std::to_string(static_cast<int>(caps.required));
+    appendInteger(out, static_cast<int>(caps.required));
     appendFieldPrefix(out, first, "optional");
-    out += std::to_string(static_cast<int>(caps.optional));
+    appendInteger(out, static_cast<int>(caps.optional));
     appendFieldPrefix(out, first, "flags");
-    out += std::to_string(static_cast<int>(caps.flags));
+    appendInteger(out, static_cast<int>(caps.flags));
     appendFieldPrefix(out, first, "factoryActions");
-    out += actionListToJson(caps.factoryActions);
+    appendActionListJson(out, caps.factoryActions);
     appendFieldPrefix(out, first, "instanceActions");
-    out += actionListToJson(caps.instanceActions);
+    appendActionListJson(out, caps.instanceActions);
     if (!trim(caps.defaultsJson).empty()) {
         appendFieldPrefix(out, first, "defaults");
-        out += jsonTokenOrDefault(caps.defaultsJson, "{}");
+        appendJsonToken(out, caps.defaultsJson, "{}");
     }
     out.push_back('}');
-    return out;
 }
 
-std::string descriptorToJson(const AdapterDescriptor &descriptor)
+void appendDescriptorJson(std::string &out, const AdapterDescriptor &descriptor)
 {
-    std::string out;
     out.push_back('{');
     bool first = true;
     appendFieldPrefix(out, first, "pluginType");
-    out += jsonQuoted(descriptor.pluginType);
+    json::appendQuoted(out, descriptor.pluginType);
     appendFieldPrefix(out, first, "displayName");
-    out += jsonQuoted(descriptor.displayName);
+    json::appendQuoted(out, descriptor.displayName);
     appendFieldPrefix(out, first, "description");
-    out += jsonQuoted(descriptor.description);
+    json::appendQuoted(out, descriptor.description);
     appendFieldPrefix(out, first, "apiVersion");
-    out += jsonQuoted(descriptor.apiVersion);
+    json::appendQuoted(out, descriptor.apiVersion);
     appendFieldPrefix(out, first, "iconSvg");
-    out += jsonQuoted(descriptor.iconSvg);
+    json::appendQuoted(out, descriptor.iconSvg);
     appendFieldPrefix(out, first, "imageBase64");
-    out += jsonQuoted(descriptor.imageBase64);
+    json::appendQuoted(out, descriptor.imageBase64);
     appendFieldPrefix(out, first, "timeoutMs");
-    out += std::to_string(descriptor.timeoutMs);
+    appendInteger(out, descriptor.timeoutMs);
     appendFieldPrefix(out, first, "maxInstances");
-    out += std::to_string(descriptor.maxInstances);
+    appendInteger(out, descriptor.maxInstances);
     appendFieldPrefix(out, first, "capabilities");
-    out += capabilitiesToJson(descriptor.capabilities);
+    appendCapabilitiesJson(out, descriptor.capabilities);
     appendFieldPrefix(out, first, "configSchema");
-    out += trim(descriptor.configSchemaJson).empty()
-        ? "null"
-        : jsonTokenOrDefault(descriptor.configSchemaJson, "{}");
+    appendJsonToken(out, descriptor.configSchemaJson, "null");
     out.push_back('}');
-    return out;
 }
 
-CmdResponse defaultCmdResponse(CmdId cmdId, const std::string &message)
+// ---------------------------------------------------------------------------
+// Per-instance identity fragments
+// ---------------------------------------------------------------------------
+
+struct StringViewHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view text) const noexcept { return std::hash<std::string_view>{}(text); }
+};
+
+template <typename Value>
+using StringKeyedMap = std::unordered_map<std::string, Value, StringViewHash, std::equal_to<>>;
+
+/**
+ * @brief Payload members every event of one instance starts with, escaped once.
+ *
+ * Built by AdapterInstance::bindContext(); a send then appends the cached bytes
+ * instead of escaping the instance id (and plugin type, for logs) per frame.
+ * Channel state events cache their whole head up to `"value":` per device and
+ * channel, so a steady state stream only encodes the value and timestamp.
+ */
+class InstanceIdentity
+{
+public:
+    void bind(const ExternalId &externalId, const Utf8String &pluginType)
+    {
+        m_externalId = &externalId;
+        m_pluginType = &pluginType;
+        m_externalIdMember = "\"externalId\":";
+        json::appendQuoted(m_externalIdMember, externalId);
+        m_logMembers = m_externalIdMember;
+        m_logMembers += ",\"plugin\":";
+        json::appendQuoted(m_logMembers, pluginType);
+        std::lock_guard<std::mutex> lock(m_channelMutex);
+        m_channelHeads.clear();
+        m_cachedChannels = 0;
+    }
+
+    // Identity is by address: only the strings bind() saw are known to match
+    // the cached bytes, an equal id passed from elsewhere is escaped as usual.
+    [[nodiscard]] bool owns(const ExternalId &externalId) const noexcept { return &externalId == m_externalId; }
+    [[nodiscard]] bool owns(const ExternalId &externalId, const Utf8String &plugin) const noexcept
+    {
+        return owns(externalId) && &plugin == m_pluginType;
+    }
+
+    void appendExternalId(std::string &out) const { out += m_externalIdMember; }
+    void appendLogMembers(std::string &out) const { out += m_logMembers; }
+
+    [[nodiscard]] std::unique_lock<std::mutex> lockChannelHeads() const
+    {
+        return std::unique_lock<std::mutex>(m_channelMutex);
+    }
+
+    // Caller holds lockChannelHeads().
+    void appendChannelStateHead(std::string &out,
+                                const ExternalId &deviceExternalId,
+                                const ExternalId &channelExternalId) const
+    {
+        auto device = m_channelHeads.find(std::string_view(deviceExternalId));
+        if (device != m_channelHeads.end()) {
+            const auto channel = device->second.find(std::string_view(channelExternalId));
+            if (channel != device->second.end()) {
+                out += channel->second;
+                return;
+            }
+        }
+        // Ids come from the adapter's topology, but bound the cache anyway in
+        // case an adapter mints them per event.
+        if (m_cachedChannels >= kMaxCachedChannels) {
+            m_channelHeads.clear();
+            m_cachedChannels = 0;
+            device = m_channelHeads.end();
+        }
+        if (device == m_channelHeads.end())
+            device = m_channelHeads.emplace(deviceExternalId, StringKeyedMap<std::string>{}).first;
+        std::string head(EnvelopePrefix<IpcCommand::EventChannelStateUpdated>::event);
+        head += m_externalIdMember;
+        head += ",\"deviceExternalId\":";
+        json::appendQuoted(head, deviceExternalId);
+        head += ",\"channelExternalId\":";
+        json::appendQuoted(head, channelExternalId);
+        head += ",\"value\":";
+        out += head;
+        device->second.emplace(channelExternalId, std::move(head));
+        ++m_cachedChannels;
+    }
+
+private:
+    static constexpr std::size_t kMaxCachedChannels = 4096;
+
+    const ExternalId *m_externalId = nullptr;
+    const Utf8String *m_pluginType = nullptr;
+    std::string m_externalIdMember;
+    std::string m_logMembers;
+    mutable std::mutex m_channelMutex;
+    mutable StringKeyedMap<StringKeyedMap<std::string>> m_channelHeads;
+    mutable std::size_t m_cachedChannels = 0;
+};
+
+thread_local const std::shared_ptr<InstanceIdentity> *t_instanceIdentity = nullptr;
+
+// Makes the identity of the AdapterInstance that is sending visible to the
+// dispatcher encoders it calls; the public send signatures stay unchanged.
+class ScopedInstanceIdentity
+{
+public:
+    explicit ScopedInstanceIdentity(const std::shared_ptr<InstanceIdentity> &identity)
+        : m_previous(t_instanceIdentity)
+    {
+        t_instanceIdentity = &identity;
+    }
+    ~ScopedInstanceIdentity() { t_instanceIdentity = m_previous; }
+    ScopedInstanceIdentity(const ScopedInstanceIdentity &) = delete;
+    ScopedInstanceIdentity &operator=(const ScopedInstanceIdentity &) = delete;
+
+private:
+    const std::shared_ptr<InstanceIdentity> *m_previous;
+};
+
+const InstanceIdentity *cachedIdentity(const ExternalId &externalId)
+{
+    const InstanceIdentity *identity = t_instanceIdentity ? t_instanceIdentity->get() : nullptr;
+    return identity && identity->owns(externalId) ? identity : nullptr;
+}
+
+// Keeps the cached identity alive for an event that is encoded after the send
+// call returned (and after the instance may be gone).
+std::shared_ptr<const InstanceIdentity> retainedIdentity(const ExternalId &externalId)
+{
+    return cachedIdentity(externalId) ? *t_instanceIdentity : nullptr;
+}
+
+std::shared_ptr<const InstanceIdentity> retainedIdentity(const ExternalId &externalId, const Utf8String &plugin)
+{
+    const InstanceIdentity *identity = cachedIdentity(externalId);
+    return identity && identity->owns(externalId, plugin) ? *t_instanceIdentity : nullptr;
+}
+
+void appendExternalIdMember(std::string &out, bool &first, const ExternalId &externalId)
+{
+    if (const InstanceIdentity *identity = cachedIdentity(externalId); identity && first) {
+        identity->appendExternalId(out);
+        first = false;
+        return;
+    }
+    appendFieldPrefix(out, first, "externalId");
+    json::appendQuoted(out, externalId);
+}
+
+// `identity` is null or already known to own `externalId` and `plugin`.
+void appendLogIdentity(std::string &out,
+                       bool &first,
+                       const InstanceIdentity *identity,
+                       const ExternalId &externalId,
+                       const Utf8String &plugin)
+{
+    if (identity && first) {
+        identity->appendLogMembers(out);
+        first = false;
+        return;
+    }
+    appendFieldPrefix(out, first, "externalId");
+    json::appendQuoted(out, externalId);
+    appendFieldPrefix(out, first, "plugin");
+    json::appendQuoted(out, plugin);
+}
+
+// Opens channel state events of one instance and writes their members up to
+// `"value":`. Holds the instance's channel head cache for its lifetime.
+// `identity` is null or already known to own `externalId`.
+class ChannelStateHeads
+{
+public:
+    ChannelStateHeads(const ExternalId &externalId, const InstanceIdentity *identity)
+        : m_externalId(externalId)
+        , m_identity(identity)
+    {
+        if (m_identity)
+            m_lock = m_identity->lockChannelHeads();
+    }
+
+    void open(std::string &out, const ExternalId &deviceExternalId, const ExternalId &channelExternalId) const
+    {
+        if (m_identity) {
+            out.reserve(g_frameSizes.estimate(IpcCommand::EventChannelStateUpdated));
+            m_identity->appendChannelStateHead(out, deviceExternalId, channelExternalId);
+            return;
+        }
+        bool first = true;
+        openEnvelope<IpcCommand::EventChannelStateUpdated>(out, first);
+        appendFieldPrefix(out, first, "externalId");
+        json::appendQuoted(out, m_externalId);
+        appendFieldPrefix(out, first, "deviceExternalId");
+        json::appendQuoted(out, deviceExternalId);
+        appendFieldPrefix(out, first, "channelExternalId");
+        json::appendQuoted(out, channelExternalId);
+        appendFieldPrefix(out, first, "value");
+    }
+
+private:
+    const ExternalId &m_externalId;
+    const InstanceIdentity *m_identity;
+    std::unique_lock<std::mutex> m_lock;
+};
+
+// Writes an EventStreamData frame up to `"data":`.
+void openStreamDataBody(std::string &out,
+                        const ExternalId &externalId,
+                        const Utf8String &streamId,
+                        const Utf8String &cmd,
+                        std::int64_t seq,
+                        std::int64_t tsMs)
+{
+    bool first = true;
+    openEnvelope<IpcCommand::EventStreamData>(out, first);
+    appendExternalIdMember(out, first, externalId);
+    appendFieldPrefix(out, first, "streamId");
+    json::appendQuoted(out, streamId);
+    appendFieldPrefix(out, first, "cmd");
+    json::appendQuoted(out, cmd);
+    appendFieldPrefix(out, first, "seq");
+    appendInteger(out, seq);
+    appendFieldPrefix(out, first, "tsMs");
+    appendInteger(out, tsMs);
+    appendFieldPrefix(out, first, "data");
+}
+
+// ---------------------------------------------------------------------------
+// Channel state dedupe
+// ---------------------------------------------------------------------------
+
+// Lenient bool reading of a channel value, as the core compares bool channels.
+bool channelBoolValue(const ScalarValue &value, bool *out)
+{
+    if (const bool *flag = std::get_if<bool>(&value)) {
+        *out = *flag;
+        return true;
+    }
+    if (const std::int64_t *number = std::get_if<std::int64_t>(&value)) {
+        *out = *number != 0;
+        return true;
+    }
+    if (const Utf8String *text = std::get_if<Utf8String>(&value)) {
+        const std::string lower = toLowerAscii(*text);
+        if (lower == "true" || lower == "on" || lower == "yes" || lower == "1") {
+            *out = true;
+            return true;
+        }
+        if (lower == "false" || lower == "off" || lower == "no" || lower == "0") {
+            *out = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool sameChannelValue(const ScalarValue &a, const ScalarValue &b)
+{
+    if (std::holds_alternative<bool>(a) || std::holds_alternative<bool>(b)) {
+        bool left = false;
+        bool right = false;
+        return channelBoolValue(a, &left) && channelBoolValue(b, &right) && left == right;
+    }
+    const auto numeric = [](const ScalarValue &value, double *out) {
+        if (const std::int64_t *number = std::get_if<std::int64_t>(&value)) {
+            *out = static_cast<double>(*number);
+            return true;
+        }
+        if (const double *number = std::get_if<double>(&value)) {
+            *out = *number;
+            return true;
+        }
+        return false;
+    };
+    if (std::holds_alternative<std::int64_t>(a) && std::holds_alternative<std::int64_t>(b))
+        return std::get<std::int64_t>(a) == std::get<std::int64_t>(b);
+    double left = 0.0;
+    double right = 0.0;
+    if (numeric(a, &left) && numeric(b, &right))
+        return left == right;
+    return a.index() == b.index() && a == b;
+}
+
+/**
+ * @brief Last channel state an instance sent, per device and channel.
+ *
+ * admit() decides whether an update goes out and records it when it does; a
+ * send that then fails is undone with forget() so the value is retried.
+ */
+class ChannelStateDedupe
+{
+public:
+    using Color = std::array<double, 3>;
+
+    void configure(const ChannelStateDedupeOptions &options)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_options = options;
+        m_values.clear();
+        m_enabled.store(options.enabled, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool enabled() const noexcept { return m_enabled.load(std::memory_order_acquire); }
+
+    template <typename Value>
+    [[nodiscard]] bool admit(const ExternalId &deviceExternalId,
+                             const ExternalId &channelExternalId,
+                             const Value &value)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto device = m_values.find(std::string_view(deviceExternalId));
+        if (device == m_values.end())
+            device = m_values.emplace(deviceExternalId, StringKeyedMap<LastSent>{}).first;
+        auto channel = device->second.find(std::string_view(channelExternalId));
+        if (channel == device->second.end()) {
+            device->second.emplace(channelExternalId, LastSent{value, now});
+            ++m_stats.sent;
+            return true;
+        }
+        LastSent &last = channel->second;
+        if (!sameValue(last.value, value)) {
+            last.value = value;
+            last.sentAt = now;
+            ++m_stats.sent;
+            return true;
+        }
+        if (m_options.refreshInterval.count() > 0 && now - last.sentAt >= m_options.refreshInterval) {
+            last.sentAt = now;
+            ++m_stats.refreshed;
+            return true;
+        }
+        ++m_stats.suppressed;
+        return false;
+    }
+
+    void forget(const ExternalId &deviceExternalId, const ExternalId &channelExternalId)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto device = m_values.find(std::string_view(deviceExternalId));
+        if (device != m_values.end())
+            device->second.erase(channelExternalId);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_values.clear();
+    }
+
+    [[nodiscard]] ChannelStateDedupeStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    struct LastSent {
+        std::variant<ScalarValue, Color> value;
+        std::chrono::steady_clock::time_point sentAt;
+    };
+
+    static bool sameValue(const std::variant<ScalarValue, Color> &last, const ScalarValue &value)
+    {
+        const ScalarValue *scalar = std::get_if<ScalarValue>(&last);
+        return scalar && sameChannelValue(*scalar, value);
+    }
+    static bool sameValue(const std::variant<ScalarValue, Color> &last, const Color &value)
+    {
+        const Color *color = std::get_if<Color>(&last);
+        return color && *color == value;
+    }
+
+    std::atomic_bool m_enabled{false};
+    mutable std::mutex m_mutex;
+    ChannelStateDedupeOptions m_options;
+    StringKeyedMap<StringKeyedMap<LastSent>> m_values;
+    ChannelStateDedupeStats m_stats;
+};
+
+// ---------------------------------------------------------------------------
+// Numeric channel filters
+// ---------------------------------------------------------------------------
+
+enum class FilterVerdict {
+    Publish,
+    PublishQuantized,
+    Hold,
+};
+
+/**
+ * @brief Per-channel deadband, rate limit and quantization of one instance.
+ *
+ * State is what was last published per channel, plus the newest change held
+ * back by `minInterval`. takeDue() hands out held changes once that has
+ * passed and republishes values older than `maxAge`; nextDue() tells the host
+ * poll loop when that is next needed. Integers are filtered in integer
+ * arithmetic, so values beyond 2^53 stay exact.
+ */
+class ChannelPublishFilters
+{
+public:
+    void set(const ExternalId &deviceExternalId, const ExternalId &channelExternalId, const NumericChannelFilter &filter)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ChannelState &state = m_channels.try_emplace(deviceExternalId).first->second.try_emplace(channelExternalId)
+                                  .first->second;
+        state = ChannelState{};
+        state.filter = filter;
+        m_active.store(true, std::memory_order_release);
+    }
+
+    void clear(const ExternalId &deviceExternalId, const ExternalId &channelExternalId)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto device = m_channels.find(std::string_view(deviceExternalId));
+        if (device == m_channels.end())
+            return;
+        device->second.erase(channelExternalId);
+        if (device->second.empty())
+            m_channels.erase(device);
+        m_active.store(!m_channels.empty(), std::memory_order_release);
+    }
+
+    [[nodiscard]] bool active() const noexcept { return m_active.load(std::memory_order_acquire); }
+
+    // Forgets what was published and held; the filters stay configured.
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &[deviceExternalId, channels] : m_channels) {
+            for (auto &[channelExternalId, state] : channels) {
+                const NumericChannelFilter filter = state.filter;
+                state = ChannelState{};
+                state.filter = filter;
+            }
+        }
+        m_nextDue.store(kNeverDue, std::memory_order_relaxed);
+        m_claimed.store(false, std::memory_order_release);
+    }
+
+    FilterVerdict apply(const ExternalId &deviceExternalId,
+                        const ExternalId &channelExternalId,
+                        const ScalarValue &value,
+                        std::int64_t tsMs,
+                        ScalarValue *quantized)
+    {
+        Number number;
+        if (const std::int64_t *integer = std::get_if<std::int64_t>(&value)) {
+            number.integral = true;
+            number.integer = *integer;
+            number.real = static_cast<double>(*integer);
+        } else if (const double *real = std::get_if<double>(&value)) {
+            number.real = *real;
+        } else {
+            return FilterVerdict::Publish;
+        }
+        // Non-finite values go out as JSON null; nothing to filter.
+        if (!std::isfinite(number.real))
+            return FilterVerdict::Publish;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ChannelState *state = find(deviceExternalId, channelExternalId);
+        if (!state)
+            return FilterVerdict::Publish;
+        const NumericChannelFilter &filter = state->filter;
+        const Number published = quantize(filter.quantizationStep, number);
+
+        const auto now = std::chrono::steady_clock::now();
+        const auto age = now - state->publishedAt;
+        const bool changed = !state->hasLast || !withinDeadband(filter, state->last, published);
+        const bool publish = changed
+            ? !state->hasLast || filter.minInterval.count() <= 0 || age >= filter.minInterval
+            : filter.maxAge.count() > 0 && age >= filter.maxAge;
+        if (!publish) {
+            // A value back within the deadband supersedes any held change.
+            state->held = changed;
+            if (changed) {
+                state->heldValue = published;
+                state->heldTsMs = tsMs;
+                scheduleAt(state->publishedAt + filter.minInterval);
+            }
+            return FilterVerdict::Hold;
+        }
+        state->hasLast = true;
+        state->last = published;
+        state->publishedAt = now;
+        state->held = false;
+        if (filter.maxAge.count() > 0)
+            scheduleAt(now + filter.maxAge);
+        if (sameNumber(published, number))
+            return FilterVerdict::Publish;
+        *quantized = valueOf(published);
+        return FilterVerdict::PublishQuantized;
+    }
+
+    // Held-back changes whose minInterval has passed, and last values older
+    // than maxAge, recorded as published.
+    std::vector<ChannelStateUpdate> takeDue()
+    {
+        std::vector<ChannelStateUpdate> due;
+        const auto now = std::chrono::steady_clock::now();
+        auto nextDue = std::chrono::steady_clock::time_point::max();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_claimed.store(false, std::memory_order_release);
+        for (auto &[deviceExternalId, channels] : m_channels) {
+            for (auto &[channelExternalId, state] : channels) {
+                const NumericChannelFilter &filter = state.filter;
+                if (state.held && now - state.publishedAt >= filter.minInterval) {
+                    due.push_back({deviceExternalId, channelExternalId, valueOf(state.heldValue), state.heldTsMs});
+                    state.last = state.heldValue;
+                    state.publishedAt = now;
+                    state.held = false;
+                } else if (!state.held && state.hasLast && filter.maxAge.count() > 0
+                           && now - state.publishedAt >= filter.maxAge) {
+                    // Stamped now: the value is confirmed, not newly sampled.
+                    due.push_back({deviceExternalId, channelExternalId, valueOf(state.last), 0});
+                    state.publishedAt = now;
+                }
+                if (state.held)
+                    nextDue = std::min(nextDue, state.publishedAt + filter.minInterval);
+                else if (state.hasLast && filter.maxAge.count() > 0)
+                    nextDue = std::min(nextDue, state.publishedAt + filter.maxAge);
+            }
+        }
+        m_nextDue.store(nextDue == std::chrono::steady_clock::time_point::max()
+                            ? kNeverDue : nextDue.time_since_epoch().count(),
+                        std::memory_order_relaxed);
+        return due;
+    }
+
+    // When takeDue() next has work; time_point::max() while nothing is
+    // scheduled or a takeDue() has been claimed and not run yet. May be early.
+    [[nodiscard]] std::chrono::steady_clock::time_point nextDue() const noexcept
+    {
+        if (m_claimed.load(std::memory_order_acquire))
+            return std::chrono::steady_clock::time_point::max();
+        const std::int64_t ticks = m_nextDue.load(std::memory_order_relaxed);
+        return ticks == kNeverDue ? std::chrono::steady_clock::time_point::max()
+                                  : std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+    }
+
+    // True once per due point: the caller then owes a takeDue().
+    bool claimDue(std::chrono::steady_clock::time_point now) noexcept
+    {
+        return nextDue() <= now && !m_claimed.exchange(true, std::memory_order_acq_rel);
+    }
+
+private:
+    static constexpr std::int64_t kNeverDue = std::numeric_limits<std::int64_t>::max();
+
+    // The double mirrors the integer for ratios; the integer is what is sent.
+    struct Number {
+        bool integral = false;
+        std::int64_t integer = 0;
+        double real = 0.0;
+    };
+
+    struct ChannelState {
+        NumericChannelFilter filter;
+        bool hasLast = false;
+        Number last;
+        std::chrono::steady_clock::time_point publishedAt{};
+        bool held = false;
+        Number heldValue;
+        std::int64_t heldTsMs = 0;
+    };
+
+    static bool sameNumber(const Number &a, const Number &b)
+    {
+        return a.integral ? a.integer == b.integer : a.real == b.real;
+    }
+
+    static bool withinDeadband(const NumericChannelFilter &filter, const Number &last, const Number &value)
+    {
+        double delta = 0.0;
+        if (last.integral && value.integral) {
+            if (last.integer == value.integer)
+                return true;
+            const auto high = static_cast<std::uint64_t>(std::max(last.integer, value.integer));
+            const auto low = static_cast<std::uint64_t>(std::min(last.integer, value.integer));
+            delta = static_cast<double>(high - low);
+        } else {
+            delta = std::abs(value.real - last.real);
+            if (delta == 0.0)
+                return true;
+        }
+        if (filter.absoluteDeadband > 0.0 && delta <= filter.absoluteDeadband)
+            return true;
+        return filter.relativeDeadband > 0.0 && delta <= filter.relativeDeadband * std::abs(last.real);
+    }
+
+    // Nearest multiple of `step`, halves away from zero like std::round;
+    // saturates toward zero where that multiple is out of range.
+    static std::int64_t roundToMultiple(std::int64_t value, std::int64_t step)
+    {
+        const std::int64_t remainder = value % step;
+        const std::int64_t down = value - remainder;
+        const std::uint64_t magnitude = remainder < 0 ? 0 - static_cast<std::uint64_t>(remainder)
+                                                      : static_cast<std::uint64_t>(remainder);
+        if (magnitude < static_cast<std::uint64_t>(step) - magnitude)
+            return down;
+        if (value >= 0)
+            return down <= std::numeric_limits<std::int64_t>::max() - step ? down + step : down;
+        return down >= std::numeric_limits<std::int64_t>::min() + step ? down - step : down;
+    }
+
+    static Number quantize(double step, Number value)
+    {
+        if (!(step > 0.0))
+            return value;
+        if (!value.integral) {
+            value.real = std::round(value.real / step) * step;
+            return value;
+        }
+        if (step >= 1.0 && step < 0x1p63 && std::floor(step) == step) {
+            value.integer = roundToMultiple(value.integer, static_cast<std::int64_t>(step));
+        } else if (std::abs(value.real) <= 0x1p53) {
+            value.integer = std::llround(std::round(value.real / step) * step);
+        } else {
+            // A fractional or huge step beyond double precision: keep the exact value.
+            return value;
+        }
+        value.real = static_cast<double>(value.integer);
+        return value;
+    }
+
+    static ScalarValue valueOf(const Number &number)
+    {
+        if (number.integral)
+            return number.integer;
+        return number.real;
+    }
+
+    // Caller holds m_mutex.
+    void scheduleAt(std::chrono::steady_clock::time_point due)
+    {
+        const std::int64_t ticks = due.time_since_epoch().count();
+        if (ticks < m_nextDue.load(std::memory_order_relaxed))
+            m_nextDue.store(ticks, std::memory_order_relaxed);
+    }
+
+    ChannelState *find(const ExternalId &deviceExternalId, const ExternalId &channelExternalId)
+    {
+        const auto device = m_channels.find(std::string_view(deviceExternalId));
+        if (device == m_channels.end())
+            return nullptr;
+        const auto channel = device->second.find(std::string_view(channelExternalId));
+        return channel != device->second.end() ? &channel->second : nullptr;
+    }
+
+    std::atomic_bool m_active{false};
+    std::atomic<std::int64_t> m_nextDue{kNeverDue};
+    std::atomic_bool m_claimed{false};
+    std::mutex m_mutex;
+    StringKeyedMap<StringKeyedMap<ChannelState>> m_channels;
+};
+
+// ---------------------------------------------------------------------------
+// Log dedupe
+// ---------------------------------------------------------------------------
+
+// `fieldsJson` with `"<key>":<value>` as its first member. Fields that are
+// not an object are dropped.
+phicore::adapter::v1::JsonText withJsonField(std::string_view fieldsJson, std::string_view key, std::string_view value)
+{
+    std::string out = "{";
+    json::appendQuoted(out, key);
+    out.push_back(':');
+    out += value;
+    const std::string_view fields = trim(fieldsJson);
+    const std::string_view rest = fields.empty() || fields.front() != '{' ? std::string_view("}")
+                                                                           : trim(fields.substr(1));
+    if (!rest.empty() && rest.front() != '}')
+        out.push_back(',');
+    out += rest.empty() ? std::string_view("}") : rest;
+    return out;
+}
+
+phicore::adapter::v1::JsonText withCountField(std::string_view fieldsJson, std::string_view key, std::uint64_t count)
+{
+    std::string value;
+    appendInteger(value, count);
+    return withJsonField(fieldsJson, key, value);
+}
+
+/**
+ * @brief Collapses repeated log lines of one instance (or the factory).
+ *
+ * Keyed by level, category, message template and ctx (the target fixes the
+ * externalId). Within a window the first occurrence is sent and the rest are
+ * counted; the count goes out as `fields.suppressedCount`, on the first
+ * occurrence of the next window or on a summary of the last suppressed entry
+ * once the window has closed. Errors and incidents are never held back; they
+ * carry `fields.repeatCount` instead. Trace logs can additionally be sampled.
+ */
+class LogDedupe
+{
+public:
+    void configure(const LogDedupeOptions &options, std::vector<LogEntry> *pending)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sweep(0, true, pending);
+        m_options = options;
+        m_traceSkip = 0;
+        m_traceSampledOut = 0;
+        m_nextSweepMs = 0;
+        m_enabled.store(options.window.count() > 0 || options.traceSampleEvery > 1, std::memory_order_release);
+    }
+
+    [[nodiscard]] bool enabled() const noexcept { return m_enabled.load(std::memory_order_acquire); }
+
+    /// Appends the entries to send in place of `entry` to `out`, in order.
+    void admit(LogEntry &&entry, std::int64_t nowMs, std::vector<LogEntry> *out)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sweepIfDue(nowMs, out);
+        std::uint64_t suppressed = 0;
+        if (entry.level == LogLevel::Trace && m_options.traceSampleEvery > 1) {
+            if (m_traceSkip > 0) {
+                --m_traceSkip;
+                ++m_traceSampledOut;
+                return;
+            }
+            m_traceSkip = m_options.traceSampleEvery - 1;
+            suppressed = std::exchange(m_traceSampledOut, 0);
+        }
+        Window *window = m_options.window.count() > 0 ? track(entry, false, nowMs) : nullptr;
+        if (window && window->occurrences > 1) {
+            if (entry.level != LogLevel::Error) {
+                ++window->suppressed;
+                window->last = std::move(entry);
+                return;
+            }
+            entry.fieldsJson = withCountField(entry.fieldsJson, "repeatCount", window->occurrences);
+        }
+        if (window)
+            suppressed += std::exchange(window->carried, 0);
+        if (suppressed > 0)
+            entry.fieldsJson = withCountField(entry.fieldsJson, "suppressedCount", suppressed);
+        out->push_back(std::move(entry));
+    }
+
+    /// `fieldsJson` of an incident, with `repeatCount` when it repeats
+    /// within the window. Incidents are always sent.
+    phicore::adapter::v1::JsonText countIncident(LogCategory category,
+                                                 const Utf8String &message,
+                                                 const Utf8String &ctx,
+                                                 const phicore::adapter::v1::JsonText &fieldsJson,
+                                                 std::int64_t nowMs,
+                                                 std::vector<LogEntry> *out)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sweepIfDue(nowMs, out);
+        if (m_options.window.count() <= 0)
+            return fieldsJson;
+        LogEntry probe;
+        probe.level = LogLevel::Error;
+        probe.category = category;
+        probe.message = message;
+        probe.ctx = ctx;
+        const Window *window = track(probe, true, nowMs);
+        return window && window->occurrences > 1 ? withCountField(fieldsJson, "repeatCount", window->occurrences)
+                                                 : fieldsJson;
+    }
+
+    /// Summaries of every window still holding suppressed entries.
+    void flush(std::vector<LogEntry> *out)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        sweep(0, true, out);
+    }
+
+private:
+    // Keys tracked at once; beyond this, new lines pass untracked until a
+    // sweep frees room.
+    static constexpr std::size_t kMaxWindows = 256;
+
+    struct Window {
+        LogLevel level = LogLevel::Info;
+        LogCategory category = LogCategory::Internal;
+        bool incident = false;
+        Utf8String message;
+        Utf8String ctx;
+        std::int64_t openedMs = 0;
+        std::uint64_t occurrences = 0;
+        std::uint64_t suppressed = 0;
+        /// Suppressed count of the previous window, reported by the next send.
+        std::uint64_t carried = 0;
+        LogEntry last;
+    };
+
+    static std::size_t keyOf(const LogEntry &entry, bool incident)
+    {
+        const std::size_t text = std::hash<std::string_view>{}(entry.message);
+        const std::size_t ctx = std::hash<std::string_view>{}(entry.ctx);
+        const std::size_t tag = (static_cast<std::size_t>(entry.level) << 9)
+            | (static_cast<std::size_t>(entry.category) << 1) | (incident ? 1U : 0U);
+        return text ^ (ctx * 0x9e3779b97f4a7c15ULL) ^ (tag * 0xc2b2ae3d27d4eb4fULL);
+    }
+
+    // The window of `entry`, opened or restarted as needed and counting this
+    // occurrence; nullptr when the line cannot be tracked.
+    Window *track(const LogEntry &entry, bool incident, std::int64_t nowMs)
+    {
+        auto it = m_windows.find(keyOf(entry, incident));
+        if (it == m_windows.end()) {
+            if (m_windows.size() >= kMaxWindows)
+                return nullptr;
+            it = m_windows.emplace(keyOf(entry, incident), Window{}).first;
+        } else if (it->second.level != entry.level || it->second.category != entry.category
+                   || it->second.incident != incident || it->second.message != entry.message
+                   || it->second.ctx != entry.ctx) {
+            return nullptr;
+        }
+        Window &window = it->second;
+        if (window.occurrences == 0 || nowMs - window.openedMs >= m_options.window.count()) {
+            const std::uint64_t carried = window.suppressed;
+            window = Window{entry.level, entry.category, incident, entry.message, entry.ctx, nowMs, 0, 0, carried, {}};
+        }
+        ++window.occurrences;
+        return &window;
+    }
+
+    void sweepIfDue(std::int64_t nowMs, std::vector<LogEntry> *out)
+    {
+        if (m_options.window.count() <= 0 || nowMs < m_nextSweepMs)
+            return;
+        sweep(nowMs, false, out);
+        m_nextSweepMs = nowMs + m_options.window.count();
+    }
+
+    // Closes windows older than the window length (all when `all`), sending a
+    // summary for each that suppressed something.
+    void sweep(std::int64_t nowMs, bool all, std::vector<LogEntry> *out)
+    {
+        for (auto it = m_windows.begin(); it != m_windows.end();) {
+            Window &window = it->second;
+            if (!all && nowMs - window.openedMs < m_options.window.count()) {
+                ++it;
+                continue;
+            }
+            if (window.suppressed > 0) {
+                LogEntry summary = std::move(window.last);
+                summary.fieldsJson = withCountField(summary.fieldsJson, "suppressedCount", window.suppressed);
+                out->push_back(std::move(summary));
+            }
+            it = m_windows.erase(it);
+        }
+    }
+
+    std::atomic_bool m_enabled{false};
+    std::mutex m_mutex;
+    LogDedupeOptions m_options;
+    std::unordered_map<std::size_t, Window> m_windows;
+    std::int64_t m_nextSweepMs = 0;
+    std::uint32_t m_traceSkip = 0;
+    std::uint64_t m_traceSampledOut = 0;
+};
+
+bool sendLogEntries(SidecarDispatcher &dispatcher,
+                    const ExternalId &externalId,
+                    const Utf8String &plugin,
+                    std::vector<LogEntry> &entries,
+                    Utf8String *error)
+{
+    bool ok = true;
+    for (LogEntry &entry : entries)
+        ok = dispatcher.sendLog(externalId, plugin, std::move(entry), error) && ok;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Flight recorder
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Fixed ring of filtered-out log entries in binary form.
+ *
+ * A producer claims a slot with one fetch_add and publishes it through the
+ * slot's sequence word (odd while written), so recording neither locks nor
+ * allocates. Readers copy a slot and keep it only if its sequence did not
+ * move meanwhile; entries overwritten or torn before they were read are
+ * counted as dropped. Readers are serialized by m_readMutex.
+ */
+class FlightRecorder
+{
+public:
+    static constexpr std::size_t kSlotBytes = 256;
+
+    /// Not concurrent with record(); drops the recording.
+    void configure(const FlightRecorderOptions &options)
+    {
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        std::size_t capacity = 0;
+        if (options.capacity > 0) {
+            capacity = 1;
+            while (capacity < options.capacity)
+                capacity *= 2;
+        }
+        m_slots = capacity > 0 ? std::make_unique<Slot[]>(capacity) : nullptr;
+        m_mask = capacity > 0 ? capacity - 1 : 0;
+        m_minLevel = static_cast<int>(options.minLevel);
+        m_incidentEntries = options.incidentEntries;
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail = 0;
+        m_dropped = 0;
+    }
+
+    [[nodiscard]] bool records(LogLevel level) const noexcept
+    {
+        return m_slots && static_cast<int>(level) >= m_minLevel;
+    }
+    [[nodiscard]] std::size_t incidentEntries() const noexcept { return m_slots ? m_incidentEntries : 0; }
+
+    void record(LogLevel level,
+                LogCategory category,
+                std::string_view message,
+                const ScalarList &params,
+                std::string_view ctx,
+                std::string_view fieldsJson,
+                std::int64_t tsMs) noexcept
+    {
+        std::array<std::uint64_t, kWords> words{};
+        encodeEntry(reinterpret_cast<unsigned char *>(words.data()), level, category, message, params, ctx,
+                    fieldsJson, tsMs);
+        const std::uint64_t pos = m_head.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = m_slots[pos & m_mask];
+        // A writer a full lap behind or ahead still owns the slot: give up
+        // this entry rather than interleave with it.
+        std::uint64_t seen = slot.sequence.load(std::memory_order_relaxed);
+        if ((seen & 1U) != 0 || seen > 2 * pos
+            || !slot.sequence.compare_exchange_strong(seen, 2 * pos + 1, std::memory_order_relaxed)) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < kWords; ++i)
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        slot.sequence.store(2 * pos + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Unread entries as JSON objects, oldest first, and marks them read.
+     *
+     * With `newest > 0` only that many of the most recent are returned.
+     * `*dropped` receives the entries lost since the last take.
+     */
+    std::vector<std::string> take(std::size_t newest, std::uint64_t *dropped)
+    {
+        std::vector<std::string> entries;
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        const std::uint64_t head = m_head.load(std::memory_order_acquire);
+        if (!m_slots) {
+            *dropped = 0;
+            return entries;
+        }
+        const std::uint64_t capacity = m_mask + 1;
+        std::uint64_t from = std::max(m_tail, head > capacity ? head - capacity : 0);
+        m_dropped += from - m_tail;
+        if (newest > 0 && head - from > newest)
+            from = head - newest;
+        std::array<std::uint64_t, kWords> words{};
+        for (std::uint64_t pos = from; pos < head; ++pos) {
+            const Slot &slot = m_slots[pos & m_mask];
+            const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < kWords; ++i)
+                words[i] = slot.words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (before != 2 * pos + 2 || slot.sequence.load(std::memory_order_relaxed) != before) {
+                ++m_dropped;
+                continue;
+            }
+            entries.push_back(decodeEntry(reinterpret_cast<const unsigned char *>(words.data())));
+        }
+        m_tail = head;
+        *dropped = std::exchange(m_dropped, 0);
+        return entries;
+    }
+
+private:
+    static constexpr std::size_t kWords = kSlotBytes / sizeof(std::uint64_t);
+    // tsMs, level, category, flags, param count, message and ctx lengths.
+    static constexpr std::size_t kHeaderBytes = 14;
+    static constexpr std::uint8_t kTruncated = 0x1;
+    static constexpr std::uint8_t kHasFields = 0x2;
+    enum ParamTag : std::uint8_t { Null, False, True, Integer, Double, String };
+
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        std::array<std::atomic<std::uint64_t>, kWords> words{};
+    };
+
+    // Longest prefix of `text` of at most `room` bytes that ends on a UTF-8
+    // character boundary.
+    static std::size_t fitUtf8(std::string_view text, std::size_t room) noexcept
+    {
+        if (text.size() <= room)
+            return text.size();
+        std::size_t size = room;
+        while (size > 0 && (static_cast<unsigned char>(text[size]) & 0xC0U) == 0x80U)
+            --size;
+        return size;
+    }
+
+    static void encodeEntry(unsigned char *out,
+                            LogLevel level,
+                            LogCategory category,
+                            std::string_view message,
+                            const ScalarList &params,
+                            std::string_view ctx,
+                            std::string_view fieldsJson,
+                            std::int64_t tsMs) noexcept
+    {
+        std::uint8_t flags = 0;
+        std::size_t at = kHeaderBytes;
+        const auto putText = [&](std::string_view text, std::size_t limit) -> std::uint8_t {
+            const std::size_t size = fitUtf8(text, std::min(limit, kSlotBytes - at));
+            if (size < text.size())
+                flags |= kTruncated;
+            if (size > 0)
+                std::memcpy(out + at, text.data(), size);
+            at += size;
+            return static_cast<std::uint8_t>(size);
+        };
+        std::memcpy(out, &tsMs, sizeof(tsMs));
+        out[8] = static_cast<std::uint8_t>(level);
+        out[9] = static_cast<std::uint8_t>(category);
+        out[12] = putText(message, 128);
+        out[13] = putText(ctx, 48);
+
+        std::uint8_t count = 0;
+        for (const ScalarValue &param : params) {
+            const std::size_t room = kSlotBytes - at;
+            if (const Utf8String *text = std::get_if<Utf8String>(&param)) {
+                if (room < 2)
+                    break;
+                out[at++] = String;
+                const std::size_t lengthAt = at++;
+                out[lengthAt] = putText(*text, 255);
+            } else if (const bool *flag = std::get_if<bool>(&param)) {
+                if (room < 1)
+                    break;
+                out[at++] = *flag ? True : False;
+            } else if (std::holds_alternative<std::monostate>(param)) {
+                if (room < 1)
+                    break;
+                out[at++] = Null;
+            } else {
+                if (room < 9)
+                    break;
+                const std::int64_t *integer = std::get_if<std::int64_t>(&param);
+                out[at++] = integer ? Integer : Double;
+                std::memcpy(out + at, integer ? static_cast<const void *>(integer) : &std::get<double>(param), 8);
+                at += 8;
+            }
+            ++count;
+        }
+        if (count < params.size())
+            flags |= kTruncated;
+
+        // Fields are JSON: kept whole or not at all.
+        const std::string_view fields = trim(fieldsJson);
+        if (!fields.empty() && fields != "{}") {
+            if (kSlotBytes - at >= fields.size() + 1 && fields.size() <= 255) {
+                flags |= kHasFields;
+                out[at++] = static_cast<std::uint8_t>(fields.size());
+                std::memcpy(out + at, fields.data(), fields.size());
+            } else {
+                flags |= kTruncated;
+            }
+        }
+        out[10] = flags;
+        out[11] = count;
+    }
+
+    static std::string decodeEntry(const unsigned char *in)
+    {
+        std::int64_t tsMs = 0;
+        std::memcpy(&tsMs, in, sizeof(tsMs));
+        const std::uint8_t flags = in[10];
+        std::size_t at = kHeaderBytes;
+        const auto text = [&](std::size_t size) {
+            const std::string_view view(reinterpret_cast<const char *>(in + at), size);
+            at += size;
+            return view;
+        };
+        std::string out;
+        bool first = true;
+        out.push_back('{');
+        appendFieldPrefix(out, first, "tsMs");
+        appendInteger(out, tsMs);
+        appendFieldPrefix(out, first, "level");
+        appendInteger(out, static_cast<unsigned int>(encodeWireLevel(static_cast<LogLevel>(in[8]))));
+        appendFieldPrefix(out, first, "category");
+        appendInteger(out, static_cast<unsigned int>(encodeWireCategory(static_cast<LogCategory>(in[9]), false)));
+        appendFieldPrefix(out, first, "message");
+        json::appendQuoted(out, text(in[12]));
+        appendFieldPrefix(out, first, "ctx");
+        json::appendQuoted(out, text(in[13]));
+        appendFieldPrefix(out, first, "params");
+        out.push_back('[');
+        for (std::uint8_t i = 0; i < in[11]; ++i) {
+            if (i > 0)
+                out.push_back(',');
+            const std::uint8_t tag = in[at++];
+            if (tag == String) {
+                const std::size_t size = in[at++];
+                json::appendQuoted(out, text(size));
+            } else if (tag == Integer || tag == Double) {
+                std::int64_t integer = 0;
+                double number = 0.0;
+                std::memcpy(tag == Integer ? static_cast<void *>(&integer) : &number, in + at, 8);
+                at += 8;
+                if (tag == Integer)
+                    appendInteger(out, integer);
+                else
+                    appendDoubleJson(out, number);
+            } else {
+                out += tag == True ? "true" : tag == False ? "false" : "null";
+            }
+        }
+        out.push_back(']');
+        if ((flags & kHasFields) != 0) {
+            const std::size_t size = in[at++];
+            appendFieldPrefix(out, first, "fields");
+            out += text(size);
+        }
+        if ((flags & kTruncated) != 0) {
+            appendFieldPrefix(out, first, "truncated");
+            out += "true";
+        }
+        out.push_back('}');
+        return out;
+    }
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::uint64_t m_mask = 0;
+    int m_minLevel = 0;
+    std::size_t m_incidentEntries = 0;
+    alignas(64) std::atomic<std::uint64_t> m_head{0};
+    std::mutex m_readMutex;
+    std::uint64_t m_tail = 0;
+    std::uint64_t m_dropped = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Log templates
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Log templates registered with the core in the current session.
+ *
+ * A template is plugin, wire category, ctx and message; the core learns it
+ * from one EventLogTemplate frame and expands every later EventLogRef with
+ * its id. Only messages with `%N` placeholders, or seen a second time, are
+ * registered, so one-off lines stay single EventLog frames. Ids are never
+ * reused, so a registration that got lost, or was evicted as least recently
+ * used, can simply be dropped from here and is sent again under a new id.
+ */
+class LogTemplateRegistry
+{
+public:
+    // Templates kept at once; the least recently used one makes room.
+    static constexpr std::size_t kMaxTemplates = 1024;
+    // The core keeps every id until disconnect; past this many registrations
+    // in a session new templates go out as plain EventLog frames.
+    static constexpr std::size_t kMaxRegistrations = 8 * kMaxTemplates;
+
+    /// Id of the template, registering it when new (`*added`); 0 for a log
+    /// to send plain.
+    std::uint64_t intern(std::string_view plugin,
+                         std::uint8_t category,
+                         std::string_view ctx,
+                         std::string_view message,
+                         bool *added)
+    {
+        *added = false;
+        m_key.clear();
+        for (const std::string_view part : {plugin, ctx, message}) {
+            m_key += std::to_string(part.size());
+            m_key.push_back(':');
+            m_key += part;
+        }
+        m_key.push_back(static_cast<char>(category));
+        if (const auto it = m_templates.find(std::string_view(m_key)); it != m_templates.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+            return it->second.id;
+        }
+        if (m_nextId > kMaxRegistrations)
+            return 0;
+        if (!hasPlaceholder(message)) {
+            // Remembered by hash only; a collision merely registers early.
+            const std::size_t hash = std::hash<std::string>{}(m_key);
+            if (m_seenOnce.erase(hash) == 0) {
+                if (m_seenOnce.size() >= kMaxTemplates)
+                    m_seenOnce.clear();
+                m_seenOnce.insert(hash);
+                return 0;
+            }
+        }
+        if (m_templates.size() >= kMaxTemplates) {
+            m_templates.erase(std::string_view(m_lru.back()));
+            m_lru.pop_back();
+        }
+        m_lru.push_front(m_key);
+        *added = true;
+        const std::uint64_t id = m_nextId++;
+        m_templates.emplace(std::string_view(m_lru.front()), Template{id, m_lru.begin()});
+        return id;
+    }
+
+    void clear()
+    {
+        m_templates.clear();
+        m_lru.clear();
+        m_seenOnce.clear();
+    }
+
+private:
+    struct Template {
+        std::uint64_t id = 0;
+        std::list<std::string>::iterator lru;
+    };
+
+    static bool hasPlaceholder(std::string_view message)
+    {
+        for (std::size_t at = message.find('%'); at != std::string_view::npos; at = message.find('%', at + 1)) {
+            if (at + 1 < message.size() && message[at + 1] >= '1' && message[at + 1] <= '9')
+                return true;
+        }
+        return false;
+    }
+
+    // Keys, most recently used first; the map's views point into it.
+    std::list<std::string> m_lru;
+    std::unordered_map<std::string_view, Template> m_templates;
+    std::unordered_set<std::size_t> m_seenOnce;
+    std::string m_key;
+    std::uint64_t m_nextId = 1;
+};
+
+// ---------------------------------------------------------------------------
+// Topology cache
+// ---------------------------------------------------------------------------
+
+/// Device and channel records last sent for one device, as encoded JSON.
+/// Comparing encodings needs no equality on the v1 records and matches
+/// exactly what the core received.
+struct SentDevice {
+    std::string device;
+    std::vector<std::pair<ExternalId, std::string>> channels;
+    /// Stamp of the send that stored this entry; frames are queued outside the
+    /// lock, so a send only commits if nobody stored an entry since it looked.
+    std::uint64_t generation = 0;
+};
+
+/// instance externalId -> device externalId -> last sent records.
+using SentTopology = StringKeyedMap<StringKeyedMap<SentDevice>>;
+
+SentDevice *findSentDevice(SentTopology &topology, const ExternalId &externalId, const ExternalId &deviceExternalId)
+{
+    const auto instance = topology.find(std::string_view(externalId));
+    if (instance == topology.end())
+        return nullptr;
+    const auto device = instance->second.find(std::string_view(deviceExternalId));
+    return device != instance->second.end() ? &device->second : nullptr;
+}
+
+std::uint64_t sentGeneration(SentTopology &topology, const ExternalId &externalId, const ExternalId &deviceExternalId)
+{
+    const SentDevice *sent = findSentDevice(topology, externalId, deviceExternalId);
+    return sent ? sent->generation : 0;
+}
+
+void forgetSentDevice(SentTopology &topology, const ExternalId &externalId, const ExternalId &deviceExternalId)
+{
+    const auto instance = topology.find(std::string_view(externalId));
+    if (instance != topology.end())
+        instance->second.erase(deviceExternalId);
+}
+
+bool sameChannelIds(const std::vector<std::pair<ExternalId, std::string>> &a,
+                    const std::vector<std::pair<ExternalId, std::string>> &b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto &left, const auto &right) {
+        return left.first == right.first;
+    });
+}
+
+void appendChannelUpdatedBody(std::string &out,
+                              const ExternalId &externalId,
+                              const ExternalId &deviceExternalId,
+                              std::string_view channelJson)
+{
+    bool first = true;
+    openEnvelope<IpcCommand::EventChannelUpdated>(out, first);
+    appendExternalIdMember(out, first, externalId);
+    appendFieldPrefix(out, first, "deviceExternalId");
+    json::appendQuoted(out, deviceExternalId);
+    appendFieldPrefix(out, first, "channel");
+    out += channelJson;
+    closeEnvelope<IpcCommand::EventChannelUpdated>(out);
+}
+
+CmdResponse defaultCmdResponse(CmdId cmdId, const std::string &message)
+{
+    CmdResponse response;
+    response.id = cmdId;
+    response.status = CmdStatus::NotImplemented;
+    response.error = message;
+    response.tsMs = nowMs();
+    return response;
+}
+
+ActionResponse defaultActionResponse(CmdId cmdId, const std::string &message)
+{
+    ActionResponse response;
+    response.id = cmdId;
+    response.status = CmdStatus::NotImplemented;
+    response.error = message;
+    response.resultType = ActionResultType::None;
+    response.tsMs = nowMs();
+    return response;
+}
+
+CmdResponse invalidArgumentCmdResponse(CmdId cmdId, const std::string &message)
+{
+    CmdResponse response;
+    response.id = cmdId;
+    response.status = CmdStatus::InvalidArgument;
+    response.error = message;
+    response.tsMs = nowMs();
+    return response;
+}
+
+ActionResponse invalidArgumentActionResponse(CmdId cmdId, const std::string &message)
+{
+    ActionResponse response;
+    response.id = cmdId;
+    response.status = CmdStatus::InvalidArgument;
+    response.error = message;
+    response.resultType = ActionResultType::None;
+    response.tsMs = nowMs();
+    return response;
+}
+
+} // namespace
+
+JsonRef::JsonRef(phicore::adapter::v1::JsonText text)
+{
+    if (text.empty())
+        return;
+    auto storage = std::make_shared<const std::string>(std::move(text));
+    m_text = *storage;
+    m_storage = std::move(storage);
+}
+
+JsonRef::JsonRef(const char *text)
+    : JsonRef(phicore::adapter::v1::JsonText(text ? text : ""))
+{
+}
+
+JsonRef::JsonRef(std::shared_ptr<const std::string> storage, std::string_view text) noexcept
+    : m_storage(std::move(storage))
+    , m_text(text)
+{
+}
+
+JsonRef JsonRef::member(std::string_view key) const
+{
+    std::string_view found;
+    forEachObjectMember(
+        m_text,
+        [key, &found](std::string_view name, std::string_view value, bool) {
+            if (name == key)
+                found = value;
+        },
+        nullptr);
+    if (found.empty())
+        return {};
+    return JsonRef(m_storage, found);
+}
+
+void setOutboundJsonValidation(bool enabled) noexcept
+{
+    g_outboundJsonValidation.store(enabled, std::memory_order_relaxed);
+}
+
+bool outboundJsonValidation() noexcept
+{
+    return g_outboundJsonValidation.load(std::memory_order_relaxed);
+}
+
+std::optional<TrustedJson> TrustedJson::validate(phicore::adapter::v1::JsonText text,
+                                                 phicore::adapter::v1::Utf8String *error)
+{
+    if (!isJsonValue(text)) {
+        if (error)
+            *error = "Invalid JSON value";
+        return std::nullopt;
+    }
+    return TrustedJson(std::move(text));
+}
+
+JsonWriter::JsonWriter() noexcept
+    : m_out(&m_buffer)
+{
+}
+
+JsonWriter::JsonWriter(std::string &out) noexcept
+    : m_out(&out)
+    , m_start(out.size())
+{
+}
+
+bool JsonWriter::beginValue()
+{
+    if (m_failed)
+        return false;
+    if (m_depth == 0) {
+        if (m_done) {
+            m_failed = true;
+            return false;
+        }
+        return true;
+    }
+    if ((m_objects >> (m_depth - 1)) & 1U) {
+        if (!m_expectValue) {
+            m_failed = true;
+            return false;
+        }
+        m_expectValue = false;
+        return true;
+    }
+    if (m_needComma)
+        m_out->push_back(',');
+    return true;
+}
+
+void JsonWriter::endValue() noexcept
+{
+    if (m_depth == 0)
+        m_done = true;
+    else
+        m_needComma = true;
+}
+
+JsonWriter &JsonWriter::beginObject()
+{
+    if (!beginValue())
+        return *this;
+    if (m_depth == kMaxDepth) {
+        m_failed = true;
+        return *this;
+    }
+    m_out->push_back('{');
+    m_objects |= std::uint64_t{1} << m_depth;
+    ++m_depth;
+    m_needComma = false;
+    return *this;
+}
+
+JsonWriter &JsonWriter::beginArray()
+{
+    if (!beginValue())
+        return *this;
+    if (m_depth == kMaxDepth) {
+        m_failed = true;
+        return *this;
+    }
+    m_out->push_back('[');
+    m_objects &= ~(std::uint64_t{1} << m_depth);
+    ++m_depth;
+    m_needComma = false;
+    return *this;
+}
+
+JsonWriter &JsonWriter::endContainer(bool object, char close)
+{
+    if (m_failed)
+        return *this;
+    if (m_depth == 0 || (((m_objects >> (m_depth - 1)) & 1U) != 0) != object || m_expectValue) {
+        m_failed = true;
+        return *this;
+    }
+    m_out->push_back(close);
+    --m_depth;
+    endValue();
+    return *this;
+}
+
+JsonWriter &JsonWriter::endObject() { return endContainer(true, '}'); }
+JsonWriter &JsonWriter::endArray() { return endContainer(false, ']'); }
+
+JsonWriter &JsonWriter::key(std::string_view name)
+{
+    if (m_failed)
+        return *this;
+    if (m_depth == 0 || ((m_objects >> (m_depth - 1)) & 1U) == 0 || m_expectValue) {
+        m_failed = true;
+        return *this;
+    }
+    if (m_needComma)
+        m_out->push_back(',');
+    json::appendQuoted(*m_out, name);
+    m_out->push_back(':');
+    m_expectValue = true;
+    m_needComma = false;
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(std::string_view text)
+{
+    if (beginValue()) {
+        json::appendQuoted(*m_out, text);
+        endValue();
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(bool flag)
+{
+    if (beginValue()) {
+        *m_out += flag ? "true" : "false";
+        endValue();
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(double number)
+{
+    if (beginValue()) {
+        appendDoubleJson(*m_out, number);
+        endValue();
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::value(const ScalarValue &scalar)
+{
+    if (beginValue()) {
+        appendScalarJson(*m_out, scalar);
+        endValue();
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::signedValue(std::int64_t number)
+{
+    if (beginValue()) {
+        appendInteger(*m_out, number);
+        endValue();
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::unsignedValue(std::uint64_t number)
+{
+    if (beginValue()) {
+        appendInteger(*m_out, number);
+        endValue();
+    }
+    return *this;
+}
+
+JsonWriter &JsonWriter::null()
+{
+    if (beginValue()) {
+        *m_out += "null";
+        endValue();
+    }
+    return *this;
+}
+
+std::string_view JsonWriter::view() const noexcept
+{
+    return std::string_view(*m_out).substr(m_start);
+}
+
+phicore::adapter::v1::JsonText JsonWriter::take()
+{
+    phicore::adapter::v1::JsonText text = m_out == &m_buffer ? std::move(m_buffer) : JsonText(view());
+    clear();
+    return text;
+}
+
+TrustedJson JsonWriter::takeTrusted()
+{
+    const bool valid = complete();
+    phicore::adapter::v1::JsonText text = take();
+    return valid ? TrustedJson::assumeValid(std::move(text)) : TrustedJson();
+}
+
+void JsonWriter::clear() noexcept
+{
+    m_out->resize(m_start);
+    m_objects = 0;
+    m_depth = 0;
+    m_needComma = false;
+    m_expectValue = false;
+    m_done = false;
+    m_failed = false;
+}
+
+std::span<const wire::FieldInfo> wire::payloadSchema(IpcCommand command)
+{
+    static constexpr auto bootstrap = kAdapterScopedFields<BootstrapRequest>.info();
+    static constexpr auto configChanged = kAdapterScopedFields<ConfigChangedRequest>.info();
+    static constexpr auto instanceRemoved = kInstanceRemovedFields.info();
+    static constexpr auto channelInvoke = kChannelInvokeFields.info();
+    static constexpr auto actionInvoke = kAdapterActionInvokeFields.info();
+    static constexpr auto deviceNameUpdate = kDeviceNameUpdateFields.info();
+    static constexpr auto deviceEffectInvoke = kDeviceEffectInvokeFields.info();
+    static constexpr auto sceneInvoke = kSceneInvokeFields.info();
+    static constexpr auto streamStart = kAdaptersStreamStartFields.info();
+    static constexpr auto streamStop = kAdaptersStreamStopFields.info();
+    static constexpr auto resultCmd = kCmdResponseFields.info();
+    static constexpr auto resultAction = kActionResponseFields.info();
+
+    switch (command) {
+    case IpcCommand::SyncAdapterBootstrap:
+        return bootstrap;
+    case IpcCommand::SyncAdapterConfigChanged:
+        return configChanged;
+    case IpcCommand::SyncAdapterInstanceRemoved:
+        return instanceRemoved;
+    case IpcCommand::CmdChannelInvoke:
+        return channelInvoke;
+    case IpcCommand::CmdAdapterActionInvoke:
+        return actionInvoke;
+    case IpcCommand::CmdDeviceNameUpdate:
+        return deviceNameUpdate;
+    case IpcCommand::CmdDeviceEffectInvoke:
+        return deviceEffectInvoke;
+    case IpcCommand::CmdSceneInvoke:
+        return sceneInvoke;
+    case IpcCommand::CmdAdaptersStreamStart:
+        return streamStart;
+    case IpcCommand::CmdAdaptersStreamStop:
+        return streamStop;
+    case IpcCommand::ResultCmd:
+        return resultCmd;
+    case IpcCommand::ResultAction:
+        return resultAction;
+    default:
+        return {};
+    }
+}
+
+std::span<const wire::FieldInfo> wire::recordSchema(std::string_view member)
+{
+    static constexpr auto adapter = kAdapterFields.info();
+    static constexpr auto device = kDeviceFields.info();
+    static constexpr auto channel = kChannelFields.info();
+    static constexpr auto room = kRoomFields.info();
+    static constexpr auto group = kGroupFields.info();
+    static constexpr auto scene = kSceneFields.info();
+
+    if (member == "adapter")
+        return adapter;
+    if (member == "device")
+        return device;
+    if (member == "channel")
+        return channel;
+    if (member == "room")
+        return room;
+    if (member == "group")
+        return group;
+    if (member == "scene")
+        return scene;
+    return {};
+}
+
+void wire::decodeRequest(std::string_view payloadJson, BootstrapRequest *out)
+{
+    BootstrapRequest request = decodeAdapterScopedPayload<BootstrapRequest>(payloadJson);
+    request.cmdId = out->cmdId;
+    request.correlationId = out->correlationId;
+    *out = std::move(request);
+}
+
+void wire::decodeRequest(std::string_view payloadJson, ConfigChangedRequest *out)
+{
+    ConfigChangedRequest request = decodeAdapterScopedPayload<ConfigChangedRequest>(payloadJson);
+    request.cmdId = out->cmdId;
+    request.correlationId = out->correlationId;
+    *out = std::move(request);
+}
+
+void wire::decodeRequest(std::string_view payloadJson, InstanceRemovedRequest *out)
+{
+    decodePayloadInto(kInstanceRemovedFields, payloadJson, *out);
+}
+
+void wire::decodeRequest(std::string_view payloadJson, ChannelInvokeRequest *out)
+{
+    decodePayloadInto(kChannelInvokeFields, payloadJson, *out);
+}
+
+void wire::decodeRequest(std::string_view payloadJson, AdapterActionInvokeRequest *out)
+{
+    decodePayloadInto(kAdapterActionInvokeFields, payloadJson, *out);
+}
+
+void wire::decodeRequest(std::string_view payloadJson, DeviceNameUpdateRequest *out)
+{
+    decodePayloadInto(kDeviceNameUpdateFields, payloadJson, *out);
+}
+
+void wire::decodeRequest(std::string_view payloadJson, DeviceEffectInvokeRequest *out)
 {
-    CmdResponse response;
-    response.id = cmdId;
-    response.status = CmdStatus::NotImplemented;
-    response.error = message;
-    response.tsMs = nowMs();
-    return response;
+    decodePayloadInto(kDeviceEffectInvokeFields, payloadJson, *out);
 }
 
-ActionResponse defaultActionResponse(CmdId cmdId, const std::string &message)
+void wire::decodeRequest(std::string_view payloadJson, SceneInvokeRequest *out)
 {
-    ActionResponse response;
-    response.id = cmdId;
-    response.status = CmdStatus::NotImplemented;
-    response.error = message;
-    response.resultType = ActionResultType::None;
-    response.tsMs = nowMs();
-    return response;
+    decodePayloadInto(kSceneInvokeFields, payloadJson, *out);
 }
 
-CmdResponse invalidArgumentCmdResponse(CmdId cmdId, const std::string &message)
+void wire::decodeRequest(std::string_view payloadJson, AdaptersStreamStartRequest *out)
 {
-    CmdResponse response;
-    response.id = cmdId;
-    response.status = CmdStatus::InvalidArgument;
-    response.error = message;
-    response.tsMs = nowMs();
-    return response;
+    decodePayloadInto(kAdaptersStreamStartFields, payloadJson, *out);
 }
 
-ActionResponse invalidArgumentActionResponse(CmdId cmdId, const std::string &message)
+void wire::decodeRequest(std::string_view payloadJson, AdaptersStreamStopRequest *out)
 {
-    ActionResponse response;
-    response.id = cmdId;
-    response.status = CmdStatus::InvalidArgument;
-    response.error = message;
-    response.resultType = ActionResultType::None;
-    response.tsMs = nowMs();
-    return response;
+    decodePayloadInto(kAdaptersStreamStopFields, payloadJson, *out);
 }
 
-} // namespace
+bool wire::LogTemplateExpander::expand(std::string_view payload, std::string *out, std::string *error)
+{
+    out->clear();
+    std::string_view command;
+    std::string_view body;
+    if (!forEachObjectMember(
+            payload,
+            [&](std::string_view key, std::string_view value, bool) {
+                if (key == "command")
+                    command = value;
+                else if (key == "payload")
+                    body = value;
+            },
+            error))
+        return false;
+    const std::int64_t raw = parseIntOrDefault(command, 0);
+    const bool isTemplate = raw == phicore::adapter::v1::toUint16(IpcCommand::EventLogTemplate);
+    if (!isTemplate && raw != phicore::adapter::v1::toUint16(IpcCommand::EventLogRef)) {
+        out->assign(payload);
+        return true;
+    }
+
+    std::string_view templateId, externalId, plugin, level, category, message, ctx, params, fields, tsMs;
+    const std::pair<std::string_view, std::string_view *> members[] = {
+        {"templateId", &templateId}, {"externalId", &externalId}, {"plugin", &plugin},
+        {"level", &level},           {"category", &category},     {"message", &message},
+        {"ctx", &ctx},               {"params", &params},         {"fields", &fields},
+        {"tsMs", &tsMs},
+    };
+    if (!forEachObjectMember(
+            body,
+            [&](std::string_view key, std::string_view value, bool) {
+                for (const auto &[name, target] : members) {
+                    if (key == name)
+                        *target = value;
+                }
+            },
+            error))
+        return false;
+    const auto id = static_cast<std::uint64_t>(parseIntOrDefault(templateId, 0));
+    if (isTemplate) {
+        if (id == 0 || plugin.empty() || category.empty() || message.empty() || ctx.empty()) {
+            if (error)
+                *error = "Incomplete log template";
+            return false;
+        }
+        m_templates[id] = Template{std::string(plugin), std::string(category), std::string(message), std::string(ctx)};
+        return true;
+    }
+    const auto it = m_templates.find(id);
+    if (it == m_templates.end()) {
+        if (error)
+            *error = "Unknown log template " + std::to_string(id);
+        return false;
+    }
+    if (externalId.empty() || level.empty() || params.empty() || tsMs.empty()) {
+        if (error)
+            *error = "Incomplete log ref";
+        return false;
+    }
+    const Template &logTemplate = it->second;
+    const std::pair<std::string_view, std::string_view> expanded[] = {
+        {"externalId", externalId},
+        {"plugin", logTemplate.plugin},
+        {"level", level},
+        {"category", logTemplate.category},
+        {"message", logTemplate.message},
+        {"ctx", logTemplate.ctx},
+        {"params", params},
+        {"fields", fields.empty() ? std::string_view("{}") : fields},
+        {"tsMs", tsMs},
+    };
+    bool first = true;
+    *out += EnvelopePrefix<IpcCommand::EventLog>::event;
+    for (const auto &[key, token] : expanded) {
+        appendFieldPrefix(*out, first, key);
+        *out += token;
+    }
+    *out += "}}";
+    return true;
+}
+
+struct SidecarDispatcher::RoutedRequest {
+    IpcCommand command = IpcCommand::CmdChannelInvoke;
+    CmdId cmdId = 0;
+    phicore::adapter::v1::ExternalId externalId;
+    /// Receive buffer holding the payload; shared, not copied, until the
+    /// decoded request is done with it.
+    std::shared_ptr<const std::string> buffer;
+    /// The payload object, inside `*buffer`.
+    std::string_view payload;
+
+    /**
+     * @brief Full typed decode, on whichever thread ends up running the request.
+     *
+     * Identical to the inline dispatch decode, including the `{}` default for
+     * an absent `params`.
+     */
+    template <typename Request, std::size_t N>
+    Request decode(const wire::Table<Request, N> &table) const
+    {
+        // One index per executing thread, so backends decode concurrently and
+        // each keeps its bitmap storage across requests.
+        thread_local json::StructuralIndex index;
+        index.build(payload);
+        const json::ScopedActiveIndex indexScope(index);
+        const ScopedRequestFrame frameScope(buffer);
+        Request request = decodePayload(table, payload);
+        request.cmdId = cmdId;
+        if constexpr (requires { request.paramsJson; }) {
+            if (request.paramsJson.empty())
+                request.paramsJson = "{}";
+        }
+        return request;
+    }
+};
+
+/**
+ * @brief Event record queued as data and encoded by flushSendQueue().
+ *
+ * Only frames that are actually written get encoded; frames shed from a full
+ * queue never are. The timestamp is resolved and the instance identity
+ * retained when the event is queued, so the bytes match an eager encode. The
+ * frame carries `externalId`, and `plugin`/`message` for logs.
+ */
+struct SidecarDispatcher::DeferredEvent {
+    struct ChannelState {
+        ExternalId deviceExternalId;
+        ExternalId channelExternalId;
+        ScalarValue value;
+    };
+    struct ChannelColor {
+        ExternalId deviceExternalId;
+        ExternalId channelExternalId;
+        double r = 0.0;
+        double g = 0.0;
+        double b = 0.0;
+    };
+    struct Log {
+        LogLevel level = LogLevel::Info;
+        LogCategory category = LogCategory::Internal;
+        Utf8String ctx;
+        ScalarList params;
+        phicore::adapter::v1::JsonText fieldsJson;
+    };
+
+    // Events carrying more text than this are encoded when queued, so an
+    // oversize frame is still refused to the caller instead of at flush.
+    static constexpr std::size_t kMaxDeferredTextBytes = 4096;
+
+    std::shared_ptr<const InstanceIdentity> identity;
+    std::int64_t tsMs = 0;
+    std::variant<ChannelState, ChannelColor, Log> record;
+
+    /// One frame per update, in order. Members of `Update` are moved from
+    /// unless it is const-qualified, in which case std::move() copies.
+    template <typename Update>
+    static std::vector<OutboundFrame> channelStateFrames(const ExternalId &externalId, std::span<Update> updates)
+    {
+        const std::shared_ptr<const InstanceIdentity> identity = retainedIdentity(externalId);
+        std::vector<OutboundFrame> frames(updates.size());
+        std::int64_t now = 0;
+        for (std::size_t i = 0; i < updates.size(); ++i) {
+            Update &update = updates[i];
+            std::int64_t timestamp = update.tsMs;
+            if (timestamp <= 0) {
+                if (now == 0)
+                    now = nowMs();
+                timestamp = now;
+            }
+            frames[i].externalId = externalId;
+            frames[i].deferred = std::make_shared<const DeferredEvent>(
+                DeferredEvent{identity,
+                              timestamp,
+                              ChannelState{std::move(update.deviceExternalId),
+                                           std::move(update.channelExternalId),
+                                           std::move(update.value)}});
+        }
+        return frames;
+    }
+
+    [[nodiscard]] std::size_t textBytes(const OutboundFrame &frame) const
+    {
+        const auto scalarBytes = [](const ScalarValue &value) -> std::size_t {
+            const Utf8String *text = std::get_if<Utf8String>(&value);
+            return text ? text->size() : 0;
+        };
+        std::size_t bytes = frame.externalId.size() + frame.plugin.size() + frame.message.size();
+        if (const ChannelState *state = std::get_if<ChannelState>(&record)) {
+            bytes += state->deviceExternalId.size() + state->channelExternalId.size() + scalarBytes(state->value);
+        } else if (const ChannelColor *color = std::get_if<ChannelColor>(&record)) {
+            bytes += color->deviceExternalId.size() + color->channelExternalId.size();
+        } else if (const Log *log = std::get_if<Log>(&record)) {
+            bytes += log->ctx.size() + log->fieldsJson.size();
+            for (const ScalarValue &param : log->params)
+                bytes += scalarBytes(param) + 8;
+        }
+        return bytes;
+    }
+
+    /// With `templates`, a log whose template the core has (or gets now) is
+    /// encoded as EventLogRef; a new template's EventLogTemplate frame, which
+    /// must be sent first, goes to `*registration`.
+    [[nodiscard]] std::string encode(const OutboundFrame &frame,
+                                     LogTemplateRegistry *templates = nullptr,
+                                     std::string *registration = nullptr) const
+    {
+        std::string body;
+        if (const Log *log = std::get_if<Log>(&record)) {
+            const std::uint8_t category = encodeWireCategory(log->category, frame.isIncident);
+            bool added = false;
+            const std::uint64_t templateId =
+                templates ? templates->intern(frame.plugin, category, log->ctx, frame.message, &added) : 0;
+            bool first = true;
+            if (added) {
+                openEnvelope<IpcCommand::EventLogTemplate>(*registration, first);
+                appendFieldPrefix(*registration, first, "templateId");
+                appendInteger(*registration, templateId);
+                appendFieldPrefix(*registration, first, "plugin");
+                json::appendQuoted(*registration, frame.plugin);
+                appendFieldPrefix(*registration, first, "category");
+                appendInteger(*registration, static_cast<unsigned int>(category));
+                appendFieldPrefix(*registration, first, "message");
+                json::appendQuoted(*registration, frame.message);
+                appendFieldPrefix(*registration, first, "ctx");
+                json::appendQuoted(*registration, log->ctx);
+                closeEnvelope<IpcCommand::EventLogTemplate>(*registration);
+                first = true;
+            }
+            if (templateId != 0) {
+                openEnvelope<IpcCommand::EventLogRef>(body, first);
+                if (identity) {
+                    identity->appendExternalId(body);
+                    first = false;
+                } else {
+                    appendFieldPrefix(body, first, "externalId");
+                    json::appendQuoted(body, frame.externalId);
+                }
+                appendFieldPrefix(body, first, "templateId");
+                appendInteger(body, templateId);
+                appendFieldPrefix(body, first, "level");
+                appendInteger(body, static_cast<unsigned int>(encodeWireLevel(log->level)));
+                appendFieldPrefix(body, first, "params");
+                appendScalarListJson(body, log->params);
+                // Empty fields are implied.
+                const std::size_t fieldsAt = body.size();
+                appendFieldPrefix(body, first, "fields");
+                const std::size_t valueAt = body.size();
+                appendJsonToken(body, log->fieldsJson, "{}");
+                if (std::string_view(body).substr(valueAt) == "{}")
+                    body.resize(fieldsAt);
+                appendFieldPrefix(body, first, "tsMs");
+                appendInteger(body, tsMs);
+                closeEnvelope<IpcCommand::EventLogRef>(body);
+                return body;
+            }
+            openEnvelope<IpcCommand::EventLog>(body, first);
+            appendLogIdentity(body, first, identity.get(), frame.externalId, frame.plugin);
+            appendFieldPrefix(body, first, "level");
+            appendInteger(body, static_cast<unsigned int>(encodeWireLevel(log->level)));
+            appendFieldPrefix(body, first, "category");
+            appendInteger(body, static_cast<unsigned int>(category));
+            appendFieldPrefix(body, first, "message");
+            json::appendQuoted(body, frame.message);
+            appendFieldPrefix(body, first, "ctx");
+            json::appendQuoted(body, log->ctx);
+            appendFieldPrefix(body, first, "params");
+            appendScalarListJson(body, log->params);
+            appendFieldPrefix(body, first, "fields");
+            appendJsonToken(body, log->fieldsJson, "{}");
+            appendFieldPrefix(body, first, "tsMs");
+            appendInteger(body, tsMs);
+            closeEnvelope<IpcCommand::EventLog>(body);
+            return body;
+        }
+        const ChannelStateHeads heads(frame.externalId, identity.get());
+        if (const ChannelState *state = std::get_if<ChannelState>(&record)) {
+            heads.open(body, state->deviceExternalId, state->channelExternalId);
+            appendScalarJson(body, state->value);
+        } else if (const ChannelColor *color = std::get_if<ChannelColor>(&record)) {
+            heads.open(body, color->deviceExternalId, color->channelExternalId);
+            body += "{\"r\":";
+            appendDoubleJson(body, color->r);
+            body += ",\"g\":";
+            appendDoubleJson(body, color->g);
+            body += ",\"b\":";
+            appendDoubleJson(body, color->b);
+            body += "}";
+        }
+        body += ",\"tsMs\":";
+        appendInteger(body, tsMs);
+        closeEnvelope<IpcCommand::EventChannelStateUpdated>(body);
+        return body;
+    }
+};
+
+/**
+ * @brief Bounded ring of log frames written by one thread.
+ *
+ * Owned by one producing thread (see threadLogRing()) and drained by the
+ * flushing thread under logRingsMutex, so `sendLog` never touches the send
+ * queue lock; the ring's own lock is only contended by that drain. Storage
+ * grows with the thread's backlog up to kLogRingCapacity frames and is kept
+ * for reuse. Slots only save the frame's own allocation; each log still
+ * allocates its DeferredEvent and copies of plugin and externalId. A full
+ * ring overwrites its oldest frame instead of blocking.
+ */
+struct SidecarDispatcher::LogRing {
+    /// Producer side. False when the oldest frame was overwritten.
+    bool push(OutboundFrame &&frame)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count < slots.size()) {
+            slots[(begin + count) % slots.size()] = std::move(frame);
+            ++count;
+            return true;
+        }
+        if (slots.size() < kLogRingCapacity) {
+            // Only a full ring wraps, and draining rewinds it; `begin` is 0.
+            slots.push_back(std::move(frame));
+            ++count;
+            return true;
+        }
+        slots[begin] = std::move(frame);
+        begin = (begin + 1) % slots.size();
+        return false;
+    }
+
+    /// Consumer side; returns the number of frames handed to `sink`.
+    template <typename Sink>
+    std::size_t drain(Sink &&sink)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::size_t drained = count;
+        for (std::size_t i = 0; i < drained; ++i)
+            sink(std::move(slots[(begin + i) % slots.size()]));
+        begin = 0;
+        count = 0;
+        return drained;
+    }
+
+    std::mutex mutex;
+    std::vector<OutboundFrame> slots;
+    std::size_t begin = 0;
+    std::size_t count = 0;
+    /// Set when the producing thread exits or moves to another dispatcher;
+    /// the ring is dropped once drained.
+    std::atomic_bool retired{false};
+};
 
 struct SidecarDispatcher::Impl {
     explicit Impl(phicore::adapter::v1::Utf8String socketPath)
@@ -1762,6 +4802,44 @@ struct SidecarDispatcher::Impl {
     std::int64_t lastQueueOverflowTsMs = 0;
     // Thread currently inside pollOnce(), to detect re-entry from a handler.
     std::atomic<std::thread::id> pollingThread{};
+    // Structural index of the frame being dispatched; kept here so its bitmap
+    // storage is reused across frames. Poll thread only.
+    json::StructuralIndex inboundIndex;
+    ChannelInvokeRequest channelInvokeScratch;
+    RequestRouter requestRouter;
+    // Guards sentTopology, topologyGeneration and topologyStats. Never held
+    // while frames are queued.
+    mutable std::mutex topologyMutex;
+    SentTopology sentTopology;
+    std::uint64_t topologyGeneration = 0;
+    // Bumped whenever entries are dropped, so a send that found none can tell
+    // a removal happened while it was queueing.
+    std::uint64_t topologyForgets = 0;
+    TopologyCacheStats topologyStats;
+    // Log rings of the threads that logged through this dispatcher. The mutex
+    // guards the list and serializes draining; producers only take it once,
+    // to register.
+    inline static std::atomic<std::uint64_t> nextSerial{1};
+    const std::uint64_t serial = nextSerial.fetch_add(1, std::memory_order_relaxed);
+    std::mutex logRingsMutex;
+    std::vector<std::shared_ptr<LogRing>> logRings;
+    std::atomic_bool logRingsPending{false};
+    std::atomic<std::uint64_t> nextFrameSeq{1};
+    std::atomic<std::uint64_t> droppedLogFrames{0};
+    // Frames waiting in the rings; they count against kHostQueueMaxDepth.
+    std::atomic<std::size_t> logRingDepth{0};
+    std::uint64_t reportedLogFrameDrops = 0;
+    std::int64_t lastLogRingOverflowTsMs = 0;
+    // Interned logs, once the core announced them in bootstrap. Both reset
+    // with the session; the mutex is held while a log frame is encoded.
+    std::atomic_bool logTemplatesAccepted{false};
+    std::mutex logTemplatesMutex;
+    LogTemplateRegistry logTemplates;
+    // Adaptive log throttle: 0 = off, 1 = Trace dropped, 2 = Debug too.
+    // Changes under hostDiagMutex; calmSinceMs is when the backlog last fell
+    // below the relax threshold (0 = it is not).
+    std::atomic<int> logThrottleStage{0};
+    std::int64_t logThrottleCalmSinceMs = 0;
 };
 
 #define m_runtime m_impl->runtime
@@ -1778,24 +4856,70 @@ struct SidecarDispatcher::Impl {
 #define m_droppedOutboundFrames m_impl->droppedOutboundFrames
 #define m_lastQueueOverflowTsMs m_impl->lastQueueOverflowTsMs
 #define m_pollingThread m_impl->pollingThread
+#define m_inboundIndex m_impl->inboundIndex
+#define m_channelInvokeScratch m_impl->channelInvokeScratch
+#define m_requestRouter m_impl->requestRouter
+#define m_topologyMutex m_impl->topologyMutex
+#define m_sentTopology m_impl->sentTopology
+#define m_topologyGeneration m_impl->topologyGeneration
+#define m_topologyForgets m_impl->topologyForgets
+#define m_topologyStats m_impl->topologyStats
+#define m_serial m_impl->serial
+#define m_logRingsMutex m_impl->logRingsMutex
+#define m_logRings m_impl->logRings
+#define m_logRingsPending m_impl->logRingsPending
+#define m_nextFrameSeq m_impl->nextFrameSeq
+#define m_droppedLogFrames m_impl->droppedLogFrames
+#define m_logRingDepth m_impl->logRingDepth
+#define m_reportedLogFrameDrops m_impl->reportedLogFrameDrops
+#define m_lastLogRingOverflowTsMs m_impl->lastLogRingOverflowTsMs
+#define m_logTemplatesAccepted m_impl->logTemplatesAccepted
+#define m_logTemplatesMutex m_impl->logTemplatesMutex
+#define m_logTemplates m_impl->logTemplates
+#define m_logThrottleStage m_impl->logThrottleStage
+#define m_logThrottleCalmSinceMs m_impl->logThrottleCalmSinceMs
 
 SidecarDispatcher::SidecarDispatcher(phicore::adapter::v1::Utf8String socketPath)
     : m_impl(std::make_unique<Impl>(std::move(socketPath)))
 {
     RuntimeCallbacks callbacks;
+    // A new core session starts from an empty topology, and frames queued for
+    // the old one are dropped: either way the cache no longer says what the
+    // core has.
     callbacks.onConnected = [this]() {
+        {
+            std::lock_guard<std::mutex> lock(m_topologyMutex);
+            m_sentTopology.clear();
+            ++m_topologyForgets;
+        }
+        m_logTemplatesAccepted.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(m_logTemplatesMutex);
+            m_logTemplates.clear();
+        }
         if (m_handlers.onConnected)
             m_handlers.onConnected();
     };
     callbacks.onDisconnected = [this]() {
+        {
+            std::lock_guard<std::mutex> lock(m_topologyMutex);
+            m_sentTopology.clear();
+            ++m_topologyForgets;
+        }
+        m_logTemplatesAccepted.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(m_logTemplatesMutex);
+            m_logTemplates.clear();
+        }
         if (m_handlers.onDisconnected)
             m_handlers.onDisconnected();
     };
     callbacks.onFrame = [this](const phicore::adapter::v1::FrameHeader &header,
-                               std::span<const std::byte> payload) {
+                               std::span<const std::byte> payload,
+                               const std::shared_ptr<const std::string> &buffer) {
         if (phicore::adapter::v1::messageType(header) != MessageType::Request)
             return;
-        handleRequestFrame(header, payload);
+        handleRequestFrame(header, payload, buffer);
     };
     m_runtime->setCallbacks(std::move(callbacks));
 }
@@ -1807,6 +4931,11 @@ void SidecarDispatcher::setHandlers(SidecarHandlers handlers)
     m_handlers = std::move(handlers);
 }
 
+void SidecarDispatcher::setRequestRouter(RequestRouter router)
+{
+    m_requestRouter = std::move(router);
+}
+
 bool SidecarDispatcher::start(phicore::adapter::v1::Utf8String *error)
 {
     {
@@ -1825,6 +4954,11 @@ void SidecarDispatcher::stop()
         std::lock_guard<std::mutex> lock(m_sendQueueMutex);
         m_sendQueue.clear();
     }
+    {
+        std::lock_guard<std::mutex> lock(m_logRingsMutex);
+        for (const std::shared_ptr<LogRing> &ring : m_logRings)
+            ring->drain([](OutboundFrame &&) {});
+    }
     // Release a poll thread that is blocked inside epoll_wait so the runtime
     // mutex becomes available without waiting out the poll timeout.
     m_runtime->wakeup();
@@ -1873,6 +5007,7 @@ bool SidecarDispatcher::pollOnce(std::chrono::milliseconds timeout, phicore::ada
         ~PollingScope() { slot.store(std::thread::id{}, std::memory_order_release); }
     } pollingScope(m_pollingThread, self);
 
+    SidecarClock::refresh();
     flushSendQueue(nullptr);
     bool ok = false;
     {
@@ -1884,20 +5019,25 @@ bool SidecarDispatcher::pollOnce(std::chrono::milliseconds timeout, phicore::ada
 }
 
 bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHeader &header,
-                                           std::span<const std::byte> payload)
-{
-    const std::string jsonPayload(reinterpret_cast<const char *>(payload.data()), payload.size());
-    MemberMap root;
+                                           std::span<const std::byte> payload,
+                                           const std::shared_ptr<const std::string> &buffer)
+{
+    // Decoded in place: every member is a view into the receive buffer, which
+    // stays valid for the whole dispatch. Request structs copy out only the
+    // fields they keep.
+    const std::string_view jsonPayload(reinterpret_cast<const char *>(payload.data()), payload.size());
+    m_inboundIndex.build(jsonPayload);
+    const json::ScopedActiveIndex indexScope(m_inboundIndex);
+    RequestEnvelope envelope;
     std::string parseError;
-    if (!parseObjectMembers(jsonPayload, &root, &parseError)) {
+    if (!decodeObject(kRequestEnvelopeFields, jsonPayload, envelope, &parseError)) {
         if (m_handlers.onProtocolError)
             m_handlers.onProtocolError("Invalid request JSON: " + parseError);
         return false;
     }
 
     IpcCommand command = IpcCommand::SyncAdapterBootstrap;
-    const std::string_view commandToken = member(root, "command");
-    if (!parseIpcCommandToken(commandToken, &command)) {
+    if (!parseIpcCommandToken(envelope.command, &command)) {
         if (m_handlers.onProtocolError)
             m_handlers.onProtocolError("Request missing/invalid command");
         return false;
@@ -1911,59 +5051,45 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
     }
 
     CmdId cmdId = 0;
-    const std::string_view cmdIdToken = member(root, "cmdId");
-    if (!cmdIdToken.empty()) {
-        if (!parseCmdIdToken(cmdIdToken, &cmdId))
+    if (!envelope.cmdId.empty()) {
+        if (!parseCmdIdToken(envelope.cmdId, &cmdId))
             cmdId = header.correlationId;
     } else {
         cmdId = header.correlationId;
     }
 
-    std::string_view payloadToken = member(root, "payload");
-    if (payloadToken.empty())
-        payloadToken = "{}";
-
-    MemberMap payloadMap;
-    if (!parseObjectMembers(payloadToken, &payloadMap, nullptr))
-        payloadMap.clear();
-
-    auto parseAdapterFromMap = [](const MemberMap &adapterMap) {
-        phicore::adapter::v1::Adapter adapter;
-        adapter.name = decodeStringOrDefault(member(adapterMap, "name"));
-        adapter.host = decodeStringOrDefault(member(adapterMap, "host"));
-        adapter.ip = decodeStringOrDefault(member(adapterMap, "ip"));
-        adapter.port =
-            static_cast<std::uint16_t>(parseIntOrDefault(member(adapterMap, "port"), 0));
-        adapter.user = decodeStringOrDefault(member(adapterMap, "user"));
-        adapter.password = decodeStringOrDefault(member(adapterMap, "password"));
-        adapter.token = decodeStringOrDefault(member(adapterMap, "token"));
-        adapter.pluginType = decodeStringOrDefault(member(adapterMap, "pluginType"));
-        adapter.externalId = decodeStringOrDefault(member(adapterMap, "externalId"));
-        adapter.metaJson = std::string(member(adapterMap, "meta"));
-        adapter.flags = static_cast<phicore::adapter::v1::AdapterFlag>(
-            parseIntOrDefault(member(adapterMap, "flags"), 0));
-        return adapter;
-    };
+    std::string_view payloadToken = envelope.payload.empty() ? std::string_view("{}") : envelope.payload;
+
+    // Routing parse only: the target instance's backend does the typed decode,
+    // so decoding runs in parallel across instances instead of on this thread.
+    // Unknown instances and empty externalIds fall through to the inline path,
+    // which produces the usual error results.
+    if (m_requestRouter && isInstanceRoutable(command)) {
+        RequestRoute route;
+        if (decodeObject(kRequestRouteFields, payloadToken, route) && !route.externalId.empty()) {
+            RoutedRequest routed;
+            routed.command = command;
+            routed.cmdId = cmdId;
+            routed.externalId = std::move(route.externalId);
+            routed.buffer = buffer;
+            routed.payload = payloadToken;
+            if (m_requestRouter(routed))
+                return true;
+        }
+    }
+
+    // Nested JSON members (params, static config) are JsonRefs sharing the
+    // receive buffer, so handing a request to an execution backend keeps the
+    // bytes alive without copying them. The transport moves on to fresh
+    // storage while a buffer is shared.
+    const ScopedRequestFrame frameScope(buffer);
 
     if (command == IpcCommand::SyncAdapterBootstrap) {
+        BootstrapRequest request = decodeAdapterScopedPayload<BootstrapRequest>(payloadToken);
+        m_logTemplatesAccepted.store(request.logTemplates, std::memory_order_relaxed);
         if (m_handlers.onBootstrap) {
-            BootstrapRequest request;
             request.cmdId = cmdId;
             request.correlationId = header.correlationId;
-            request.adapterId = static_cast<int>(parseIntOrDefault(member(payloadMap, "adapterId"), 0));
-            request.staticConfigJson = std::string(member(payloadMap, "staticConfig"));
-            request.adapter.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-            request.adapter.pluginType = decodeStringOrDefault(member(payloadMap, "pluginType"));
-
-            MemberMap adapterMap;
-            const std::string_view adapterToken = member(payloadMap, "adapter");
-            if (parseObjectMembers(adapterToken, &adapterMap, nullptr)) {
-                request.adapter = parseAdapterFromMap(adapterMap);
-            }
-            if (request.adapter.pluginType.empty())
-                request.adapter.pluginType = decodeStringOrDefault(member(payloadMap, "pluginType"));
-            if (request.adapter.externalId.empty())
-                request.adapter.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
             m_handlers.onBootstrap(request);
         }
         return true;
@@ -1971,21 +5097,9 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
 
     if (command == IpcCommand::SyncAdapterConfigChanged) {
         if (m_handlers.onConfigChanged) {
-            ConfigChangedRequest request;
+            ConfigChangedRequest request = decodeAdapterScopedPayload<ConfigChangedRequest>(payloadToken);
             request.cmdId = cmdId;
             request.correlationId = header.correlationId;
-            request.adapterId = static_cast<int>(parseIntOrDefault(member(payloadMap, "adapterId"), 0));
-            request.staticConfigJson = std::string(member(payloadMap, "staticConfig"));
-            request.adapter.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-            request.adapter.pluginType = decodeStringOrDefault(member(payloadMap, "pluginType"));
-
-            MemberMap adapterMap;
-            if (parseObjectMembers(member(payloadMap, "adapter"), &adapterMap, nullptr))
-                request.adapter = parseAdapterFromMap(adapterMap);
-            if (request.adapter.pluginType.empty())
-                request.adapter.pluginType = decodeStringOrDefault(member(payloadMap, "pluginType"));
-            if (request.adapter.externalId.empty())
-                request.adapter.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
             m_handlers.onConfigChanged(request);
         }
         return true;
@@ -1993,26 +5107,20 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
 
     if (command == IpcCommand::SyncAdapterInstanceRemoved) {
         if (m_handlers.onInstanceRemoved) {
-            InstanceRemovedRequest request;
+            InstanceRemovedRequest request = decodePayload(kInstanceRemovedFields, payloadToken);
             request.cmdId = cmdId;
             request.correlationId = header.correlationId;
-            request.adapterId = static_cast<int>(parseIntOrDefault(member(payloadMap, "adapterId"), 0));
-            request.pluginType = decodeStringOrDefault(member(payloadMap, "pluginType"));
-            request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
             m_handlers.onInstanceRemoved(request);
         }
         return true;
     }
 
     if (command == IpcCommand::CmdChannelInvoke) {
-        ChannelInvokeRequest request;
+        // The hot command: decoded into a retained request so instance and
+        // device IDs that repeat frame after frame reuse their storage.
+        ChannelInvokeRequest &request = m_channelInvokeScratch;
+        decodePayloadInto(kChannelInvokeFields, payloadToken, request);
         request.cmdId = cmdId;
-        request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-        request.deviceExternalId = decodeStringOrDefault(member(payloadMap, "deviceExternalId"));
-        request.channelExternalId = decodeStringOrDefault(member(payloadMap, "channelExternalId"));
-        const std::string_view valueToken = member(payloadMap, "value");
-        request.valueJson = std::string(valueToken);
-        request.hasScalarValue = parseScalarValueToken(valueToken, &request.value);
 
         if (m_handlers.onChannelInvoke) {
             m_handlers.onChannelInvoke(request);
@@ -2023,12 +5131,9 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
     }
 
     if (command == IpcCommand::CmdAdapterActionInvoke) {
-        AdapterActionInvokeRequest request;
+        AdapterActionInvokeRequest request = decodePayload(kAdapterActionInvokeFields, payloadToken);
         request.cmdId = cmdId;
-        request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-        request.actionId = decodeStringOrDefault(member(payloadMap, "actionId"));
-        request.paramsJson = std::string(member(payloadMap, "params"));
-        if (trim(request.paramsJson).empty())
+        if (request.paramsJson.empty())
             request.paramsJson = "{}";
 
         if (m_handlers.onAdapterActionInvoke) {
@@ -2040,11 +5145,8 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
     }
 
     if (command == IpcCommand::CmdDeviceNameUpdate) {
-        DeviceNameUpdateRequest request;
+        DeviceNameUpdateRequest request = decodePayload(kDeviceNameUpdateFields, payloadToken);
         request.cmdId = cmdId;
-        request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-        request.deviceExternalId = decodeStringOrDefault(member(payloadMap, "deviceExternalId"));
-        request.name = decodeStringOrDefault(member(payloadMap, "name"));
 
         if (m_handlers.onDeviceNameUpdate) {
             m_handlers.onDeviceNameUpdate(request);
@@ -2055,14 +5157,9 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
     }
 
     if (command == IpcCommand::CmdDeviceEffectInvoke) {
-        DeviceEffectInvokeRequest request;
+        DeviceEffectInvokeRequest request = decodePayload(kDeviceEffectInvokeFields, payloadToken);
         request.cmdId = cmdId;
-        request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-        request.deviceExternalId = decodeStringOrDefault(member(payloadMap, "deviceExternalId"));
-        request.effect = static_cast<DeviceEffect>(parseIntOrDefault(member(payloadMap, "effect"), 0));
-        request.effectId = decodeStringOrDefault(member(payloadMap, "effectId"));
-        request.paramsJson = std::string(member(payloadMap, "params"));
-        if (trim(request.paramsJson).empty())
+        if (request.paramsJson.empty())
             request.paramsJson = "{}";
 
         if (m_handlers.onDeviceEffectInvoke) {
@@ -2074,12 +5171,8 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
     }
 
     if (command == IpcCommand::CmdSceneInvoke) {
-        SceneInvokeRequest request;
+        SceneInvokeRequest request = decodePayload(kSceneInvokeFields, payloadToken);
         request.cmdId = cmdId;
-        request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-        request.sceneExternalId = decodeStringOrDefault(member(payloadMap, "sceneExternalId"));
-        request.groupExternalId = decodeStringOrDefault(member(payloadMap, "groupExternalId"));
-        request.action = decodeStringOrDefault(member(payloadMap, "action"));
 
         if (m_handlers.onSceneInvoke) {
             m_handlers.onSceneInvoke(request);
@@ -2090,13 +5183,9 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
     }
 
     if (command == IpcCommand::CmdAdaptersStreamStart) {
-        AdaptersStreamStartRequest request;
+        AdaptersStreamStartRequest request = decodePayload(kAdaptersStreamStartFields, payloadToken);
         request.cmdId = cmdId;
-        request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-        request.streamId = decodeStringOrDefault(member(payloadMap, "streamId"));
-        request.kind = decodeStringOrDefault(member(payloadMap, "kind"));
-        request.paramsJson = std::string(member(payloadMap, "params"));
-        if (trim(request.paramsJson).empty())
+        if (request.paramsJson.empty())
             request.paramsJson = "{}";
 
         if (m_handlers.onAdaptersStreamStart) {
@@ -2108,10 +5197,8 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
     }
 
     if (command == IpcCommand::CmdAdaptersStreamStop) {
-        AdaptersStreamStopRequest request;
+        AdaptersStreamStopRequest request = decodePayload(kAdaptersStreamStopFields, payloadToken);
         request.cmdId = cmdId;
-        request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
-        request.streamId = decodeStringOrDefault(member(payloadMap, "streamId"));
 
         if (m_handlers.onAdaptersStreamStop) {
             m_handlers.onAdaptersStreamStop(request);
@@ -2122,9 +5209,8 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
     }
 
     if (m_handlers.onUnknownRequest) {
-        UnknownRequest request;
+        UnknownRequest request = decodePayload(kUnknownRequestFields, payloadToken);
         request.cmdId = cmdId;
-        request.externalId = decodeStringOrDefault(member(payloadMap, "externalId"));
         request.command = phicore::adapter::v1::toUint16(command);
         request.payloadJson = std::string(payloadToken);
         m_handlers.onUnknownRequest(request);
@@ -2139,24 +5225,29 @@ bool SidecarDispatcher::handleRequestFrame(const phicore::adapter::v1::FrameHead
 
 bool SidecarDispatcher::sendJson(MessageType type,
                                  CorrelationId correlationId,
-                                 std::string_view json,
+                                 std::string json,
                                  phicore::adapter::v1::Utf8String *error)
 {
     OutboundFrame frame;
     frame.type = type;
     frame.correlationId = correlationId;
-    frame.payload.assign(json.data(), json.size());
+    frame.payload = std::move(json);
     return queueOutboundFrame(std::move(frame), error);
 }
 
 bool SidecarDispatcher::queueOutboundFrame(OutboundFrame frame, phicore::adapter::v1::Utf8String *error)
 {
-    if (!m_started.load(std::memory_order_acquire)) {
+    return queueOutboundFrames(std::span<OutboundFrame>(&frame, 1), error);
+}
+
+bool SidecarDispatcher::queueOutboundFrames(std::span<OutboundFrame> frames, phicore::adapter::v1::Utf8String *error)
+{
+    const auto refuse = [&](const OutboundFrame &frame, const std::string &reason) {
         if (error)
-            *error = "dispatcher not started";
+            *error = reason;
         if (frame.isIncident) {
             hostStderrLine("[sidecar][incidentSendFailure][host] plugin=" + frame.plugin + " externalId="
-                           + frame.externalId + " reason=dispatcher not started message="
+                           + frame.externalId + " reason=" + reason + " message="
                            + jsonQuoted(shortened(frame.message)));
         } else if (frame.isLogFrame) {
             const std::int64_t tsMs = nowMs();
@@ -2166,87 +5257,101 @@ bool SidecarDispatcher::queueOutboundFrame(OutboundFrame frame, phicore::adapter
                 m_lastLogSendFailureTsMs = tsMs;
                 m_suppressedLogSendFailures = 0;
                 hostStderrLine("[sidecar][logSendFailure][host] plugin=" + frame.plugin + " externalId="
-                               + frame.externalId + " reason=dispatcher not started suppressed="
+                               + frame.externalId + " reason=" + reason + " suppressed="
                                + std::to_string(suppressed) + " message="
                                + jsonQuoted(shortened(frame.message)));
             } else {
                 ++m_suppressedLogSendFailures;
             }
         }
+    };
+
+    if (!m_started.load(std::memory_order_acquire)) {
+        for (const OutboundFrame &frame : frames)
+            refuse(frame, "dispatcher not started");
         return false;
     }
-    if (frame.payload.empty()) {
-        if (error)
-            *error = "outbound payload must not be empty";
-        if (frame.isIncident) {
-            hostStderrLine("[sidecar][incidentSendFailure][host] plugin=" + frame.plugin + " externalId="
-                           + frame.externalId + " reason=outbound payload must not be empty message="
-                           + jsonQuoted(shortened(frame.message)));
-        } else if (frame.isLogFrame) {
-            const std::int64_t tsMs = nowMs();
-            std::lock_guard<std::mutex> diagLock(m_hostDiagMutex);
-            if (tsMs - m_lastLogSendFailureTsMs >= kHostDiagRateLimitMs) {
-                const std::uint64_t suppressed = m_suppressedLogSendFailures;
-                m_lastLogSendFailureTsMs = tsMs;
-                m_suppressedLogSendFailures = 0;
-                hostStderrLine("[sidecar][logSendFailure][host] plugin=" + frame.plugin + " externalId="
-                               + frame.externalId + " reason=outbound payload must not be empty suppressed="
-                               + std::to_string(suppressed) + " message="
-                               + jsonQuoted(shortened(frame.message)));
-            } else {
-                ++m_suppressedLogSendFailures;
-            }
+    // Refused frames are reported and skipped; the rest keep their order.
+    bool allQueued = true;
+    std::size_t admitted = 0;
+    for (OutboundFrame &frame : frames) {
+        if (frame.deferred && frame.deferred->textBytes(frame) > DeferredEvent::kMaxDeferredTextBytes) {
+            frame.payload = frame.deferred->encode(frame);
+            frame.deferred.reset();
         }
-        return false;
+        if (frame.payload.empty() && !frame.deferred) {
+            refuse(frame, "outbound payload must not be empty");
+            allQueued = false;
+            continue;
+        }
+        if (frame.payload.size() > phicore::adapter::v1::kMaxPayloadSize) {
+            // The receiving core treats an oversized frame as a protocol violation
+            // and kills the connection; refuse at the source with a real error.
+            if (error)
+                *error = "outbound payload exceeds kMaxPayloadSize ("
+                    + std::to_string(frame.payload.size()) + " > "
+                    + std::to_string(phicore::adapter::v1::kMaxPayloadSize) + " bytes)";
+            hostStderrLine("[sidecar][oversizeFrameRejected][host] plugin=" + frame.plugin + " externalId="
+                           + frame.externalId + " payloadBytes=" + std::to_string(frame.payload.size())
+                           + " limit=" + std::to_string(phicore::adapter::v1::kMaxPayloadSize)
+                           + " message=" + jsonQuoted(shortened(frame.message)));
+            allQueued = false;
+            continue;
+        }
+        if (&frame != &frames[admitted])
+            frames[admitted] = std::move(frame);
+        ++admitted;
     }
-    if (frame.payload.size() > phicore::adapter::v1::kMaxPayloadSize) {
-        // The receiving core treats an oversized frame as a protocol violation
-        // and kills the connection; refuse at the source with a real error.
-        if (error)
-            *error = "outbound payload exceeds kMaxPayloadSize ("
-                + std::to_string(frame.payload.size()) + " > "
-                + std::to_string(phicore::adapter::v1::kMaxPayloadSize) + " bytes)";
-        hostStderrLine("[sidecar][oversizeFrameRejected][host] plugin=" + frame.plugin + " externalId="
-                       + frame.externalId + " payloadBytes=" + std::to_string(frame.payload.size())
-                       + " limit=" + std::to_string(phicore::adapter::v1::kMaxPayloadSize)
-                       + " message=" + jsonQuoted(shortened(frame.message)));
+    if (admitted == 0)
         return false;
-    }
+
     bool rejected = false;
+    std::size_t queued = 0;
     std::size_t queueDepth = 0;
     std::size_t maxObservedDepth = 0;
     std::uint64_t droppedTotal = 0;
     {
         std::lock_guard<std::mutex> lock(m_sendQueueMutex);
-        if (m_sendQueue.size() >= kHostQueueMaxDepth) {
-            // Shed the oldest log frame first, then the oldest event frame.
-            // Response frames (Result*/descriptor) are never shed and may
-            // exceed the cap; core bounds them via its pending commands.
-            auto shedIt = std::find_if(m_sendQueue.begin(), m_sendQueue.end(), [](const OutboundFrame &queued) {
-                return queued.isLogFrame;
-            });
-            if (shedIt == m_sendQueue.end()) {
-                shedIt = std::find_if(m_sendQueue.begin(), m_sendQueue.end(), [](const OutboundFrame &queued) {
-                    return queued.type == MessageType::Event;
+        for (OutboundFrame &frame : frames.first(admitted)) {
+            // Logs still in the rings count against the cap; while the queue
+            // itself has room they are what the next flush sheds first.
+            const std::size_t ringDepth = m_logRingDepth.load(std::memory_order_relaxed);
+            if (m_sendQueue.size() + ringDepth >= kHostQueueMaxDepth) {
+                // Shed the oldest log frame first, then the oldest event frame.
+                // Response frames (Result*/descriptor) are never shed and may
+                // exceed the cap; core bounds them via its pending commands.
+                // Incidents (sendError) are never shed either.
+                auto shedIt = std::find_if(m_sendQueue.begin(), m_sendQueue.end(), [](const OutboundFrame &queued) {
+                    return queued.isLogFrame && !queued.isIncident;
                 });
+                // With no log queued, a ring log is shed at the next flush
+                // instead, unless the queue itself is full.
+                const bool queueFull = m_sendQueue.size() >= kHostQueueMaxDepth;
+                if (shedIt == m_sendQueue.end() && queueFull) {
+                    shedIt = std::find_if(m_sendQueue.begin(), m_sendQueue.end(), [](const OutboundFrame &queued) {
+                        return queued.type == MessageType::Event && !queued.isIncident;
+                    });
+                }
+                if (shedIt != m_sendQueue.end()) {
+                    m_sendQueue.erase(shedIt);
+                    droppedTotal = m_droppedOutboundFrames.fetch_add(1, std::memory_order_relaxed) + 1;
+                } else if (queueFull && frame.type == MessageType::Event) {
+                    // Queue is saturated with response frames; reject the new event frame.
+                    droppedTotal = m_droppedOutboundFrames.fetch_add(1, std::memory_order_relaxed) + 1;
+                    rejected = true;
+                    continue;
+                }
             }
-            if (shedIt != m_sendQueue.end()) {
-                m_sendQueue.erase(shedIt);
-                droppedTotal = m_droppedOutboundFrames.fetch_add(1, std::memory_order_relaxed) + 1;
-            } else if (frame.type == MessageType::Event) {
-                // Queue is saturated with response frames; reject the new event frame.
-                droppedTotal = m_droppedOutboundFrames.fetch_add(1, std::memory_order_relaxed) + 1;
-                rejected = true;
-            }
-        }
-        if (!rejected) {
+            frame.seq = m_nextFrameSeq.fetch_add(1, std::memory_order_relaxed);
             m_sendQueue.push_back(std::move(frame));
-            queueDepth = m_sendQueue.size();
-            if (queueDepth > m_maxObservedQueueDepth)
-                m_maxObservedQueueDepth = queueDepth;
+            ++queued;
         }
+        queueDepth = m_sendQueue.size();
+        if (queueDepth > m_maxObservedQueueDepth)
+            m_maxObservedQueueDepth = queueDepth;
         maxObservedDepth = m_maxObservedQueueDepth;
     }
+    updateLogThrottle(queueDepth, false);
 
     if (droppedTotal > 0) {
         const std::int64_t tsMs = nowMs();
@@ -2260,7 +5365,9 @@ bool SidecarDispatcher::queueOutboundFrame(OutboundFrame frame, phicore::adapter
     if (rejected) {
         if (error)
             *error = "outbound send queue full";
-        return false;
+        allQueued = false;
+        if (queued == 0)
+            return false;
     }
 
     if (queueDepth >= kHostQueueWarnThreshold) {
@@ -2278,32 +5385,180 @@ bool SidecarDispatcher::queueOutboundFrame(OutboundFrame frame, phicore::adapter
     // Wake a poll thread blocked in epoll_wait so the frame is flushed
     // promptly instead of after the poll timeout.
     m_runtime->wakeup();
+    return allQueued;
+}
+
+bool SidecarDispatcher::queueLogFrame(OutboundFrame frame, phicore::adapter::v1::Utf8String *error)
+{
+    // Refusals (not started, oversize) keep their synchronous error through
+    // the queue path.
+    if (!m_started.load(std::memory_order_acquire)
+        || frame.deferred->textBytes(frame) > DeferredEvent::kMaxDeferredTextBytes)
+        return queueOutboundFrame(std::move(frame), error);
+    LogRing &ring = threadLogRing();
+    frame.seq = m_nextFrameSeq.fetch_add(1, std::memory_order_relaxed);
+    if (ring.push(std::move(frame))) {
+        m_logRingDepth.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // The thread's oldest pending log made room, as on the send queue.
+        m_droppedOutboundFrames.fetch_add(1, std::memory_order_relaxed);
+        m_droppedLogFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    // One wakeup per flush, not per log.
+    if (!m_logRingsPending.exchange(true, std::memory_order_acq_rel))
+        m_runtime->wakeup();
     return true;
 }
 
+SidecarDispatcher::LogRing &SidecarDispatcher::threadLogRing()
+{
+    // Caches the ring of the dispatcher this thread logged to last; the
+    // serial (not the address) identifies it, so a dispatcher created at a
+    // freed address never inherits a stale ring.
+    struct Slot {
+        std::uint64_t serial = 0;
+        std::shared_ptr<LogRing> ring;
+        ~Slot()
+        {
+            if (ring)
+                ring->retired.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Slot slot;
+    if (slot.ring && slot.serial == m_serial)
+        return *slot.ring;
+    if (slot.ring)
+        slot.ring->retired.store(true, std::memory_order_release);
+    auto ring = std::make_shared<LogRing>();
+    {
+        std::lock_guard<std::mutex> lock(m_logRingsMutex);
+        m_logRings.push_back(ring);
+    }
+    slot.serial = m_serial;
+    slot.ring = std::move(ring);
+    return *slot.ring;
+}
+
+void SidecarDispatcher::drainLogRings(std::deque<OutboundFrame> *queue)
+{
+    if (!m_logRingsPending.exchange(false, std::memory_order_acq_rel))
+        return;
+    std::vector<OutboundFrame> logs;
+    {
+        std::lock_guard<std::mutex> lock(m_logRingsMutex);
+        for (auto it = m_logRings.begin(); it != m_logRings.end();) {
+            LogRing &ring = **it;
+            // Read before draining: a retired ring gets no further pushes.
+            const bool retired = ring.retired.load(std::memory_order_acquire);
+            const std::size_t drained =
+                ring.drain([&logs](OutboundFrame &&frame) { logs.push_back(std::move(frame)); });
+            m_logRingDepth.fetch_sub(drained, std::memory_order_relaxed);
+            it = retired ? m_logRings.erase(it) : std::next(it);
+        }
+        const std::uint64_t dropped = m_droppedLogFrames.load(std::memory_order_relaxed);
+        const std::int64_t tsMs = nowMs();
+        if (dropped != m_reportedLogFrameDrops && tsMs - m_lastLogRingOverflowTsMs >= kHostDiagRateLimitMs) {
+            m_lastLogRingOverflowTsMs = tsMs;
+            m_reportedLogFrameDrops = dropped;
+            hostStderrLine("[sidecar][logRingOverflow][host] droppedTotal=" + std::to_string(dropped)
+                           + " capacity=" + std::to_string(kLogRingCapacity));
+        }
+    }
+    if (logs.empty())
+        return;
+    // Each ring is in order already; interleave them, then merge with the
+    // queue so a thread's logs keep their place among its other frames.
+    const auto bySeq = [](const OutboundFrame &a, const OutboundFrame &b) { return a.seq < b.seq; };
+    std::sort(logs.begin(), logs.end(), bySeq);
+    std::deque<OutboundFrame> merged;
+    std::merge(std::make_move_iterator(queue->begin()),
+               std::make_move_iterator(queue->end()),
+               std::make_move_iterator(logs.begin()),
+               std::make_move_iterator(logs.end()),
+               std::back_inserter(merged),
+               bySeq);
+    queue->swap(merged);
+    shedOverCap(queue);
+}
+
+void SidecarDispatcher::shedOverCap(std::deque<OutboundFrame> *queue)
+{
+    if (queue->size() <= kHostQueueMaxDepth)
+        return;
+    // Same order as at enqueue: oldest logs, then oldest events; responses
+    // and incidents stay.
+    std::size_t excess = queue->size() - kHostQueueMaxDepth;
+    const auto shed = [&](auto &&sheddable) {
+        if (excess == 0)
+            return;
+        const auto kept = std::remove_if(queue->begin(), queue->end(), [&](const OutboundFrame &frame) {
+            if (excess == 0 || !sheddable(frame))
+                return false;
+            --excess;
+            return true;
+        });
+        queue->erase(kept, queue->end());
+    };
+    const std::size_t before = queue->size();
+    shed([](const OutboundFrame &frame) { return frame.isLogFrame && !frame.isIncident; });
+    shed([](const OutboundFrame &frame) { return frame.type == MessageType::Event && !frame.isIncident; });
+    const std::uint64_t droppedTotal =
+        m_droppedOutboundFrames.fetch_add(before - queue->size(), std::memory_order_relaxed) + before - queue->size();
+    const std::int64_t tsMs = nowMs();
+    std::lock_guard<std::mutex> diagLock(m_hostDiagMutex);
+    if (tsMs - m_lastQueueOverflowTsMs >= kHostDiagRateLimitMs) {
+        m_lastQueueOverflowTsMs = tsMs;
+        hostStderrLine("[sidecar][queueOverflow][host] droppedTotal=" + std::to_string(droppedTotal)
+                       + " maxDepth=" + std::to_string(kHostQueueMaxDepth));
+    }
+}
+
 bool SidecarDispatcher::flushSendQueue(phicore::adapter::v1::Utf8String *error)
 {
     std::deque<OutboundFrame> localQueue;
     {
         std::lock_guard<std::mutex> lock(m_sendQueueMutex);
-        if (m_sendQueue.empty())
-            return true;
         localQueue.swap(m_sendQueue);
     }
+    // After the swap: every log enqueued before a swapped frame is in a ring.
+    drainLogRings(&localQueue);
+    updateLogThrottle(localQueue.size(), true);
+    if (localQueue.empty())
+        return true;
 
+    const auto asBytes = [](const std::string &payload) {
+        return std::as_bytes(std::span<const char>(payload.data(), payload.size()));
+    };
     for (auto it = localQueue.begin(); it != localQueue.end(); ++it) {
         OutboundFrame &frame = *it;
-        const auto chars = std::span<const char>(frame.payload.data(), frame.payload.size());
-        const auto bytes = std::as_bytes(chars);
+        std::string registration;
+        if (frame.deferred) {
+            // Small by construction (see kMaxDeferredTextBytes), so never oversize.
+            // Incidents always go out whole.
+            if (frame.isLogFrame && !frame.isIncident && m_logTemplatesAccepted.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(m_logTemplatesMutex);
+                frame.payload = frame.deferred->encode(frame, &m_logTemplates, &registration);
+            } else {
+                frame.payload = frame.deferred->encode(frame);
+            }
+            frame.deferred.reset();
+        }
         phicore::adapter::v1::Utf8String sendError;
         bool ok = false;
         bool clientGone = false;
         {
             std::lock_guard<std::mutex> lock(m_runtimeMutex);
-            ok = m_runtime->send(frame.type, frame.correlationId, bytes, &sendError);
+            ok = registration.empty() || m_runtime->send(MessageType::Event, 0, asBytes(registration), &sendError);
+            if (ok)
+                ok = m_runtime->send(frame.type, frame.correlationId, asBytes(frame.payload), &sendError);
             if (!ok)
                 clientGone = !m_runtime->connected();
         }
+        if (!ok && !registration.empty()) {
+            // The core may not have the template; register anew next time.
+            std::lock_guard<std::mutex> lock(m_logTemplatesMutex);
+            m_logTemplates.clear();
+        }
         if (!ok) {
             if (error && error->empty())
                 *error = "Failed to send outbound frame: " + sendError;
@@ -2346,68 +5601,72 @@ bool SidecarDispatcher::flushSendQueue(phicore::adapter::v1::Utf8String *error)
     return true;
 }
 
+LogLevel SidecarDispatcher::logThrottleLevel() const noexcept
+{
+    switch (m_logThrottleStage.load(std::memory_order_relaxed)) {
+    case 0:
+        return LogLevel::Trace;
+    case 1:
+        return LogLevel::Debug;
+    default:
+        return LogLevel::Info;
+    }
+}
+
+void SidecarDispatcher::updateLogThrottle(std::size_t backlog, bool mayRelax)
+{
+    const auto stageFor = [](std::size_t depth, std::size_t scale) {
+        return depth >= kLogThrottleDebugBacklog / scale ? 2 : depth >= kLogThrottleTraceBacklog / scale ? 1 : 0;
+    };
+    const int pressure = stageFor(backlog, 1);
+    const int stage = m_logThrottleStage.load(std::memory_order_relaxed);
+    if (pressure <= stage && (!mayRelax || stage == 0))
+        return;
+
+    const std::int64_t tsMs = nowMs();
+    std::lock_guard<std::mutex> diagLock(m_hostDiagMutex);
+    const int current = m_logThrottleStage.load(std::memory_order_relaxed);
+    int next = current;
+    if (pressure > current) {
+        next = pressure;
+        m_logThrottleCalmSinceMs = 0;
+    } else if (mayRelax) {
+        const int calm = std::max(pressure, stageFor(backlog, 2));
+        if (calm >= current) {
+            m_logThrottleCalmSinceMs = 0;
+        } else if (m_logThrottleCalmSinceMs == 0) {
+            m_logThrottleCalmSinceMs = tsMs;
+        } else if (tsMs - m_logThrottleCalmSinceMs >= kLogThrottleCalmMs) {
+            next = calm;
+            m_logThrottleCalmSinceMs = 0;
+        }
+    }
+    if (next == current)
+        return;
+    m_logThrottleStage.store(next, std::memory_order_relaxed);
+    static constexpr const char *kMinLevel[] = {"trace", "debug", "info"};
+    hostStderrLine(std::string("[sidecar][logThrottle][host] minLevel=") + kMinLevel[next]
+                   + " previous=" + kMinLevel[current] + " backlog=" + std::to_string(backlog));
+}
+
 bool SidecarDispatcher::sendCmdResult(const CmdResponse &response, phicore::adapter::v1::Utf8String *error)
 {
-    const std::int64_t tsMs = response.tsMs > 0 ? response.tsMs : nowMs();
     std::string body;
     bool first = true;
-    openEnvelopeWithCmdId(body, IpcCommand::ResultCmd, response.id, first);
-    appendFieldPrefix(body, first, "status");
-    body += std::to_string(static_cast<int>(response.status));
-    appendFieldPrefix(body, first, "error");
-    body += jsonQuoted(response.error);
-    appendFieldPrefix(body, first, "errorCtx");
-    body += jsonQuoted(response.errorContext);
-    appendFieldPrefix(body, first, "errorParams");
-    appendScalarListJson(body, response.errorParams);
-    appendFieldPrefix(body, first, "finalValue");
-    appendScalarJson(body, response.finalValue);
-    appendFieldPrefix(body, first, "tsMs");
-    body += std::to_string(tsMs);
-    closeEnvelope(body);
-    return sendJson(MessageType::Response, response.id, body, error);
+    openEnvelopeWithCmdId<IpcCommand::ResultCmd>(body, response.id, first);
+    encodeFields(body, first, kCmdResponseFields, response);
+    closeEnvelope<IpcCommand::ResultCmd>(body);
+    return sendJson(MessageType::Response, response.id, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendActionResult(const ActionResponse &response, phicore::adapter::v1::Utf8String *error)
 {
-    const std::int64_t tsMs = response.tsMs > 0 ? response.tsMs : nowMs();
-    const auto resultValueJson = trim(response.resultValueJson);
-    const auto formValues = trim(response.formValuesJson);
-    const auto fieldChoices = trim(response.fieldChoicesJson);
     std::string body;
     bool first = true;
-    openEnvelopeWithCmdId(body, IpcCommand::ResultAction, response.id, first);
-    appendFieldPrefix(body, first, "status");
-    body += std::to_string(static_cast<int>(response.status));
-    appendFieldPrefix(body, first, "error");
-    body += jsonQuoted(response.error);
-    appendFieldPrefix(body, first, "errorCtx");
-    body += jsonQuoted(response.errorContext);
-    appendFieldPrefix(body, first, "errorParams");
-    appendScalarListJson(body, response.errorParams);
-    appendFieldPrefix(body, first, "resultType");
-    body += std::to_string(static_cast<int>(response.resultType));
-    appendFieldPrefix(body, first, "resultValue");
-    if (!resultValueJson.empty())
-        body += jsonTokenOrDefault(std::string(resultValueJson), "null");
-    else
-        appendScalarJson(body, response.resultValue);
-    if (!formValues.empty()) {
-        appendFieldPrefix(body, first, "formValues");
-        appendMetaJson(body, std::string(formValues));
-    }
-    if (!fieldChoices.empty()) {
-        appendFieldPrefix(body, first, "fieldChoices");
-        appendMetaJson(body, std::string(fieldChoices));
-    }
-    if (response.reloadLayout) {
-        appendFieldPrefix(body, first, "reloadLayout");
-        body += "true";
-    }
-    appendFieldPrefix(body, first, "tsMs");
-    body += std::to_string(tsMs);
-    closeEnvelope(body);
-    return sendJson(MessageType::Response, response.id, body, error);
+    openEnvelopeWithCmdId<IpcCommand::ResultAction>(body, response.id, first);
+    encodeFields(body, first, kActionResponseFields, response);
+    closeEnvelope<IpcCommand::ResultAction>(body);
+    return sendJson(MessageType::Response, response.id, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendConnectionStateChanged(const phicore::adapter::v1::ExternalId &externalId,
@@ -2416,13 +5675,12 @@ bool SidecarDispatcher::sendConnectionStateChanged(const phicore::adapter::v1::E
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventConnectionStateChanged, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventConnectionStateChanged>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "connected");
     body += (connected ? "true" : "false");
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    closeEnvelope<IpcCommand::EventConnectionStateChanged>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendError(const phicore::adapter::v1::ExternalId &externalId,
@@ -2435,30 +5693,6 @@ bool SidecarDispatcher::sendError(const phicore::adapter::v1::ExternalId &extern
                                   std::int64_t tsMs,
                                   phicore::adapter::v1::Utf8String *error)
 {
-    const std::string fields = trim(fieldsJson).empty() ? "{}" : fieldsJson;
-    const std::int64_t effectiveTsMs = tsMs > 0 ? tsMs : nowMs();
-    std::string body;
-    bool first = true;
-    openEnvelope(body, IpcCommand::EventLog, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
-    appendFieldPrefix(body, first, "plugin");
-    body += jsonQuoted(plugin);
-    appendFieldPrefix(body, first, "level");
-    body += std::to_string(static_cast<unsigned int>(encodeWireLevel(LogLevel::Error)));
-    appendFieldPrefix(body, first, "category");
-    body += std::to_string(static_cast<unsigned int>(encodeWireCategory(category, true)));
-    appendFieldPrefix(body, first, "message");
-    body += jsonQuoted(message);
-    appendFieldPrefix(body, first, "ctx");
-    body += jsonQuoted(ctx);
-    appendFieldPrefix(body, first, "params");
-    appendScalarListJson(body, params);
-    appendFieldPrefix(body, first, "fields");
-    body += jsonTokenOrDefault(fields, "{}");
-    appendFieldPrefix(body, first, "tsMs");
-    body += std::to_string(effectiveTsMs);
-    closeEnvelope(body);
     OutboundFrame frame;
     frame.type = MessageType::Event;
     frame.isLogFrame = true;
@@ -2466,7 +5700,10 @@ bool SidecarDispatcher::sendError(const phicore::adapter::v1::ExternalId &extern
     frame.plugin = plugin;
     frame.externalId = externalId;
     frame.message = message;
-    frame.payload = std::move(body);
+    frame.deferred = std::make_shared<const DeferredEvent>(
+        DeferredEvent{retainedIdentity(externalId, plugin),
+                      tsMs > 0 ? tsMs : nowMs(),
+                      DeferredEvent::Log{LogLevel::Error, category, ctx, params, fieldsJson}});
     return queueOutboundFrame(std::move(frame), error);
 }
 
@@ -2475,55 +5712,58 @@ bool SidecarDispatcher::sendLog(const phicore::adapter::v1::ExternalId &external
                                 const LogEntry &entry,
                                 phicore::adapter::v1::Utf8String *error)
 {
-    const std::int64_t tsMs = entry.tsMs > 0 ? entry.tsMs : nowMs();
-    const std::string fields = trim(entry.fieldsJson).empty() ? "{}" : entry.fieldsJson;
-    std::string body;
-    bool first = true;
-    openEnvelope(body, IpcCommand::EventLog, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
-    appendFieldPrefix(body, first, "plugin");
-    body += jsonQuoted(plugin);
-    appendFieldPrefix(body, first, "level");
-    body += std::to_string(static_cast<unsigned int>(encodeWireLevel(entry.level)));
-    appendFieldPrefix(body, first, "category");
-    body += std::to_string(static_cast<unsigned int>(encodeWireCategory(entry.category, false)));
-    appendFieldPrefix(body, first, "message");
-    body += jsonQuoted(entry.message);
-    appendFieldPrefix(body, first, "ctx");
-    body += jsonQuoted(entry.ctx);
-    appendFieldPrefix(body, first, "params");
-    appendScalarListJson(body, entry.params);
-    appendFieldPrefix(body, first, "fields");
-    body += jsonTokenOrDefault(fields, "{}");
-    appendFieldPrefix(body, first, "tsMs");
-    body += std::to_string(tsMs);
-    closeEnvelope(body);
+    return sendLog(externalId, plugin, LogEntry(entry), error);
+}
+
+bool SidecarDispatcher::sendLog(const phicore::adapter::v1::ExternalId &externalId,
+                                const phicore::adapter::v1::Utf8String &plugin,
+                                LogEntry &&entry,
+                                phicore::adapter::v1::Utf8String *error)
+{
     OutboundFrame frame;
     frame.type = MessageType::Event;
     frame.isLogFrame = true;
     frame.isIncident = false;
     frame.plugin = plugin;
     frame.externalId = externalId;
-    frame.message = entry.message;
-    frame.payload = std::move(body);
-    return queueOutboundFrame(std::move(frame), error);
+    frame.message = std::move(entry.message);
+    frame.deferred = std::make_shared<const DeferredEvent>(
+        DeferredEvent{retainedIdentity(externalId, plugin),
+                      entry.tsMs > 0 ? entry.tsMs : nowMs(),
+                      DeferredEvent::Log{entry.level,
+                                         entry.category,
+                                         std::move(entry.ctx),
+                                         std::move(entry.params),
+                                         std::move(entry.fieldsJson)}});
+    return queueLogFrame(std::move(frame), error);
 }
 
 bool SidecarDispatcher::sendAdapterMetaUpdated(const phicore::adapter::v1::ExternalId &externalId,
                                                const phicore::adapter::v1::JsonText &metaPatchJson,
                                                phicore::adapter::v1::Utf8String *error)
 {
-    const std::string patch = trim(metaPatchJson).empty() ? "{}" : metaPatchJson;
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventAdapterMetaUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventAdapterMetaUpdated>(body, first);
+    appendExternalIdMember(body, first, externalId);
+    appendFieldPrefix(body, first, "metaPatch");
+    appendJsonToken(body, metaPatchJson, "{}");
+    closeEnvelope<IpcCommand::EventAdapterMetaUpdated>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
+}
+
+bool SidecarDispatcher::sendAdapterMetaUpdated(const phicore::adapter::v1::ExternalId &externalId,
+                                               const TrustedJson &metaPatchJson,
+                                               phicore::adapter::v1::Utf8String *error)
+{
+    std::string body;
+    bool first = true;
+    openEnvelope<IpcCommand::EventAdapterMetaUpdated>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "metaPatch");
-    body += jsonTokenOrDefault(patch, "{}");
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    appendTrustedJson(body, metaPatchJson, "{}");
+    closeEnvelope<IpcCommand::EventAdapterMetaUpdated>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendAdapterDescriptor(const phicore::adapter::v1::ExternalId &externalId,
@@ -2533,53 +5773,52 @@ bool SidecarDispatcher::sendAdapterDescriptor(const phicore::adapter::v1::Extern
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::ResponseFactoryDescriptor, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::ResponseFactoryDescriptor>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "descriptor");
-    body += descriptorToJson(descriptor);
-    closeEnvelope(body);
-    return sendJson(MessageType::Response, correlationId, body, error);
+    appendDescriptorJson(body, descriptor);
+    closeEnvelope<IpcCommand::ResponseFactoryDescriptor>(body);
+    return sendJson(MessageType::Response, correlationId, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendAdapterDescriptorUpdated(const phicore::adapter::v1::ExternalId &externalId,
                                                      const AdapterDescriptor &descriptor,
                                                      phicore::adapter::v1::Utf8String *error)
 {
-    std::string body;
-    bool first = true;
-    openEnvelope(body, IpcCommand::EventFactoryDescriptorUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
-    appendFieldPrefix(body, first, "descriptor");
-    body += descriptorToJson(descriptor);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    std::string body;
+    bool first = true;
+    openEnvelope<IpcCommand::EventFactoryDescriptorUpdated>(body, first);
+    appendExternalIdMember(body, first, externalId);
+    appendFieldPrefix(body, first, "descriptor");
+    appendDescriptorJson(body, descriptor);
+    closeEnvelope<IpcCommand::EventFactoryDescriptorUpdated>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
+}
+
+bool SidecarDispatcher::sendChannelStateUpdated(const phicore::adapter::v1::ExternalId &externalId,
+                                                const phicore::adapter::v1::ExternalId &deviceExternalId,
+                                                const phicore::adapter::v1::ExternalId &channelExternalId,
+                                                const ScalarValue &value,
+                                                std::int64_t tsMs,
+                                                phicore::adapter::v1::Utf8String *error)
+{
+    return sendChannelStateUpdated(externalId, deviceExternalId, channelExternalId, ScalarValue(value), tsMs, error);
 }
 
 bool SidecarDispatcher::sendChannelStateUpdated(const phicore::adapter::v1::ExternalId &externalId,
                                                 const phicore::adapter::v1::ExternalId &deviceExternalId,
                                                 const phicore::adapter::v1::ExternalId &channelExternalId,
-                                                const ScalarValue &value,
+                                                ScalarValue &&value,
                                                 std::int64_t tsMs,
                                                 phicore::adapter::v1::Utf8String *error)
 {
-    const std::int64_t timestamp = tsMs > 0 ? tsMs : nowMs();
-    std::string body;
-    bool first = true;
-    openEnvelope(body, IpcCommand::EventChannelStateUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
-    appendFieldPrefix(body, first, "deviceExternalId");
-    body += jsonQuoted(deviceExternalId);
-    appendFieldPrefix(body, first, "channelExternalId");
-    body += jsonQuoted(channelExternalId);
-    appendFieldPrefix(body, first, "value");
-    appendScalarJson(body, value);
-    appendFieldPrefix(body, first, "tsMs");
-    body += std::to_string(timestamp);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    OutboundFrame frame;
+    frame.externalId = externalId;
+    frame.deferred = std::make_shared<const DeferredEvent>(
+        DeferredEvent{retainedIdentity(externalId),
+                      tsMs > 0 ? tsMs : nowMs(),
+                      DeferredEvent::ChannelState{deviceExternalId, channelExternalId, std::move(value)}});
+    return queueOutboundFrame(std::move(frame), error);
 }
 
 bool SidecarDispatcher::sendChannelColorStateUpdated(const phicore::adapter::v1::ExternalId &externalId,
@@ -2591,28 +5830,34 @@ bool SidecarDispatcher::sendChannelColorStateUpdated(const phicore::adapter::v1:
                                                      std::int64_t tsMs,
                                                      phicore::adapter::v1::Utf8String *error)
 {
-    const std::int64_t timestamp = tsMs > 0 ? tsMs : nowMs();
-    std::string body;
-    bool first = true;
-    openEnvelope(body, IpcCommand::EventChannelStateUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
-    appendFieldPrefix(body, first, "deviceExternalId");
-    body += jsonQuoted(deviceExternalId);
-    appendFieldPrefix(body, first, "channelExternalId");
-    body += jsonQuoted(channelExternalId);
-    appendFieldPrefix(body, first, "value");
-    body += "{\"r\":";
-    appendDoubleJson(body, r);
-    body += ",\"g\":";
-    appendDoubleJson(body, g);
-    body += ",\"b\":";
-    appendDoubleJson(body, b);
-    body += "}";
-    appendFieldPrefix(body, first, "tsMs");
-    body += std::to_string(timestamp);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    OutboundFrame frame;
+    frame.externalId = externalId;
+    frame.deferred = std::make_shared<const DeferredEvent>(
+        DeferredEvent{retainedIdentity(externalId),
+                      tsMs > 0 ? tsMs : nowMs(),
+                      DeferredEvent::ChannelColor{deviceExternalId, channelExternalId, r, g, b}});
+    return queueOutboundFrame(std::move(frame), error);
+}
+
+bool SidecarDispatcher::sendChannelStatesUpdated(const phicore::adapter::v1::ExternalId &externalId,
+                                                 std::span<const ChannelStateUpdate> updates,
+                                                 phicore::adapter::v1::Utf8String *error)
+{
+    if (updates.empty())
+        return true;
+    std::vector<OutboundFrame> frames = DeferredEvent::channelStateFrames(externalId, updates);
+    return queueOutboundFrames(frames, error);
+}
+
+bool SidecarDispatcher::sendChannelStatesUpdated(const phicore::adapter::v1::ExternalId &externalId,
+                                                 std::vector<ChannelStateUpdate> &&updates,
+                                                 phicore::adapter::v1::Utf8String *error)
+{
+    if (updates.empty())
+        return true;
+    std::vector<OutboundFrame> frames =
+        DeferredEvent::channelStateFrames(externalId, std::span<ChannelStateUpdate>(updates));
+    return queueOutboundFrames(frames, error);
 }
 
 bool SidecarDispatcher::sendDeviceUpdated(const phicore::adapter::v1::ExternalId &externalId,
@@ -2620,25 +5865,84 @@ bool SidecarDispatcher::sendDeviceUpdated(const phicore::adapter::v1::ExternalId
                                           const ChannelList &channels,
                                           phicore::adapter::v1::Utf8String *error)
 {
+    SentDevice snapshot;
+    encodeObject(snapshot.device, kDeviceFields, device);
+    snapshot.channels.reserve(channels.size());
+    for (const Channel &channel : channels) {
+        std::string channelJson;
+        encodeObject(channelJson, kChannelFields, channel);
+        snapshot.channels.emplace_back(channel.externalId, std::move(channelJson));
+    }
+
+    // The delta is worked out under the lock and queued after it; the send
+    // then commits its snapshot, or forgets the entry when it failed or another
+    // send stored one in between, so the next snapshot goes out in full.
+    std::uint64_t seen = 0;
+    std::uint64_t forgetsSeen = 0;
+    const auto commit = [&](bool queued) {
+        std::lock_guard<std::mutex> lock(m_topologyMutex);
+        if (!queued || sentGeneration(m_sentTopology, externalId, device.externalId) != seen
+            || (seen == 0 && m_topologyForgets != forgetsSeen)) {
+            forgetSentDevice(m_sentTopology, externalId, device.externalId);
+            ++m_topologyForgets;
+            return;
+        }
+        snapshot.generation = ++m_topologyGeneration;
+        m_sentTopology[externalId][device.externalId] = std::move(snapshot);
+    };
+
+    std::vector<OutboundFrame> frames;
+    bool delta = false;
+    {
+        std::lock_guard<std::mutex> lock(m_topologyMutex);
+        const SentDevice *sent = findSentDevice(m_sentTopology, externalId, device.externalId);
+        seen = sent ? sent->generation : 0;
+        forgetsSeen = m_topologyForgets;
+        if (sent && sent->device == snapshot.device && sameChannelIds(sent->channels, snapshot.channels)) {
+            delta = true;
+            for (std::size_t i = 0; i < snapshot.channels.size(); ++i) {
+                if (sent->channels[i].second == snapshot.channels[i].second)
+                    continue;
+                frames.emplace_back();
+                appendChannelUpdatedBody(frames.back().payload, externalId, device.externalId,
+                                         snapshot.channels[i].second);
+            }
+            m_topologyStats.skippedChannels += snapshot.channels.size() - frames.size();
+            if (frames.empty()) {
+                ++m_topologyStats.skippedSends;
+                return true;
+            }
+            ++m_topologyStats.deltaSends;
+        } else {
+            ++m_topologyStats.fullSends;
+        }
+    }
+    if (delta) {
+        const bool queued = queueOutboundFrames(frames, error);
+        commit(queued);
+        return queued;
+    }
+
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventDeviceUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventDeviceUpdated>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "device");
-    body += deviceToJson(device);
+    body += snapshot.device;
     appendFieldPrefix(body, first, "channels");
     body.push_back('[');
     bool firstChannel = true;
-    for (const Channel &channel : channels) {
+    for (const auto &channel : snapshot.channels) {
         if (!firstChannel)
             body.push_back(',');
         firstChannel = false;
-        body += channelToJson(channel);
+        body += channel.second;
     }
     body.push_back(']');
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    closeEnvelope<IpcCommand::EventDeviceUpdated>(body);
+    const bool queued = sendJson(MessageType::Event, 0, std::move(body), error);
+    commit(queued);
+    return queued;
 }
 
 bool SidecarDispatcher::sendDeviceRemoved(const phicore::adapter::v1::ExternalId &externalId,
@@ -2647,13 +5951,17 @@ bool SidecarDispatcher::sendDeviceRemoved(const phicore::adapter::v1::ExternalId
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventDeviceRemoved, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventDeviceRemoved>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "deviceExternalId");
-    body += jsonQuoted(deviceExternalId);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    json::appendQuoted(body, deviceExternalId);
+    closeEnvelope<IpcCommand::EventDeviceRemoved>(body);
+    {
+        std::lock_guard<std::mutex> lock(m_topologyMutex);
+        forgetSentDevice(m_sentTopology, externalId, deviceExternalId);
+        ++m_topologyForgets;
+    }
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendChannelUpdated(const phicore::adapter::v1::ExternalId &externalId,
@@ -2661,17 +5969,49 @@ bool SidecarDispatcher::sendChannelUpdated(const phicore::adapter::v1::ExternalI
                                            const Channel &channel,
                                            phicore::adapter::v1::Utf8String *error)
 {
+    std::string channelJson;
+    encodeObject(channelJson, kChannelFields, channel);
     std::string body;
-    bool first = true;
-    openEnvelope(body, IpcCommand::EventChannelUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
-    appendFieldPrefix(body, first, "deviceExternalId");
-    body += jsonQuoted(deviceExternalId);
-    appendFieldPrefix(body, first, "channel");
-    body += channelToJson(channel);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    appendChannelUpdatedBody(body, externalId, deviceExternalId, channelJson);
+
+    std::uint64_t seen = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_topologyMutex);
+        seen = sentGeneration(m_sentTopology, externalId, deviceExternalId);
+    }
+    const bool queued = sendJson(MessageType::Event, 0, std::move(body), error);
+
+    std::lock_guard<std::mutex> lock(m_topologyMutex);
+    SentDevice *sent = findSentDevice(m_sentTopology, externalId, deviceExternalId);
+    if (!sent)
+        return queued;
+    const auto cached = std::find_if(sent->channels.begin(), sent->channels.end(), [&](const auto &entry) {
+        return entry.first == channel.externalId;
+    });
+    // A channel the snapshot did not have changes the device's shape, and an
+    // entry stored while this frame was queued may predate it; either way the
+    // next sendDeviceUpdated() must be a full one.
+    if (!queued || sent->generation != seen || cached == sent->channels.end()) {
+        forgetSentDevice(m_sentTopology, externalId, deviceExternalId);
+        ++m_topologyForgets;
+        return queued;
+    }
+    cached->second = std::move(channelJson);
+    sent->generation = ++m_topologyGeneration;
+    return true;
+}
+
+void SidecarDispatcher::invalidateTopologyCache(const phicore::adapter::v1::ExternalId &externalId)
+{
+    std::lock_guard<std::mutex> lock(m_topologyMutex);
+    m_sentTopology.erase(externalId);
+    ++m_topologyForgets;
+}
+
+TopologyCacheStats SidecarDispatcher::topologyCacheStats() const
+{
+    std::lock_guard<std::mutex> lock(m_topologyMutex);
+    return m_topologyStats;
 }
 
 bool SidecarDispatcher::sendRoomUpdated(const phicore::adapter::v1::ExternalId &externalId,
@@ -2680,13 +6020,12 @@ bool SidecarDispatcher::sendRoomUpdated(const phicore::adapter::v1::ExternalId &
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventRoomUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventRoomUpdated>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "room");
-    body += roomToJson(room);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    encodeObject(body, kRoomFields, room);
+    closeEnvelope<IpcCommand::EventRoomUpdated>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendRoomRemoved(const phicore::adapter::v1::ExternalId &externalId,
@@ -2695,13 +6034,12 @@ bool SidecarDispatcher::sendRoomRemoved(const phicore::adapter::v1::ExternalId &
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventRoomRemoved, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventRoomRemoved>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "roomExternalId");
-    body += jsonQuoted(roomExternalId);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    json::appendQuoted(body, roomExternalId);
+    closeEnvelope<IpcCommand::EventRoomRemoved>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendGroupUpdated(const phicore::adapter::v1::ExternalId &externalId,
@@ -2710,13 +6048,12 @@ bool SidecarDispatcher::sendGroupUpdated(const phicore::adapter::v1::ExternalId
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventGroupUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventGroupUpdated>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "group");
-    body += groupToJson(group);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    encodeObject(body, kGroupFields, group);
+    closeEnvelope<IpcCommand::EventGroupUpdated>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendGroupRemoved(const phicore::adapter::v1::ExternalId &externalId,
@@ -2725,13 +6062,12 @@ bool SidecarDispatcher::sendGroupRemoved(const phicore::adapter::v1::ExternalId
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventGroupRemoved, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventGroupRemoved>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "groupExternalId");
-    body += jsonQuoted(groupExternalId);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    json::appendQuoted(body, groupExternalId);
+    closeEnvelope<IpcCommand::EventGroupRemoved>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendSceneUpdated(const phicore::adapter::v1::ExternalId &externalId,
@@ -2740,13 +6076,12 @@ bool SidecarDispatcher::sendSceneUpdated(const phicore::adapter::v1::ExternalId
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventSceneUpdated, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventSceneUpdated>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "scene");
-    body += sceneToJson(scene);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    encodeObject(body, kSceneFields, scene);
+    closeEnvelope<IpcCommand::EventSceneUpdated>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendSceneRemoved(const phicore::adapter::v1::ExternalId &externalId,
@@ -2755,13 +6090,12 @@ bool SidecarDispatcher::sendSceneRemoved(const phicore::adapter::v1::ExternalId
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventSceneRemoved, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventSceneRemoved>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "sceneExternalId");
-    body += jsonQuoted(sceneExternalId);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    json::appendQuoted(body, sceneExternalId);
+    closeEnvelope<IpcCommand::EventSceneRemoved>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendStreamOpen(const phicore::adapter::v1::ExternalId &externalId,
@@ -2775,25 +6109,24 @@ bool SidecarDispatcher::sendStreamOpen(const phicore::adapter::v1::ExternalId &e
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventStreamOpen, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventStreamOpen>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "streamId");
-    body += jsonQuoted(streamId);
+    json::appendQuoted(body, streamId);
     appendFieldPrefix(body, first, "cmd");
-    body += jsonQuoted(cmd);
+    json::appendQuoted(body, cmd);
     appendFieldPrefix(body, first, "kind");
-    body += jsonQuoted(kind);
+    json::appendQuoted(body, kind);
     appendFieldPrefix(body, first, "contentType");
-    body += jsonQuoted(contentType.empty() ? "application/json" : contentType);
+    json::appendQuoted(body, contentType.empty() ? "application/json" : contentType);
     if (!trim(contentEncoding).empty()) {
         appendFieldPrefix(body, first, "contentEncoding");
-        body += jsonQuoted(contentEncoding);
+        json::appendQuoted(body, contentEncoding);
     }
     appendFieldPrefix(body, first, "meta");
-    body += jsonTokenOrDefault(std::string(metaJson), "{}");
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    appendJsonToken(body, metaJson, "{}");
+    closeEnvelope<IpcCommand::EventStreamOpen>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendStreamData(const phicore::adapter::v1::ExternalId &externalId,
@@ -2804,24 +6137,50 @@ bool SidecarDispatcher::sendStreamData(const phicore::adapter::v1::ExternalId &e
                                        std::int64_t tsMs,
                                        phicore::adapter::v1::Utf8String *error)
 {
-    const std::int64_t timestamp = tsMs > 0 ? tsMs : nowMs();
     std::string body;
-    bool first = true;
-    openEnvelope(body, IpcCommand::EventStreamData, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
-    appendFieldPrefix(body, first, "streamId");
-    body += jsonQuoted(streamId);
-    appendFieldPrefix(body, first, "cmd");
-    body += jsonQuoted(cmd);
-    appendFieldPrefix(body, first, "seq");
-    body += std::to_string(seq);
-    appendFieldPrefix(body, first, "tsMs");
-    body += std::to_string(timestamp);
-    appendFieldPrefix(body, first, "data");
-    body += jsonTokenOrDefault(std::string(payloadJson), "{}");
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    openStreamDataBody(body, externalId, streamId, cmd, seq, tsMs > 0 ? tsMs : nowMs());
+    appendJsonToken(body, payloadJson, "{}");
+    closeEnvelope<IpcCommand::EventStreamData>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
+}
+
+bool SidecarDispatcher::sendStreamData(const phicore::adapter::v1::ExternalId &externalId,
+                                       const phicore::adapter::v1::Utf8String &streamId,
+                                       const phicore::adapter::v1::Utf8String &cmd,
+                                       std::int64_t seq,
+                                       const TrustedJson &payloadJson,
+                                       std::int64_t tsMs,
+                                       phicore::adapter::v1::Utf8String *error)
+{
+    std::string body;
+    openStreamDataBody(body, externalId, streamId, cmd, seq, tsMs > 0 ? tsMs : nowMs());
+    appendTrustedJson(body, payloadJson, "{}");
+    closeEnvelope<IpcCommand::EventStreamData>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
+}
+
+bool SidecarDispatcher::sendStreamData(const phicore::adapter::v1::ExternalId &externalId,
+                                       const phicore::adapter::v1::Utf8String &streamId,
+                                       const phicore::adapter::v1::Utf8String &cmd,
+                                       std::int64_t seq,
+                                       const std::function<void(JsonWriter &)> &writeData,
+                                       std::int64_t tsMs,
+                                       phicore::adapter::v1::Utf8String *error)
+{
+    std::string body;
+    openStreamDataBody(body, externalId, streamId, cmd, seq, tsMs > 0 ? tsMs : nowMs());
+    JsonWriter data(body);
+    if (writeData)
+        writeData(data);
+    if (data.view().empty() && data.ok()) {
+        body += "{}";
+    } else if (!data.complete()) {
+        if (error)
+            *error = "stream data writer did not produce one complete JSON value";
+        return false;
+    }
+    closeEnvelope<IpcCommand::EventStreamData>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendStreamError(const phicore::adapter::v1::ExternalId &externalId,
@@ -2835,33 +6194,32 @@ bool SidecarDispatcher::sendStreamError(const phicore::adapter::v1::ExternalId &
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventStreamError, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventStreamError>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "streamId");
-    body += jsonQuoted(streamId);
+    json::appendQuoted(body, streamId);
     appendFieldPrefix(body, first, "cmd");
-    body += jsonQuoted(cmd);
+    json::appendQuoted(body, cmd);
     appendFieldPrefix(body, first, "error");
     body.push_back('{');
     bool errorFirst = true;
     appendFieldPrefix(body, errorFirst, "message");
-    body += jsonQuoted(message);
+    json::appendQuoted(body, message);
     if (!trim(code).empty()) {
         appendFieldPrefix(body, errorFirst, "code");
-        body += jsonQuoted(code);
+        json::appendQuoted(body, code);
     }
     if (!trim(ctx).empty()) {
         appendFieldPrefix(body, errorFirst, "ctx");
-        body += jsonQuoted(ctx);
+        json::appendQuoted(body, ctx);
     }
     if (!params.empty()) {
         appendFieldPrefix(body, errorFirst, "params");
         appendScalarListJson(body, params);
     }
     body.push_back('}');
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    closeEnvelope<IpcCommand::EventStreamError>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 bool SidecarDispatcher::sendStreamEnd(const phicore::adapter::v1::ExternalId &externalId,
@@ -2872,22 +6230,43 @@ bool SidecarDispatcher::sendStreamEnd(const phicore::adapter::v1::ExternalId &ex
 {
     std::string body;
     bool first = true;
-    openEnvelope(body, IpcCommand::EventStreamEnd, first);
-    appendFieldPrefix(body, first, "externalId");
-    body += jsonQuoted(externalId);
+    openEnvelope<IpcCommand::EventStreamEnd>(body, first);
+    appendExternalIdMember(body, first, externalId);
     appendFieldPrefix(body, first, "streamId");
-    body += jsonQuoted(streamId);
+    json::appendQuoted(body, streamId);
     appendFieldPrefix(body, first, "cmd");
-    body += jsonQuoted(cmd);
+    json::appendQuoted(body, cmd);
     appendFieldPrefix(body, first, "reason");
-    body += jsonQuoted(reason);
-    closeEnvelope(body);
-    return sendJson(MessageType::Event, 0, body, error);
+    json::appendQuoted(body, reason);
+    closeEnvelope<IpcCommand::EventStreamEnd>(body);
+    return sendJson(MessageType::Event, 0, std::move(body), error);
 }
 
 #undef m_pollingThread
+#undef m_inboundIndex
+#undef m_channelInvokeScratch
+#undef m_requestRouter
+#undef m_topologyMutex
+#undef m_sentTopology
+#undef m_topologyGeneration
+#undef m_topologyForgets
+#undef m_topologyStats
 #undef m_started
 #undef m_sendQueue
+#undef m_serial
+#undef m_logRingsMutex
+#undef m_logRings
+#undef m_logRingsPending
+#undef m_nextFrameSeq
+#undef m_droppedLogFrames
+#undef m_logRingDepth
+#undef m_reportedLogFrameDrops
+#undef m_lastLogRingOverflowTsMs
+#undef m_logTemplatesAccepted
+#undef m_logTemplatesMutex
+#undef m_logTemplates
+#undef m_logThrottleStage
+#undef m_logThrottleCalmSinceMs
 #undef m_sendQueueMutex
 #undef m_runtimeMutex
 #undef m_handlers
@@ -2900,10 +6279,11 @@ struct AdapterFactory::Impl {
     ConfigChangedRequest factoryConfig;
     bool hasFactoryConfig = false;
     LogFilterCache logFilter;
-    std::function<void(const phicore::adapter::v1::ActionResponse &)> actionResultSubmitter;
+    std::function<void(phicore::adapter::v1::ActionResponse &&)> actionResultSubmitter;
     // Written by the host thread, read from the factory execution thread while
     // it may be parked in a blocking wait.
     std::atomic_bool stopRequested{false};
+    LogDedupe logDedupe;
 };
 
 AdapterFactory::AdapterFactory()
@@ -2921,6 +6301,7 @@ AdapterFactory::~AdapterFactory() = default;
 #define m_logFilter m_impl->logFilter
 #define m_actionResultSubmitter m_impl->actionResultSubmitter
 #define m_stopRequested m_impl->stopRequested
+#define m_logDedupe m_impl->logDedupe
 
 
 const BootstrapRequest &AdapterFactory::bootstrap() const
@@ -2933,6 +6314,11 @@ bool AdapterFactory::hasBootstrap() const
     return m_hasBootstrap;
 }
 
+bool AdapterFactory::isLogEnabled(LogLevel level, LogCategory category) const noexcept
+{
+    return forwardsLog(m_logFilter, m_dispatcher, level, category);
+}
+
 bool AdapterFactory::log(LogLevel level,
                          LogCategory category,
                          const phicore::adapter::v1::Utf8String &message,
@@ -2947,7 +6333,7 @@ bool AdapterFactory::log(LogLevel level,
             *error = "Dispatcher not bound";
         return false;
     }
-    if (!shouldForwardLog(m_logFilter, level, category)) {
+    if (!forwardsLog(m_logFilter, m_dispatcher, level, category)) {
         return true;
     }
     LogEntry entry;
@@ -2958,7 +6344,11 @@ bool AdapterFactory::log(LogLevel level,
     entry.params = params;
     entry.fieldsJson = fieldsJson;
     entry.tsMs = tsMs;
-    return m_dispatcher->sendLog({}, hostPluginType(), entry, error);
+    if (!m_logDedupe.enabled())
+        return m_dispatcher->sendLog({}, hostPluginType(), std::move(entry), error);
+    std::vector<LogEntry> entries;
+    m_logDedupe.admit(std::move(entry), nowMs(), &entries);
+    return sendLogEntries(*m_dispatcher, {}, hostPluginType(), entries, error);
 }
 
 phicore::adapter::v1::Utf8String AdapterFactory::displayName() const { return {}; }
@@ -3034,7 +6424,26 @@ bool AdapterFactory::sendError(LogCategory category,
             *error = "Dispatcher not bound";
         return false;
     }
-    return m_dispatcher->sendError({}, hostPluginType(), category, message, params, ctx, fieldsJson, tsMs, error);
+    if (!m_logDedupe.enabled())
+        return m_dispatcher->sendError({}, hostPluginType(), category, message, params, ctx, fieldsJson, tsMs, error);
+    std::vector<LogEntry> summaries;
+    const phicore::adapter::v1::JsonText fields =
+        m_logDedupe.countIncident(category, message, ctx, fieldsJson, nowMs(), &summaries);
+    sendLogEntries(*m_dispatcher, {}, hostPluginType(), summaries, nullptr);
+    return m_dispatcher->sendError({}, hostPluginType(), category, message, params, ctx, fields, tsMs, error);
+}
+void AdapterFactory::setLogDedupe(const LogDedupeOptions &options)
+{
+    std::vector<LogEntry> summaries;
+    m_logDedupe.configure(options, &summaries);
+    if (m_dispatcher)
+        sendLogEntries(*m_dispatcher, {}, hostPluginType(), summaries, nullptr);
+}
+bool AdapterFactory::flushLogDedupe(phicore::adapter::v1::Utf8String *error)
+{
+    std::vector<LogEntry> summaries;
+    m_logDedupe.flush(&summaries);
+    return !m_dispatcher || sendLogEntries(*m_dispatcher, {}, hostPluginType(), summaries, error);
 }
 AdapterDescriptor AdapterFactory::factoryDescriptor() const
 {
@@ -3059,6 +6468,11 @@ bool AdapterFactory::sendFactoryDescriptorUpdated(const AdapterDescriptor &descr
 }
 bool AdapterFactory::sendResult(const phicore::adapter::v1::ActionResponse &response,
                                 phicore::adapter::v1::Utf8String *error)
+{
+    return sendResult(phicore::adapter::v1::ActionResponse(response), error);
+}
+bool AdapterFactory::sendResult(phicore::adapter::v1::ActionResponse &&response,
+                                phicore::adapter::v1::Utf8String *error)
 {
     if (!m_actionResultSubmitter) {
         if (error)
@@ -3070,12 +6484,12 @@ bool AdapterFactory::sendResult(const phicore::adapter::v1::ActionResponse &resp
             *error = "ActionResponse.id must be > 0";
         return false;
     }
-    m_actionResultSubmitter(response);
+    m_actionResultSubmitter(std::move(response));
     return true;
 }
 
 void AdapterFactory::bindDispatcher(SidecarDispatcher *dispatcher) { m_dispatcher = dispatcher; }
-void AdapterFactory::bindResultSubmitter(std::function<void(const phicore::adapter::v1::ActionResponse &)> actionSubmitter)
+void AdapterFactory::bindResultSubmitter(std::function<void(phicore::adapter::v1::ActionResponse &&)> actionSubmitter)
 {
     m_actionResultSubmitter = std::move(actionSubmitter);
 }
@@ -3139,6 +6553,7 @@ void AdapterFactory::hostOnFactoryConfigChanged(const ConfigChangedRequest &requ
 }
 
 #undef m_stopRequested
+#undef m_logDedupe
 #undef m_actionResultSubmitter
 #undef m_logFilter
 #undef m_hasFactoryConfig
@@ -3155,11 +6570,16 @@ struct AdapterInstance::Impl {
     ConfigChangedRequest config;
     bool hasConfig = false;
     LogFilterCache logFilter;
-    std::function<void(const phicore::adapter::v1::CmdResponse &)> cmdResultSubmitter;
-    std::function<void(const phicore::adapter::v1::ActionResponse &)> actionResultSubmitter;
+    std::function<void(phicore::adapter::v1::CmdResponse &&)> cmdResultSubmitter;
+    std::function<void(phicore::adapter::v1::ActionResponse &&)> actionResultSubmitter;
     // Written by the host thread, read from the instance execution thread while
     // it may be parked in a blocking wait.
     std::atomic_bool stopRequested{false};
+    std::shared_ptr<InstanceIdentity> identity = std::make_shared<InstanceIdentity>();
+    ChannelStateDedupe channelDedupe;
+    ChannelPublishFilters channelFilters;
+    LogDedupe logDedupe;
+    FlightRecorder flightRecorder;
 };
 
 AdapterInstance::AdapterInstance()
@@ -3179,6 +6599,11 @@ AdapterInstance::~AdapterInstance() = default;
 #define m_cmdResultSubmitter m_impl->cmdResultSubmitter
 #define m_actionResultSubmitter m_impl->actionResultSubmitter
 #define m_stopRequested m_impl->stopRequested
+#define m_identity m_impl->identity
+#define m_channelDedupe m_impl->channelDedupe
+#define m_channelFilters m_impl->channelFilters
+#define m_logDedupe m_impl->logDedupe
+#define m_flightRecorder m_impl->flightRecorder
 
 
 int AdapterInstance::adapterId() const { return m_adapterId; }
@@ -3187,6 +6612,11 @@ const phicore::adapter::v1::ExternalId &AdapterInstance::externalId() const { re
 const ConfigChangedRequest &AdapterInstance::config() const { return m_config; }
 bool AdapterInstance::hasConfig() const { return m_hasConfig; }
 
+bool AdapterInstance::isLogEnabled(LogLevel level, LogCategory category) const noexcept
+{
+    return forwardsLog(m_logFilter, m_dispatcher, level, category) || m_flightRecorder.records(level);
+}
+
 bool AdapterInstance::log(LogLevel level,
                           LogCategory category,
                           const phicore::adapter::v1::Utf8String &message,
@@ -3201,7 +6631,9 @@ bool AdapterInstance::log(LogLevel level,
             *error = "Dispatcher not bound";
         return false;
     }
-    if (!shouldForwardLog(m_logFilter, level, category)) {
+    if (!forwardsLog(m_logFilter, m_dispatcher, level, category)) {
+        if (m_flightRecorder.records(level))
+            m_flightRecorder.record(level, category, message, params, ctx, fieldsJson, tsMs > 0 ? tsMs : nowMs());
         return true;
     }
     LogEntry entry;
@@ -3212,7 +6644,12 @@ bool AdapterInstance::log(LogLevel level,
     entry.params = params;
     entry.fieldsJson = fieldsJson;
     entry.tsMs = tsMs;
-    return m_dispatcher->sendLog(m_externalId, m_pluginType, entry, error);
+    const ScopedInstanceIdentity identityScope(m_identity);
+    if (!m_logDedupe.enabled())
+        return m_dispatcher->sendLog(m_externalId, m_pluginType, std::move(entry), error);
+    std::vector<LogEntry> entries;
+    m_logDedupe.admit(std::move(entry), nowMs(), &entries);
+    return sendLogEntries(*m_dispatcher, m_externalId, m_pluginType, entries, error);
 }
 
 bool AdapterInstance::start() { return true; }
@@ -3283,6 +6720,7 @@ void AdapterInstance::onUnknownRequest(const UnknownRequest &request) { (void)re
 
 bool AdapterInstance::sendConnectionStateChanged(bool connected, phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendConnectionStateChanged(m_externalId, connected, error) : false;
 }
 bool AdapterInstance::sendError(LogCategory category,
@@ -3298,12 +6736,41 @@ bool AdapterInstance::sendError(LogCategory category,
             *error = "Dispatcher not bound";
         return false;
     }
-    return m_dispatcher->sendError(
-        m_externalId, m_pluginType, category, message, params, ctx, fieldsJson, tsMs, error);
+    const ScopedInstanceIdentity identityScope(m_identity);
+    phicore::adapter::v1::JsonText recordedFields;
+    if (const std::size_t newest = m_flightRecorder.incidentEntries(); newest > 0) {
+        std::uint64_t dropped = 0;
+        const std::vector<std::string> entries = m_flightRecorder.take(newest, &dropped);
+        if (!entries.empty()) {
+            std::string recording = "[";
+            for (const std::string &entry : entries) {
+                if (recording.size() > 1)
+                    recording.push_back(',');
+                recording += entry;
+            }
+            recording.push_back(']');
+            recordedFields = withJsonField(fieldsJson, "flightRecorder", recording);
+        }
+    }
+    const phicore::adapter::v1::JsonText &incidentFields = recordedFields.empty() ? fieldsJson : recordedFields;
+    if (!m_logDedupe.enabled())
+        return m_dispatcher->sendError(
+            m_externalId, m_pluginType, category, message, params, ctx, incidentFields, tsMs, error);
+    std::vector<LogEntry> summaries;
+    const phicore::adapter::v1::JsonText fields =
+        m_logDedupe.countIncident(category, message, ctx, incidentFields, nowMs(), &summaries);
+    sendLogEntries(*m_dispatcher, m_externalId, m_pluginType, summaries, nullptr);
+    return m_dispatcher->sendError(m_externalId, m_pluginType, category, message, params, ctx, fields, tsMs, error);
 }
 bool AdapterInstance::sendAdapterMetaUpdated(const phicore::adapter::v1::JsonText &metaPatchJson,
                                              phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
+    return m_dispatcher ? m_dispatcher->sendAdapterMetaUpdated(m_externalId, metaPatchJson, error) : false;
+}
+bool AdapterInstance::sendAdapterMetaUpdated(const TrustedJson &metaPatchJson, phicore::adapter::v1::Utf8String *error)
+{
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendAdapterMetaUpdated(m_externalId, metaPatchJson, error) : false;
 }
 bool AdapterInstance::sendChannelStateUpdated(const phicore::adapter::v1::ExternalId &deviceExternalId,
@@ -3312,9 +6779,39 @@ bool AdapterInstance::sendChannelStateUpdated(const phicore::adapter::v1::Extern
                                               std::int64_t tsMs,
                                               phicore::adapter::v1::Utf8String *error)
 {
-    return m_dispatcher
-        ? m_dispatcher->sendChannelStateUpdated(m_externalId, deviceExternalId, channelExternalId, value, tsMs, error)
-        : false;
+    return sendChannelStateUpdated(deviceExternalId, channelExternalId, ScalarValue(value), tsMs, error);
+}
+bool AdapterInstance::sendChannelStateUpdated(const phicore::adapter::v1::ExternalId &deviceExternalId,
+                                              const phicore::adapter::v1::ExternalId &channelExternalId,
+                                              ScalarValue &&value,
+                                              std::int64_t tsMs,
+                                              phicore::adapter::v1::Utf8String *error)
+{
+    if (!m_dispatcher)
+        return false;
+    ScalarValue quantized;
+    ScalarValue *outgoing = &value;
+    if (m_channelFilters.active()) {
+        switch (m_channelFilters.apply(deviceExternalId, channelExternalId, value, tsMs, &quantized)) {
+        case FilterVerdict::Hold:
+            return true;
+        case FilterVerdict::PublishQuantized:
+            outgoing = &quantized;
+            break;
+        case FilterVerdict::Publish:
+            break;
+        }
+    }
+    const bool deduped = m_channelDedupe.enabled();
+    if (deduped && !m_channelDedupe.admit(deviceExternalId, channelExternalId, *outgoing))
+        return true;
+    const ScopedInstanceIdentity identityScope(m_identity);
+    if (m_dispatcher->sendChannelStateUpdated(
+            m_externalId, deviceExternalId, channelExternalId, std::move(*outgoing), tsMs, error))
+        return true;
+    if (deduped)
+        m_channelDedupe.forget(deviceExternalId, channelExternalId);
+    return false;
 }
 bool AdapterInstance::sendChannelColorStateUpdated(const phicore::adapter::v1::ExternalId &deviceExternalId,
                                                    const phicore::adapter::v1::ExternalId &channelExternalId,
@@ -3324,52 +6821,234 @@ bool AdapterInstance::sendChannelColorStateUpdated(const phicore::adapter::v1::E
                                                    std::int64_t tsMs,
                                                    phicore::adapter::v1::Utf8String *error)
 {
-    return m_dispatcher
-        ? m_dispatcher->sendChannelColorStateUpdated(m_externalId, deviceExternalId, channelExternalId, r, g, b, tsMs, error)
-        : false;
+    if (!m_dispatcher)
+        return false;
+    const bool deduped = m_channelDedupe.enabled();
+    if (deduped && !m_channelDedupe.admit(deviceExternalId, channelExternalId, ChannelStateDedupe::Color{r, g, b}))
+        return true;
+    const ScopedInstanceIdentity identityScope(m_identity);
+    if (m_dispatcher->sendChannelColorStateUpdated(
+            m_externalId, deviceExternalId, channelExternalId, r, g, b, tsMs, error))
+        return true;
+    if (deduped)
+        m_channelDedupe.forget(deviceExternalId, channelExternalId);
+    return false;
+}
+bool AdapterInstance::sendChannelStatesUpdated(std::span<const ChannelStateUpdate> updates,
+                                               phicore::adapter::v1::Utf8String *error)
+{
+    if (!m_dispatcher)
+        return false;
+    std::span<const ChannelStateUpdate> outgoing = updates;
+    std::vector<ChannelStateUpdate> kept;
+    const bool filtered = m_channelFilters.active();
+    const bool deduped = m_channelDedupe.enabled();
+    if (filtered || deduped) {
+        // Copied only from the first dropped or rewritten update on; a batch
+        // that passes unchanged is sent as is.
+        bool copying = false;
+        for (std::size_t i = 0; i < updates.size(); ++i) {
+            const ChannelStateUpdate &update = updates[i];
+            ScalarValue quantized;
+            const ScalarValue *value = &update.value;
+            bool keep = true;
+            if (filtered) {
+                const FilterVerdict verdict = m_channelFilters.apply(
+                    update.deviceExternalId, update.channelExternalId, update.value, update.tsMs, &quantized);
+                keep = verdict != FilterVerdict::Hold;
+                if (verdict == FilterVerdict::PublishQuantized)
+                    value = &quantized;
+            }
+            if (keep && deduped)
+                keep = m_channelDedupe.admit(update.deviceExternalId, update.channelExternalId, *value);
+            if (!copying && (!keep || value != &update.value)) {
+                kept.assign(updates.begin(), updates.begin() + static_cast<std::ptrdiff_t>(i));
+                copying = true;
+            }
+            if (copying && keep)
+                kept.push_back({update.deviceExternalId, update.channelExternalId, *value, update.tsMs});
+        }
+        if (copying)
+            outgoing = kept;
+        if (outgoing.empty())
+            return true;
+    }
+    const ScopedInstanceIdentity identityScope(m_identity);
+    if (m_dispatcher->sendChannelStatesUpdated(m_externalId, outgoing, error))
+        return true;
+    if (deduped) {
+        for (const ChannelStateUpdate &update : outgoing)
+            m_channelDedupe.forget(update.deviceExternalId, update.channelExternalId);
+    }
+    return false;
+}
+bool AdapterInstance::sendChannelStatesUpdated(std::vector<ChannelStateUpdate> &&updates,
+                                               phicore::adapter::v1::Utf8String *error)
+{
+    // Filters may drop or rewrite updates and the dedupe cache must forget
+    // refused ones by id, so only a batch neither touches is handed over.
+    if (m_channelFilters.active() || m_channelDedupe.enabled())
+        return sendChannelStatesUpdated(std::span<const ChannelStateUpdate>(updates), error);
+    if (!m_dispatcher)
+        return false;
+    const ScopedInstanceIdentity identityScope(m_identity);
+    return m_dispatcher->sendChannelStatesUpdated(m_externalId, std::move(updates), error);
+}
+void AdapterInstance::setChannelStateDedupe(const ChannelStateDedupeOptions &options)
+{
+    m_channelDedupe.configure(options);
+}
+void AdapterInstance::setLogDedupe(const LogDedupeOptions &options)
+{
+    std::vector<LogEntry> summaries;
+    m_logDedupe.configure(options, &summaries);
+    if (m_dispatcher) {
+        const ScopedInstanceIdentity identityScope(m_identity);
+        sendLogEntries(*m_dispatcher, m_externalId, m_pluginType, summaries, nullptr);
+    }
+}
+bool AdapterInstance::flushLogDedupe(phicore::adapter::v1::Utf8String *error)
+{
+    std::vector<LogEntry> summaries;
+    m_logDedupe.flush(&summaries);
+    if (!m_dispatcher || summaries.empty())
+        return true;
+    const ScopedInstanceIdentity identityScope(m_identity);
+    return sendLogEntries(*m_dispatcher, m_externalId, m_pluginType, summaries, error);
+}
+
+void AdapterInstance::setFlightRecorder(const FlightRecorderOptions &options)
+{
+    m_flightRecorder.configure(options);
+}
+
+bool AdapterInstance::flushFlightRecorder(const phicore::adapter::v1::Utf8String &streamId,
+                                          const phicore::adapter::v1::Utf8String &cmd,
+                                          std::int64_t *seq,
+                                          phicore::adapter::v1::Utf8String *error)
+{
+    if (!m_dispatcher) {
+        if (error)
+            *error = "Dispatcher not bound";
+        return false;
+    }
+    static constexpr std::size_t kEntriesPerFrame = 64;
+    std::uint64_t dropped = 0;
+    const std::vector<std::string> entries = m_flightRecorder.take(0, &dropped);
+    const ScopedInstanceIdentity identityScope(m_identity);
+    bool ok = true;
+    std::size_t at = 0;
+    do {
+        const std::size_t end = std::min(entries.size(), at + kEntriesPerFrame);
+        std::string data = "{\"entries\":[";
+        for (std::size_t i = at; i < end; ++i) {
+            if (i > at)
+                data.push_back(',');
+            data += entries[i];
+        }
+        data += "],\"dropped\":";
+        appendInteger(data, at == 0 ? dropped : 0);
+        data.push_back('}');
+        ok = m_dispatcher->sendStreamData(
+                 m_externalId, streamId, cmd, (*seq)++, TrustedJson::assumeValid(std::move(data)), 0, error)
+            && ok;
+        at = end;
+    } while (at < entries.size());
+    return ok;
+}
+ChannelStateDedupeStats AdapterInstance::channelStateDedupeStats() const
+{
+    return m_channelDedupe.stats();
+}
+void AdapterInstance::setChannelFilter(const phicore::adapter::v1::ExternalId &deviceExternalId,
+                                       const phicore::adapter::v1::ExternalId &channelExternalId,
+                                       const NumericChannelFilter &filter)
+{
+    m_channelFilters.set(deviceExternalId, channelExternalId, filter);
+}
+void AdapterInstance::clearChannelFilter(const phicore::adapter::v1::ExternalId &deviceExternalId,
+                                         const phicore::adapter::v1::ExternalId &channelExternalId)
+{
+    m_channelFilters.clear(deviceExternalId, channelExternalId);
+}
+bool AdapterInstance::publishHeldChannelStates(phicore::adapter::v1::Utf8String *error)
+{
+    if (!m_dispatcher)
+        return false;
+    std::vector<ChannelStateUpdate> due = m_channelFilters.takeDue();
+    const bool deduped = m_channelDedupe.enabled();
+    if (deduped) {
+        std::erase_if(due, [this](const ChannelStateUpdate &update) {
+            return !m_channelDedupe.admit(update.deviceExternalId, update.channelExternalId, update.value);
+        });
+    }
+    if (due.empty())
+        return true;
+    const ScopedInstanceIdentity identityScope(m_identity);
+    if (m_dispatcher->sendChannelStatesUpdated(m_externalId, due, error))
+        return true;
+    if (deduped) {
+        for (const ChannelStateUpdate &update : due)
+            m_channelDedupe.forget(update.deviceExternalId, update.channelExternalId);
+    }
+    return false;
 }
 bool AdapterInstance::sendDeviceUpdated(const Device &device,
                                         const ChannelList &channels,
                                         phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendDeviceUpdated(m_externalId, device, channels, error) : false;
 }
 bool AdapterInstance::sendDeviceRemoved(const phicore::adapter::v1::ExternalId &deviceExternalId,
                                         phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendDeviceRemoved(m_externalId, deviceExternalId, error) : false;
 }
 bool AdapterInstance::sendChannelUpdated(const phicore::adapter::v1::ExternalId &deviceExternalId,
                                          const Channel &channel,
                                          phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendChannelUpdated(m_externalId, deviceExternalId, channel, error) : false;
 }
+void AdapterInstance::invalidateTopologyCache()
+{
+    if (m_dispatcher)
+        m_dispatcher->invalidateTopologyCache(m_externalId);
+}
 bool AdapterInstance::sendRoomUpdated(const Room &room, phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendRoomUpdated(m_externalId, room, error) : false;
 }
 bool AdapterInstance::sendRoomRemoved(const phicore::adapter::v1::ExternalId &roomExternalId,
                                       phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendRoomRemoved(m_externalId, roomExternalId, error) : false;
 }
 bool AdapterInstance::sendGroupUpdated(const Group &group, phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendGroupUpdated(m_externalId, group, error) : false;
 }
 bool AdapterInstance::sendGroupRemoved(const phicore::adapter::v1::ExternalId &groupExternalId,
                                        phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendGroupRemoved(m_externalId, groupExternalId, error) : false;
 }
 bool AdapterInstance::sendSceneUpdated(const Scene &scene, phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendSceneUpdated(m_externalId, scene, error) : false;
 }
 bool AdapterInstance::sendSceneRemoved(const phicore::adapter::v1::ExternalId &sceneExternalId,
                                        phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendSceneRemoved(m_externalId, sceneExternalId, error) : false;
 }
 bool AdapterInstance::sendStreamOpen(const phicore::adapter::v1::Utf8String &streamId,
@@ -3380,6 +7059,7 @@ bool AdapterInstance::sendStreamOpen(const phicore::adapter::v1::Utf8String &str
                                      const phicore::adapter::v1::JsonText &metaJson,
                                      phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher
         ? m_dispatcher->sendStreamOpen(
             m_externalId, streamId, cmd, kind, contentType, contentEncoding, metaJson, error)
@@ -3392,6 +7072,31 @@ bool AdapterInstance::sendStreamData(const phicore::adapter::v1::Utf8String &str
                                      std::int64_t tsMs,
                                      phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
+    return m_dispatcher
+        ? m_dispatcher->sendStreamData(m_externalId, streamId, cmd, seq, payloadJson, tsMs, error)
+        : false;
+}
+bool AdapterInstance::sendStreamData(const phicore::adapter::v1::Utf8String &streamId,
+                                     const phicore::adapter::v1::Utf8String &cmd,
+                                     std::int64_t seq,
+                                     const std::function<void(JsonWriter &)> &writeData,
+                                     std::int64_t tsMs,
+                                     phicore::adapter::v1::Utf8String *error)
+{
+    const ScopedInstanceIdentity identityScope(m_identity);
+    return m_dispatcher
+        ? m_dispatcher->sendStreamData(m_externalId, streamId, cmd, seq, writeData, tsMs, error)
+        : false;
+}
+bool AdapterInstance::sendStreamData(const phicore::adapter::v1::Utf8String &streamId,
+                                     const phicore::adapter::v1::Utf8String &cmd,
+                                     std::int64_t seq,
+                                     const TrustedJson &payloadJson,
+                                     std::int64_t tsMs,
+                                     phicore::adapter::v1::Utf8String *error)
+{
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher
         ? m_dispatcher->sendStreamData(m_externalId, streamId, cmd, seq, payloadJson, tsMs, error)
         : false;
@@ -3404,6 +7109,7 @@ bool AdapterInstance::sendStreamError(const phicore::adapter::v1::Utf8String &st
                                       const phicore::adapter::v1::Utf8String &ctx,
                                       phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher
         ? m_dispatcher->sendStreamError(m_externalId, streamId, cmd, message, code, params, ctx, error)
         : false;
@@ -3413,10 +7119,16 @@ bool AdapterInstance::sendStreamEnd(const phicore::adapter::v1::Utf8String &stre
                                     const phicore::adapter::v1::Utf8String &reason,
                                     phicore::adapter::v1::Utf8String *error)
 {
+    const ScopedInstanceIdentity identityScope(m_identity);
     return m_dispatcher ? m_dispatcher->sendStreamEnd(m_externalId, streamId, cmd, reason, error) : false;
 }
 bool AdapterInstance::sendResult(const phicore::adapter::v1::CmdResponse &response,
                                  phicore::adapter::v1::Utf8String *error)
+{
+    return sendResult(phicore::adapter::v1::CmdResponse(response), error);
+}
+bool AdapterInstance::sendResult(phicore::adapter::v1::CmdResponse &&response,
+                                 phicore::adapter::v1::Utf8String *error)
 {
     if (!m_cmdResultSubmitter) {
         if (error)
@@ -3428,11 +7140,16 @@ bool AdapterInstance::sendResult(const phicore::adapter::v1::CmdResponse &respon
             *error = "CmdResponse.id must be > 0";
         return false;
     }
-    m_cmdResultSubmitter(response);
+    m_cmdResultSubmitter(std::move(response));
     return true;
 }
 bool AdapterInstance::sendResult(const phicore::adapter::v1::ActionResponse &response,
                                  phicore::adapter::v1::Utf8String *error)
+{
+    return sendResult(phicore::adapter::v1::ActionResponse(response), error);
+}
+bool AdapterInstance::sendResult(phicore::adapter::v1::ActionResponse &&response,
+                                 phicore::adapter::v1::Utf8String *error)
 {
     if (!m_actionResultSubmitter) {
         if (error)
@@ -3444,14 +7161,14 @@ bool AdapterInstance::sendResult(const phicore::adapter::v1::ActionResponse &res
             *error = "ActionResponse.id must be > 0";
         return false;
     }
-    m_actionResultSubmitter(response);
+    m_actionResultSubmitter(std::move(response));
     return true;
 }
 
 void AdapterInstance::bindDispatcher(SidecarDispatcher *dispatcher) { m_dispatcher = dispatcher; }
 void AdapterInstance::bindResultSubmitters(
-    std::function<void(const phicore::adapter::v1::CmdResponse &)> cmdSubmitter,
-    std::function<void(const phicore::adapter::v1::ActionResponse &)> actionSubmitter)
+    std::function<void(phicore::adapter::v1::CmdResponse &&)> cmdSubmitter,
+    std::function<void(phicore::adapter::v1::ActionResponse &&)> actionSubmitter)
 {
     m_cmdResultSubmitter = std::move(cmdSubmitter);
     m_actionResultSubmitter = std::move(actionSubmitter);
@@ -3463,6 +7180,7 @@ void AdapterInstance::bindContext(int adapterId,
     m_adapterId = adapterId;
     m_pluginType = std::move(pluginType);
     m_externalId = std::move(externalId);
+    m_identity->bind(m_externalId, m_pluginType);
 }
 void AdapterInstance::cacheConfig(const ConfigChangedRequest &request)
 {
@@ -3486,14 +7204,33 @@ bool AdapterInstance::hostStart()
     m_stopRequested.store(false, std::memory_order_release);
     return start();
 }
-void AdapterInstance::hostStop() { stop(); }
+void AdapterInstance::hostStop()
+{
+    stop();
+    flushLogDedupe();
+}
 bool AdapterInstance::hostRestart()
 {
     m_stopRequested.store(false, std::memory_order_release);
     return restart();
 }
-void AdapterInstance::hostOnConnected() { onConnected(); }
+void AdapterInstance::hostOnConnected()
+{
+    // A new core session has no values yet.
+    m_channelDedupe.clear();
+    m_channelFilters.reset();
+    onConnected();
+}
 void AdapterInstance::hostOnDisconnected() { onDisconnected(); }
+std::chrono::steady_clock::time_point AdapterInstance::hostNextChannelStateDue() const
+{
+    return m_channelFilters.active() ? m_channelFilters.nextDue() : std::chrono::steady_clock::time_point::max();
+}
+bool AdapterInstance::hostClaimDueChannelStates(std::chrono::steady_clock::time_point now)
+{
+    return m_channelFilters.active() && m_channelFilters.claimDue(now);
+}
+void AdapterInstance::hostPublishDueChannelStates() { publishHeldChannelStates(); }
 void AdapterInstance::hostOnProtocolError(const phicore::adapter::v1::Utf8String &message) { onProtocolError(message); }
 void AdapterInstance::hostOnConfigChanged(const ConfigChangedRequest &request)
 {
@@ -3511,6 +7248,11 @@ void AdapterInstance::hostOnUnknownRequest(const UnknownRequest &request) { onUn
 
 
 #undef m_stopRequested
+#undef m_identity
+#undef m_channelDedupe
+#undef m_channelFilters
+#undef m_logDedupe
+#undef m_flightRecorder
 #undef m_actionResultSubmitter
 #undef m_cmdResultSubmitter
 #undef m_logFilter
@@ -3526,6 +7268,10 @@ struct SidecarHost::InstanceRuntime {
     phicore::adapter::v1::ExternalId externalId;
     std::unique_ptr<AdapterInstance> instance;
     std::unique_ptr<InstanceExecutionBackend> execution;
+    // Non-owning handle to `instance`. Routed request tasks hold it weakly and
+    // skip the instance once teardown has reset it, so a task a stuck backend
+    // runs late never reaches an instance that was given up.
+    std::shared_ptr<AdapterInstance> handle;
 };
 
 struct SidecarHost::Impl {
@@ -3555,8 +7301,8 @@ SidecarHost::SidecarHost(phicore::adapter::v1::Utf8String socketPath, std::uniqu
     m_impl->factory = m_impl->ownedFactory.get();
     if (m_impl->factory) {
         m_impl->factory->bindDispatcher(&m_impl->dispatcher);
-        m_impl->factory->bindResultSubmitter([this](const phicore::adapter::v1::ActionResponse &response) {
-            queueDeferredResult(DeferredActionResult{normalizeActionResponse(response)});
+        m_impl->factory->bindResultSubmitter([this](phicore::adapter::v1::ActionResponse &&response) {
+            queueDeferredResult(DeferredActionResult{normalizeActionResponse(std::move(response))});
         });
     }
     wireHandlers();
@@ -3567,8 +7313,8 @@ SidecarHost::SidecarHost(phicore::adapter::v1::Utf8String socketPath, AdapterFac
 {
     m_impl->factory = &factory;
     m_impl->factory->bindDispatcher(&m_impl->dispatcher);
-    m_impl->factory->bindResultSubmitter([this](const phicore::adapter::v1::ActionResponse &response) {
-        queueDeferredResult(DeferredActionResult{normalizeActionResponse(response)});
+    m_impl->factory->bindResultSubmitter([this](phicore::adapter::v1::ActionResponse &&response) {
+        queueDeferredResult(DeferredActionResult{normalizeActionResponse(std::move(response))});
     });
     wireHandlers();
 }
@@ -3673,7 +7419,14 @@ void SidecarHost::shutdownFactoryExecution(std::chrono::milliseconds budget)
 bool SidecarHost::pollOnce(std::chrono::milliseconds timeout, phicore::adapter::v1::Utf8String *error)
 {
     drainDeferredResults();
+    const auto nextDue = publishDueChannelStates();
     m_dispatcher.flushSendQueue(nullptr);
+    // Wake up for the next held or max-age channel state; the instance's
+    // publish interrupts the poll through the wake descriptor.
+    if (nextDue != std::chrono::steady_clock::time_point::max()) {
+        const auto untilDue = std::chrono::ceil<std::chrono::milliseconds>(nextDue - std::chrono::steady_clock::now());
+        timeout = std::clamp(untilDue, std::chrono::milliseconds(0), timeout);
+    }
     const bool ok = m_dispatcher.pollOnce(timeout, error);
     drainDeferredResults();
     m_dispatcher.flushSendQueue(nullptr);
@@ -3692,20 +7445,18 @@ const AdapterInstance *SidecarHost::instance(const phicore::adapter::v1::Externa
 SidecarDispatcher *SidecarHost::dispatcher() { return &m_dispatcher; }
 const SidecarDispatcher *SidecarHost::dispatcher() const { return &m_dispatcher; }
 
-phicore::adapter::v1::CmdResponse SidecarHost::normalizeCmdResponse(const phicore::adapter::v1::CmdResponse &response)
+phicore::adapter::v1::CmdResponse SidecarHost::normalizeCmdResponse(phicore::adapter::v1::CmdResponse response)
 {
-    CmdResponse out = response;
-    if (out.tsMs <= 0)
-        out.tsMs = nowMs();
-    return out;
+    if (response.tsMs <= 0)
+        response.tsMs = nowMs();
+    return response;
 }
 
-phicore::adapter::v1::ActionResponse SidecarHost::normalizeActionResponse(const phicore::adapter::v1::ActionResponse &response)
+phicore::adapter::v1::ActionResponse SidecarHost::normalizeActionResponse(phicore::adapter::v1::ActionResponse response)
 {
-    ActionResponse out = response;
-    if (out.tsMs <= 0)
-        out.tsMs = nowMs();
-    return out;
+    if (response.tsMs <= 0)
+        response.tsMs = nowMs();
+    return response;
 }
 
 AdapterInstance *SidecarHost::findInstance(const phicore::adapter::v1::ExternalId &externalId)
@@ -3788,11 +7539,11 @@ bool SidecarHost::createInstanceRuntime(const ConfigChangedRequest &request, phi
 
     createdInstance->bindDispatcher(&m_dispatcher);
     createdInstance->bindResultSubmitters(
-        [this](const phicore::adapter::v1::CmdResponse &response) {
-            queueDeferredResult(DeferredCmdResult{normalizeCmdResponse(response)});
+        [this](phicore::adapter::v1::CmdResponse &&response) {
+            queueDeferredResult(DeferredCmdResult{normalizeCmdResponse(std::move(response))});
         },
-        [this](const phicore::adapter::v1::ActionResponse &response) {
-            queueDeferredResult(DeferredActionResult{normalizeActionResponse(response)});
+        [this](phicore::adapter::v1::ActionResponse &&response) {
+            queueDeferredResult(DeferredActionResult{normalizeActionResponse(std::move(response))});
         });
     createdInstance->bindContext(request.adapterId, request.adapter.pluginType, request.adapter.externalId);
 
@@ -3872,6 +7623,7 @@ bool SidecarHost::createInstanceRuntime(const ConfigChangedRequest &request, phi
             *error = "Instance runtime already exists";
         return false;
     }
+    runtime->handle = std::shared_ptr<AdapterInstance>(runtime->instance.get(), [](AdapterInstance *) {});
     it->second = std::move(runtime);
     return true;
 }
@@ -3918,6 +7670,30 @@ void SidecarHost::executeOnAllRuntimes(const std::function<void(AdapterInstance
     }
 }
 
+std::chrono::steady_clock::time_point SidecarHost::publishDueChannelStates()
+{
+    const auto now = std::chrono::steady_clock::now();
+    auto nextDue = std::chrono::steady_clock::time_point::max();
+    for (const auto &entry : m_instances) {
+        InstanceRuntime *runtime = entry.second.get();
+        if (!runtime || !runtime->instance || !runtime->execution)
+            continue;
+        AdapterInstance *instance = runtime->instance.get();
+        if (instance->hostClaimDueChannelStates(now)) {
+            phicore::adapter::v1::Utf8String error;
+            if (!runtime->execution->execute([instance]() {
+                    instance->hostPublishDueChannelStates();
+                }, &error)) {
+                // The claim stays, so a stopped backend is not retried on every poll.
+                reportProtocolError("Failed to dispatch held channel states for externalId='"
+                                    + runtime->externalId + "': " + error);
+            }
+        }
+        nextDue = std::min(nextDue, instance->hostNextChannelStateDue());
+    }
+    return nextDue;
+}
+
 bool SidecarHost::executeOnFactory(std::function<void()> task, phicore::adapter::v1::Utf8String *error)
 {
     if (!task) {
@@ -4059,6 +7835,9 @@ void SidecarHost::stopAndDestroyInstance(const phicore::adapter::v1::ExternalId
                                            + externalId + "': " + stopError);
         }
     }
+    runtime->handle.reset();
+    // A recreated instance with this id must announce its devices in full.
+    m_dispatcher.invalidateTopologyCache(externalId);
 
     if (forced) {
         // The backend did not come back within its budget, so a thread may still
@@ -4397,6 +8176,94 @@ void SidecarHost::wireHandlers()
         }
     };
     m_dispatcher.setHandlers(std::move(handlers));
+
+    // Instance-scoped requests skip the handlers above when the instance is
+    // known: the poll thread only routes, and the typed decode runs as part of
+    // the task on the instance's backend. Unknown instances are declined and
+    // left to the handlers; a task the backend refuses is answered here, once.
+    m_dispatcher.setRequestRouter([this](const SidecarDispatcher::RoutedRequest &routed) {
+        InstanceRuntime *runtime = findRuntime(routed.externalId);
+        if (!runtime || !runtime->handle || !runtime->execution)
+            return false;
+        const std::weak_ptr<AdapterInstance> handle = runtime->handle;
+        const char *what = nullptr;
+        std::function<void()> task;
+        switch (routed.command) {
+        case IpcCommand::CmdChannelInvoke:
+            what = "channel invoke";
+            task = [handle, routed]() {
+                if (const auto instance = handle.lock())
+                    instance->hostOnChannelInvoke(routed.decode(kChannelInvokeFields));
+            };
+            break;
+        case IpcCommand::CmdAdapterActionInvoke:
+            what = "adapter action";
+            task = [handle, routed]() {
+                if (const auto instance = handle.lock())
+                    instance->hostOnAdapterActionInvoke(routed.decode(kAdapterActionInvokeFields));
+            };
+            break;
+        case IpcCommand::CmdDeviceNameUpdate:
+            what = "device.name.update";
+            task = [handle, routed]() {
+                if (const auto instance = handle.lock())
+                    instance->hostOnDeviceNameUpdate(routed.decode(kDeviceNameUpdateFields));
+            };
+            break;
+        case IpcCommand::CmdDeviceEffectInvoke:
+            what = "device.effect.invoke";
+            task = [handle, routed]() {
+                if (const auto instance = handle.lock())
+                    instance->hostOnDeviceEffectInvoke(routed.decode(kDeviceEffectInvokeFields));
+            };
+            break;
+        case IpcCommand::CmdSceneInvoke:
+            what = "scene invoke";
+            task = [handle, routed]() {
+                if (const auto instance = handle.lock())
+                    instance->hostOnSceneInvoke(routed.decode(kSceneInvokeFields));
+            };
+            break;
+        case IpcCommand::CmdAdaptersStreamStart:
+            what = "adapters stream.start";
+            task = [handle, routed]() {
+                if (const auto instance = handle.lock())
+                    instance->hostOnAdaptersStreamStart(routed.decode(kAdaptersStreamStartFields));
+            };
+            break;
+        case IpcCommand::CmdAdaptersStreamStop:
+            what = "adapters stream.stop";
+            task = [handle, routed]() {
+                if (const auto instance = handle.lock())
+                    instance->hostOnAdaptersStreamStop(routed.decode(kAdaptersStreamStopFields));
+            };
+            break;
+        default:
+            return false;
+        }
+        phicore::adapter::v1::Utf8String dispatchError;
+        if (runtime->execution->execute(std::move(task), &dispatchError))
+            return true;
+        const phicore::adapter::v1::Utf8String message
+            = std::string("Failed to dispatch ") + what + ": " + dispatchError;
+        if (routed.command == IpcCommand::CmdAdapterActionInvoke) {
+            ActionResponse response;
+            response.id = routed.cmdId;
+            response.resultType = ActionResultType::None;
+            response.tsMs = nowMs();
+            response.status = CmdStatus::InvalidArgument;
+            response.error = message;
+            m_dispatcher.sendActionResult(response, nullptr);
+        } else {
+            CmdResponse response;
+            response.id = routed.cmdId;
+            response.tsMs = nowMs();
+            response.status = CmdStatus::InvalidArgument;
+            response.error = message;
+            m_dispatcher.sendCmdResult(response, nullptr);
+        }
+        return true;
+    });
 }
 
 #undef m_resultQueue
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "phi/adapter/sdk/sidecar.h"
+#include "phi/adapter/v1/ipc_command.h"
+
+namespace phicore::adapter::sdk::wire {
+
+/// JSON shape of one payload member.
+enum class FieldKind : std::uint8_t {
+    String,
+    Integer,
+    Boolean,
+    Number,
+    Scalar,
+    ScalarList,
+    StringList,
+    Json,
+    Object,
+    ObjectList,
+};
+
+/// Name and shape of one member, as exported for contract tests.
+struct FieldInfo {
+    std::string_view key;
+    FieldKind kind = FieldKind::Json;
+};
+
+/**
+ * @brief One wire member bound to a C++ struct.
+ *
+ * `decode` receives the raw JSON value token (a view into the frame) and
+ * assigns the member; `encode` appends the member's JSON value. `present`
+ * gates optional members on the encode side (nullptr = always written). The
+ * decoder and the encoder of a struct are the same table, so a field cannot
+ * be renamed or retyped on one side only.
+ */
+template <typename T>
+struct Field {
+    std::string_view key;
+    FieldKind kind = FieldKind::Json;
+    void (*decode)(T &target, std::string_view token) = nullptr;
+    void (*encode)(std::string &out, const T &source) = nullptr;
+    bool (*present)(const T &source) = nullptr;
+};
+
+/// Seeded FNV-1a; the seed is what the perfect-hash search varies.
+[[nodiscard]] constexpr std::uint32_t keyHash(std::string_view key, std::uint32_t seed) noexcept
+{
+    std::uint32_t hash = 2166136261U ^ (seed * 0x9e3779b9U);
+    for (const char ch : key) {
+        hash ^= static_cast<std::uint8_t>(ch);
+        hash *= 16777619U;
+    }
+    return hash ^ (hash >> 15);
+}
+
+[[nodiscard]] constexpr std::size_t slotCountFor(std::size_t fields) noexcept
+{
+    std::size_t slots = 2;
+    while (slots < fields * 2)
+        slots *= 2;
+    return slots;
+}
+
+/**
+ * @brief Field table with a collision-free key index computed at compile time.
+ *
+ * The constructor searches for a hash seed under which every key lands in its
+ * own slot; a lookup is then one hash, one slot load and one compare that
+ * rejects unknown keys. A table whose keys cannot be placed (duplicate keys)
+ * does not compile.
+ */
+template <typename T, std::size_t N>
+class Table
+{
+public:
+    static constexpr std::size_t kSlots = slotCountFor(N);
+
+    consteval explicit Table(const std::array<Field<T>, N> &fields)
+        : m_fields(fields)
+    {
+        for (std::size_t a = 0; a < N; ++a) {
+            for (std::size_t b = a + 1; b < N; ++b) {
+                if (m_fields[a].key == m_fields[b].key)
+                    throw "wire::Table: duplicate key";
+            }
+        }
+        for (std::uint32_t seed = 1; seed < 100000; ++seed) {
+            if (place(seed)) {
+                m_seed = seed;
+                return;
+            }
+        }
+        throw "wire::Table: no perfect hash seed found";
+    }
+
+    [[nodiscard]] constexpr const Field<T> *find(std::string_view key) const noexcept
+    {
+        const std::uint8_t slot = m_slots[keyHash(key, m_seed) & (kSlots - 1)];
+        if (slot == 0)
+            return nullptr;
+        const Field<T> &field = m_fields[slot - 1];
+        return field.key == key ? &field : nullptr;
+    }
+
+    [[nodiscard]] constexpr std::span<const Field<T>> fields() const noexcept { return m_fields; }
+
+    [[nodiscard]] constexpr std::array<FieldInfo, N> info() const noexcept
+    {
+        std::array<FieldInfo, N> out{};
+        for (std::size_t i = 0; i < N; ++i)
+            out[i] = FieldInfo{m_fields[i].key, m_fields[i].kind};
+        return out;
+    }
+
+private:
+    constexpr bool place(std::uint32_t seed)
+    {
+        m_slots = {};
+        for (std::size_t i = 0; i < N; ++i) {
+            std::uint8_t &slot = m_slots[keyHash(m_fields[i].key, seed) & (kSlots - 1)];
+            if (slot != 0)
+                return false;
+            slot = static_cast<std::uint8_t>(i + 1);
+        }
+        return true;
+    }
+
+    std::array<Field<T>, N> m_fields;
+    std::array<std::uint8_t, kSlots> m_slots{};
+    std::uint32_t m_seed = 0;
+};
+
+/**
+ * @brief Members of the payload object of `command`, in encode order.
+ *
+ * Covers every core -> adapter request and the table-driven results. Empty
+ * for commands whose payload is not described by a table.
+ */
+std::span<const FieldInfo> payloadSchema(phicore::adapter::v1::IpcCommand command);
+
+/**
+ * @brief Members of a record object nested in an event payload.
+ *
+ * `member` is the payload key that carries the record (`device`, `channel`,
+ * `room`, `group`, `scene`) or `adapter` for the bootstrap/config identity.
+ */
+std::span<const FieldInfo> recordSchema(std::string_view member);
+
+/**
+ * @brief Decodes a request payload object exactly as the dispatcher does.
+ *
+ * Payload members of `*out` are overwritten in place, so decoding repeatedly
+ * into the same request reuses its string storage; envelope fields (cmdId,
+ * correlationId) are not touched. A payload that is not a JSON object decodes
+ * as an empty request. Exposed for benchmarks and
+ * contract tests; the dispatcher calls the same code.
+ */
+void decodeRequest(std::string_view payloadJson, BootstrapRequest *out);
+void decodeRequest(std::string_view payloadJson, ConfigChangedRequest *out);
+void decodeRequest(std::string_view payloadJson, InstanceRemovedRequest *out);
+void decodeRequest(std::string_view payloadJson, ChannelInvokeRequest *out);
+void decodeRequest(std::string_view payloadJson, AdapterActionInvokeRequest *out);
+void decodeRequest(std::string_view payloadJson, DeviceNameUpdateRequest *out);
+void decodeRequest(std::string_view payloadJson, DeviceEffectInvokeRequest *out);
+void decodeRequest(std::string_view payloadJson, SceneInvokeRequest *out);
+void decodeRequest(std::string_view payloadJson, AdaptersStreamStartRequest *out);
+void decodeRequest(std::string_view payloadJson, AdaptersStreamStopRequest *out);
+
+/**
+ * @brief Reference expansion of interned logs, as the core applies it.
+ *
+ * Fed one session's adapter -> core event payloads in order, it records each
+ * `EventLogTemplate` and rebuilds every `EventLogRef` into the `EventLog`
+ * payload the dispatcher sends with templates off, byte for byte. Other
+ * payloads pass through unchanged. Exposed for contract tests.
+ */
+class LogTemplateExpander
+{
+public:
+    /// `*out` receives the expanded payload; it is left empty for a template
+    /// frame. False for a malformed frame or a ref to an unknown template.
+    bool expand(std::string_view payload, std::string *out, std::string *error = nullptr);
+    void clear() { m_templates.clear(); }
+
+private:
+    // Raw JSON tokens, copied into the expansion verbatim.
+    struct Template {
+        std::string plugin;
+        std::string category;
+        std::string message;
+        std::string ctx;
+    };
+    std::unordered_map<std::uint64_t, Template> m_templates;
+};
+
+} // namespace phicore::adapter::sdk::wire
@@ -0,0 +1,263 @@
+// Allocation-counting tests. Global operator new/delete are replaced to count
+// the bytes each thread allocates, so these live in their own binary rather
+// than instrumenting every other test:
+// - rvalue send overloads move large payloads instead of copying them
+// - PHI_LOG_* macros build no arguments for logs the filter drops
+#include "phi/adapter/sdk/sidecar.h"
+#include "test_support.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Bytes allocated by the current thread, for tests that count copies.
+thread_local std::size_t t_allocatedBytes = 0;
+
+namespace {
+
+void *countedAlloc(std::size_t size)
+{
+    t_allocatedBytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *countedAlignedAlloc(std::size_t size, std::align_val_t alignment)
+{
+    t_allocatedBytes += size;
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc() wants a size that is a multiple of the alignment.
+    const std::size_t rounded = size == 0 ? align : (size + align - 1) / align * align;
+    return std::aligned_alloc(align, rounded);
+}
+
+// Out of line: inlined into a delete expression, free() on memory from
+// operator new trips GCC's -Wmismatched-new-delete.
+[[gnu::noinline]] void releaseMemory(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    if (void *memory = countedAlloc(size))
+        return memory;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size)
+{
+    if (void *memory = countedAlloc(size))
+        return memory;
+    throw std::bad_alloc();
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    if (void *memory = countedAlignedAlloc(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void *memory = countedAlignedAlloc(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedAlignedAlloc(size, alignment);
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedAlignedAlloc(size, alignment);
+}
+
+// Both allocators above hand out malloc-family memory, so every delete form
+// frees it.
+void operator delete(void *memory) noexcept { releaseMemory(memory); }
+void operator delete[](void *memory) noexcept { releaseMemory(memory); }
+void operator delete(void *memory, std::size_t) noexcept { releaseMemory(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { releaseMemory(memory); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { releaseMemory(memory); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { releaseMemory(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { releaseMemory(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { releaseMemory(memory); }
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept { releaseMemory(memory); }
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept { releaseMemory(memory); }
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept { releaseMemory(memory); }
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept { releaseMemory(memory); }
+
+namespace sdk = phicore::adapter::sdk;
+namespace v1 = phicore::adapter::v1;
+using phitest::TestClient;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// Exposes the protected send API so tests can drive it from outside.
+class SendingInstance final : public sdk::AdapterInstance
+{
+public:
+    using sdk::AdapterInstance::sendChannelStateUpdated;
+    using sdk::AdapterInstance::sendChannelStatesUpdated;
+    using sdk::AdapterInstance::sendResult;
+
+protected:
+    bool start() override { return true; }
+};
+
+class SendingFactory final : public sdk::AdapterFactory
+{
+public:
+    SendingInstance *created = nullptr;
+
+protected:
+    v1::Utf8String pluginType() const override { return "test.identity \"frames\""; }
+    std::unique_ptr<sdk::AdapterInstance> createInstance(const v1::ExternalId &) override
+    {
+        auto instance = std::make_unique<SendingInstance>();
+        created = instance.get();
+        return instance;
+    }
+};
+
+template <typename Fn>
+std::size_t allocatedBytesDuring(Fn &&fn)
+{
+    const std::size_t before = t_allocatedBytes;
+    fn();
+    return t_allocatedBytes - before;
+}
+
+// A payload handed over as an rvalue reaches the queued frame or result
+// without being copied; the const& overloads still copy it once.
+void testRvalueSendsMovePayloads()
+{
+    const std::string path = phitest::uniqueSocketPath("rvaluesends");
+    auto factory = std::make_unique<SendingFactory>();
+    SendingFactory *factoryPtr = factory.get();
+    sdk::SidecarHost host(path, std::move(factory));
+    v1::Utf8String err;
+    REQUIRE(host.start(&err));
+
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const std::string config = "{\"command\":258,\"cmdId\":1,\"payload\":{"
+                               "\"adapterId\":1,\"pluginType\":\"test.identity \\\"frames\\\"\","
+                               "\"externalId\":\"inst-1\",\"enabled\":true}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 1, config));
+    const auto deadline = Clock::now() + std::chrono::seconds(3);
+    while (host.instance("inst-1") == nullptr && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(factoryPtr->created != nullptr);
+    SendingInstance *instance = factoryPtr->created;
+    sdk::SidecarDispatcher *dispatcher = host.dispatcher();
+
+    // Large enough to dwarf the fixed per-send bookkeeping, small enough to
+    // stay a deferred event (encoded at flush, not at the call).
+    constexpr std::size_t kPayloadBytes = 2048;
+    const v1::Utf8String text(kPayloadBytes, 'x');
+
+    v1::ActionResponse response;
+    response.id = 7;
+    response.formValuesJson = "{\"blob\":\"" + text + "\"}";
+    std::size_t copied = allocatedBytesDuring([&] { CHECK(instance->sendResult(response)); });
+    std::size_t moved = allocatedBytesDuring([&] { CHECK(instance->sendResult(std::move(response))); });
+    CHECK_MSG(copied >= kPayloadBytes && moved < kPayloadBytes, "action result copied=%zu moved=%zu", copied, moved);
+
+    v1::CmdResponse cmdResponse;
+    cmdResponse.id = 8;
+    cmdResponse.error = text;
+    copied = allocatedBytesDuring([&] { CHECK(instance->sendResult(cmdResponse)); });
+    moved = allocatedBytesDuring([&] { CHECK(instance->sendResult(std::move(cmdResponse))); });
+    CHECK_MSG(copied >= kPayloadBytes && moved < kPayloadBytes, "cmd result copied=%zu moved=%zu", copied, moved);
+
+    sdk::LogEntry entry;
+    entry.message = text;
+    entry.ctx = "ctx";
+    copied = allocatedBytesDuring([&] { CHECK(dispatcher->sendLog("inst-1", "test.plugin", entry, nullptr)); });
+    moved = allocatedBytesDuring(
+        [&] { CHECK(dispatcher->sendLog("inst-1", "test.plugin", std::move(entry), nullptr)); });
+    CHECK_MSG(copied >= kPayloadBytes && moved < kPayloadBytes, "log copied=%zu moved=%zu", copied, moved);
+
+    sdk::ScalarValue value = text;
+    copied = allocatedBytesDuring([&] { CHECK(instance->sendChannelStateUpdated("dev-1", "name", value)); });
+    moved = allocatedBytesDuring(
+        [&] { CHECK(instance->sendChannelStateUpdated("dev-1", "name", std::move(value))); });
+    CHECK_MSG(copied >= kPayloadBytes && moved < kPayloadBytes, "state copied=%zu moved=%zu", copied, moved);
+
+    std::vector<sdk::ChannelStateUpdate> updates = {{"dev-1", "name", text, 0}, {"dev-1", "label", text, 0}};
+    copied = allocatedBytesDuring(
+        [&] { CHECK(instance->sendChannelStatesUpdated(std::span<const sdk::ChannelStateUpdate>(updates))); });
+    moved = allocatedBytesDuring([&] { CHECK(instance->sendChannelStatesUpdated(std::move(updates))); });
+    CHECK_MSG(copied >= 2 * kPayloadBytes && moved < kPayloadBytes, "batch copied=%zu moved=%zu", copied, moved);
+
+    host.stop();
+}
+
+// A filtered-out macro log evaluates none of its arguments and allocates
+// nothing; an enabled one still reaches log().
+void testFilteredLogMacrosBuildNothing()
+{
+    const std::string path = phitest::uniqueSocketPath("logmacros");
+    auto factory = std::make_unique<SendingFactory>();
+    SendingFactory *factoryPtr = factory.get();
+    sdk::SidecarHost host(path, std::move(factory));
+    v1::Utf8String err;
+    REQUIRE(host.start(&err));
+
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const std::string config = "{\"command\":258,\"cmdId\":1,\"payload\":{\"adapterId\":1,\"adapter\":{"
+                               "\"externalId\":\"inst-1\",\"pluginType\":\"test.identity \\\"frames\\\"\","
+                               "\"flags\":4,\"meta\":{\"logging\":{\"minLevel\":\"info\"}}}}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 1, config));
+    const auto deadline = Clock::now() + std::chrono::seconds(3);
+    while ((host.instance("inst-1") == nullptr || !factoryPtr->created->hasConfig()) && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(factoryPtr->created != nullptr);
+    SendingInstance &instance = *factoryPtr->created;
+
+    CHECK(!instance.isLogEnabled(sdk::LogLevel::Trace, sdk::LogCategory::Device));
+    CHECK(!instance.isLogEnabled(sdk::LogLevel::Debug, sdk::LogCategory::Device));
+    CHECK(instance.isLogEnabled(sdk::LogLevel::Info, sdk::LogCategory::Device));
+    CHECK(instance.isLogEnabled(sdk::LogLevel::Error, sdk::LogCategory::Device));
+
+    int evaluated = 0;
+    const auto params = [&evaluated]() {
+        ++evaluated;
+        return v1::ScalarList{v1::Utf8String(256, 'p')};
+    };
+    const std::size_t bytes = allocatedBytesDuring([&] {
+        CHECK(PHI_LOG_TRACE(instance, sdk::LogCategory::Device, "trace %1", params(), "ctx"));
+        CHECK(PHI_LOG_DEBUG(instance, sdk::LogCategory::Device, "debug %1", params(), "ctx"));
+    });
+    CHECK_MSG(evaluated == 0 && bytes == 0, "evaluated=%d bytes=%zu", evaluated, bytes);
+    CHECK(PHI_LOG_WITH_SOURCE(instance, sdk::LogLevel::Info, sdk::LogCategory::Device, "info %1", params(), "ctx"));
+    CHECK(evaluated == 1);
+
+    host.stop();
+}
+
+} // namespace
+
+int main()
+{
+    testRvalueSendsMovePayloads();
+    testFilteredLogMacrosBuildNothing();
+
+    if (phitest::g_failures == 0) {
+        std::printf("allocation_tests: all passed\n");
+        return 0;
+    }
+    std::printf("allocation_tests: %d failure(s)\n", phitest::g_failures);
+    return 1;
+}
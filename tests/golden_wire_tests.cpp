@@ -11,9 +11,14 @@
 // canonical request frames exactly as phi-core sends them. They are decoded
 // through the dispatcher and the resulting typed payloads are asserted, so
 // parser drift against the documented request shapes is caught mechanically.
+//
+// Schema: the members of every fixture are checked against the compile-time
+// field tables the dispatcher decodes and encodes with (src/wire_schema.h), so
+// a fixture cannot drift from the tables either.
 #include "phi/adapter/sdk/sidecar.h"
 #include "phi/adapter/v1/ipc_command.h"
 #include "test_support.h"
+#include "wire_schema.h"
 
 #include <chrono>
 #include <cstdio>
@@ -21,6 +26,9 @@
 #include <fstream>
 #include <functional>
 #include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -208,9 +216,44 @@ struct InboundCase {
     std::function<void(const InboundCapture &)> verify;
 };
 
+// Compares `payload` with out/<name>.json, or rewrites the file in update mode.
+void checkOutboundGolden(const char *name, const std::string &payload, bool updateMode, int *updated)
+{
+    const std::string goldenPath = std::string(PHI_GOLDEN_DIR) + "/out/" + name + ".json";
+    if (updateMode) {
+        if (writeFileText(goldenPath, payload))
+            ++*updated;
+        else
+            CHECK_MSG(false, "%s: cannot write golden file", name);
+        return;
+    }
+
+    std::string expected;
+    if (!readFileText(goldenPath, &expected)) {
+        CHECK_MSG(false, "%s: missing golden file %s (run with PHI_GOLDEN_UPDATE=1)", name, goldenPath.c_str());
+        return;
+    }
+    if (payload != expected) {
+        CHECK_MSG(false, "%s: wire payload drifted from golden", name);
+        std::printf("  expected: %s\n  actual:   %s\n", expected.c_str(), payload.c_str());
+    }
+}
+
+sdk::LogEntry connectedLogEntry()
+{
+    sdk::LogEntry entry;
+    entry.level = sdk::LogLevel::Info;
+    entry.category = sdk::LogCategory::Network;
+    entry.message = "Connected to %1";
+    entry.params = {v1::Utf8String("bridge.local")};
+    entry.ctx = "demo.connect";
+    entry.fieldsJson = "{\"attempt\":1}";
+    entry.tsMs = kFixedTsMs;
+    return entry;
+}
+
 void runOutboundCases(sdk::SidecarDispatcher &dispatcher, TestClient &client, bool updateMode)
 {
-    const std::string goldenDir = std::string(PHI_GOLDEN_DIR) + "/out/";
     const std::vector<OutboundCase> cases = {
         {"cmd_result", v1::MessageType::Response, [](sdk::SidecarDispatcher &d) {
              v1::CmdResponse r;
@@ -246,15 +289,7 @@ void runOutboundCases(sdk::SidecarDispatcher &dispatcher, TestClient &client, bo
              return d.sendConnectionStateChanged("inst-1", true, nullptr);
          }},
         {"log_event", v1::MessageType::Event, [](sdk::SidecarDispatcher &d) {
-             sdk::LogEntry entry;
-             entry.level = sdk::LogLevel::Info;
-             entry.category = sdk::LogCategory::Network;
-             entry.message = "Connected to %1";
-             entry.params = {v1::Utf8String("bridge.local")};
-             entry.ctx = "demo.connect";
-             entry.fieldsJson = "{\"attempt\":1}";
-             entry.tsMs = kFixedTsMs;
-             return d.sendLog("inst-1", "demo", entry, nullptr);
+             return d.sendLog("inst-1", "demo", connectedLogEntry(), nullptr);
          }},
         {"error_incident", v1::MessageType::Event, [](sdk::SidecarDispatcher &d) {
              return d.sendError("inst-1", "demo", sdk::LogCategory::Network,
@@ -334,26 +369,7 @@ void runOutboundCases(sdk::SidecarDispatcher &dispatcher, TestClient &client, bo
         }
         CHECK_MSG(v1::messageType(header) == testCase.expectedType,
                   "%s: frame type %d", testCase.name, static_cast<int>(header.type));
-
-        const std::string goldenPath = goldenDir + testCase.name + ".json";
-        if (updateMode) {
-            if (writeFileText(goldenPath, payload))
-                ++updated;
-            else
-                CHECK_MSG(false, "%s: cannot write golden file", testCase.name);
-            continue;
-        }
-
-        std::string expected;
-        if (!readFileText(goldenPath, &expected)) {
-            CHECK_MSG(false, "%s: missing golden file %s (run with PHI_GOLDEN_UPDATE=1)",
-                      testCase.name, goldenPath.c_str());
-            continue;
-        }
-        if (payload != expected) {
-            CHECK_MSG(false, "%s: wire payload drifted from golden", testCase.name);
-            std::printf("  expected: %s\n  actual:   %s\n", expected.c_str(), payload.c_str());
-        }
+        checkOutboundGolden(testCase.name, payload, updateMode, &updated);
     }
     if (updateMode)
         std::printf("golden update: wrote %d outbound fixtures to %sout/\n", updated,
@@ -372,6 +388,13 @@ void runInboundCases(sdk::SidecarDispatcher &dispatcher, TestClient &client,
              CHECK(c.bootstrap->adapter.pluginType == "demo");
              CHECK(c.bootstrap->adapter.externalId.empty());
              CHECK(phitest::contains(c.bootstrap->staticConfigJson, "_hue._tcp"));
+             CHECK(!c.bootstrap->logTemplates);
+         }},
+        {"sync_adapter_bootstrap_log_templates", 18, [](const InboundCapture &c) {
+             REQUIRE(c.bootstrap.has_value());
+             CHECK(c.bootstrap->cmdId == 18);
+             CHECK(c.bootstrap->adapter.pluginType == "demo");
+             CHECK(c.bootstrap->logTemplates);
          }},
         {"sync_adapter_config_changed", 8, [](const InboundCapture &c) {
              REQUIRE(c.configChanged.has_value());
@@ -467,6 +490,226 @@ void runInboundCases(sdk::SidecarDispatcher &dispatcher, TestClient &client,
     }
 }
 
+// Runs after the bootstrap fixture announced `logTemplates`: the first log of
+// a template registers it, later ones are refs, and the reference expander
+// turns the stream back into the plain EventLog payloads. A message without
+// placeholders is only registered once it repeats.
+void runLogTemplateCases(sdk::SidecarDispatcher &dispatcher, TestClient &client, bool updateMode)
+{
+    sdk::LogEntry retry = connectedLogEntry();
+    retry.params = {v1::Utf8String("bridge.lan")};
+    retry.fieldsJson.clear();
+    CHECK(dispatcher.sendLog("inst-1", "demo", connectedLogEntry(), nullptr));
+    CHECK(dispatcher.sendLog("inst-1", "demo", retry, nullptr));
+    CHECK(dispatcher.sendError("inst-1", "demo", sdk::LogCategory::Network, "Connection lost", {},
+                               "demo.disconnect", "{}", kFixedTsMs, nullptr));
+    dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+
+    std::vector<std::string> frames;
+    v1::FrameHeader header{};
+    std::string payload;
+    while (frames.size() < 4 && client.readFrame(2000, &header, &payload))
+        frames.push_back(payload);
+    REQUIRE(frames.size() == 4);
+
+    int updated = 0;
+    checkOutboundGolden("log_template", frames[0], updateMode, &updated);
+    checkOutboundGolden("log_ref", frames[1], updateMode, &updated);
+    CHECK_MSG(frames[2].size() < frames[1].size(), "ref without fields: %s", frames[2].c_str());
+    checkOutboundGolden("error_incident", frames[3], updateMode, &updated);
+    if (updateMode)
+        return;
+
+    sdk::wire::LogTemplateExpander expander;
+    std::vector<std::string> expanded;
+    for (const std::string &frame : frames) {
+        std::string out;
+        std::string error;
+        CHECK_MSG(expander.expand(frame, &out, &error), "expand failed: %s", error.c_str());
+        if (!out.empty())
+            expanded.push_back(out);
+    }
+    REQUIRE(expanded.size() == 3);
+    std::string logEvent;
+    REQUIRE(readFileText(std::string(PHI_GOLDEN_DIR) + "/out/log_event.json", &logEvent));
+    CHECK_MSG(expanded[0] == logEvent, "expanded: %s", expanded[0].c_str());
+    std::string retryEvent = logEvent;
+    retryEvent.replace(retryEvent.find("bridge.local"), 12, "bridge.lan");
+    retryEvent.replace(retryEvent.find("{\"attempt\":1}"), 13, "{}");
+    CHECK_MSG(expanded[1] == retryEvent, "expanded: %s", expanded[1].c_str());
+    CHECK(expanded[2] == frames[3]);
+
+    std::string out;
+    std::string error;
+    expander.clear();
+    CHECK(!expander.expand(frames[1], &out, &error));
+    CHECK(phitest::contains(error, "Unknown log template"));
+
+    sdk::LogEntry oneOff = connectedLogEntry();
+    oneOff.message = "Bridge rebooted";
+    oneOff.params.clear();
+    CHECK(dispatcher.sendLog("inst-1", "demo", oneOff, nullptr));
+    CHECK(dispatcher.sendLog("inst-1", "demo", oneOff, nullptr));
+    dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    frames.clear();
+    while (frames.size() < 3 && client.readFrame(2000, &header, &payload))
+        frames.push_back(payload);
+    REQUIRE(frames.size() == 3);
+    CHECK_MSG(phitest::contains(frames[0], "\"command\":4101,"), "first: %s", frames[0].c_str());
+    CHECK_MSG(phitest::contains(frames[1], "\"command\":4102,"), "second: %s", frames[1].c_str());
+    CHECK_MSG(phitest::contains(frames[2], "\"command\":4103,"), "second: %s", frames[2].c_str());
+}
+
+// ---------------------------------------------------------------------------
+// Schema coverage
+// ---------------------------------------------------------------------------
+
+using Members = std::vector<std::pair<std::string, std::string>>;
+
+// Top-level members of a well-formed JSON object (keys without escapes, as in
+// all fixtures); values are returned as raw text.
+Members objectMembers(std::string_view json)
+{
+    Members out;
+    std::size_t i = json.find('{');
+    if (i == std::string_view::npos)
+        return out;
+    ++i;
+    while (i < json.size()) {
+        const std::size_t keyStart = json.find('"', i);
+        if (keyStart == std::string_view::npos)
+            break;
+        const std::size_t keyEnd = json.find('"', keyStart + 1);
+        const std::size_t valueStart = json.find(':', keyEnd) + 1;
+        int depth = 0;
+        bool inString = false;
+        std::size_t j = valueStart;
+        for (; j < json.size(); ++j) {
+            const char ch = json[j];
+            if (inString) {
+                if (ch == '\\')
+                    ++j;
+                else if (ch == '"')
+                    inString = false;
+            } else if (ch == '"') {
+                inString = true;
+            } else if (ch == '{' || ch == '[') {
+                ++depth;
+            } else if (ch == '}' || ch == ']') {
+                if (depth == 0)
+                    break;
+                --depth;
+            } else if (ch == ',' && depth == 0) {
+                break;
+            }
+        }
+        out.emplace_back(std::string(json.substr(keyStart + 1, keyEnd - keyStart - 1)),
+                         std::string(json.substr(valueStart, j - valueStart)));
+        if (j >= json.size() || json[j] == '}')
+            break;
+        i = j + 1;
+    }
+    return out;
+}
+
+std::string memberValue(const Members &members, std::string_view key)
+{
+    for (const auto &[name, value] : members) {
+        if (name == key)
+            return value;
+    }
+    return {};
+}
+
+// Every member is known to the schema; inbound member order is free.
+bool knownToSchema(const Members &members, std::span<const sdk::wire::FieldInfo> schema)
+{
+    for (const auto &member : members) {
+        bool known = false;
+        for (const auto &field : schema)
+            known = known || field.key == member.first;
+        if (!known)
+            return false;
+    }
+    return true;
+}
+
+// Every member is known to the schema and appears in encode order.
+bool followsSchema(const Members &members, std::span<const sdk::wire::FieldInfo> schema)
+{
+    std::size_t next = 0;
+    for (const auto &member : members) {
+        while (next < schema.size() && schema[next].key != member.first)
+            ++next;
+        if (next == schema.size())
+            return false;
+        ++next;
+    }
+    return true;
+}
+
+bool matchesSchema(const Members &members, std::span<const sdk::wire::FieldInfo> schema)
+{
+    return members.size() == schema.size() && followsSchema(members, schema);
+}
+
+v1::IpcCommand fixtureCommand(const Members &root)
+{
+    return static_cast<v1::IpcCommand>(std::stoi(memberValue(root, "command")));
+}
+
+void runSchemaCases()
+{
+    const std::string inDir = std::string(PHI_GOLDEN_DIR) + "/in/";
+    const char *inbound[] = {
+        "sync_adapter_bootstrap", "sync_adapter_bootstrap_log_templates", "sync_adapter_config_changed",
+        "sync_adapter_instance_removed",
+        "cmd_channel_invoke", "cmd_adapter_action_invoke", "cmd_device_name_update",
+        "cmd_device_effect_invoke", "cmd_scene_invoke", "cmd_adapters_stream_start",
+        "cmd_adapters_stream_stop",
+    };
+    for (const char *name : inbound) {
+        std::string request;
+        REQUIRE(readFileText(inDir + name + ".json", &request));
+        const Members root = objectMembers(request);
+        const auto schema = sdk::wire::payloadSchema(fixtureCommand(root));
+        CHECK_MSG(!schema.empty(), "%s: command has no payload schema", name);
+        const Members payload = objectMembers(memberValue(root, "payload"));
+        CHECK_MSG(knownToSchema(payload, schema), "%s: payload members outside the schema", name);
+        const std::string adapter = memberValue(payload, "adapter");
+        if (!adapter.empty()) {
+            CHECK_MSG(knownToSchema(objectMembers(adapter), sdk::wire::recordSchema("adapter")),
+                      "%s: adapter members outside the schema", name);
+        }
+    }
+
+    const std::string outDir = std::string(PHI_GOLDEN_DIR) + "/out/";
+    const std::pair<const char *, const char *> records[] = {
+        {"device_updated", "device"},
+        {"channel_updated", "channel"},
+        {"room_updated", "room"},
+        {"group_updated", "group"},
+        {"scene_updated", "scene"},
+    };
+    for (const auto &[name, record] : records) {
+        std::string event;
+        REQUIRE(readFileText(outDir + name + ".json", &event));
+        const Members payload = objectMembers(memberValue(objectMembers(event), "payload"));
+        CHECK_MSG(matchesSchema(objectMembers(memberValue(payload, record)), sdk::wire::recordSchema(record)),
+                  "%s: %s members differ from the schema", name, record);
+    }
+
+    for (const char *name : {"cmd_result", "cmd_result_error", "action_result"}) {
+        std::string result;
+        REQUIRE(readFileText(outDir + name + ".json", &result));
+        const Members root = objectMembers(result);
+        const auto schema = sdk::wire::payloadSchema(fixtureCommand(root));
+        CHECK_MSG(!schema.empty(), "%s: command has no payload schema", name);
+        CHECK_MSG(followsSchema(objectMembers(memberValue(root, "payload")), schema),
+                  "%s: payload members outside the schema", name);
+    }
+}
+
 } // namespace
 
 int main()
@@ -512,6 +755,8 @@ int main()
 
     runOutboundCases(dispatcher, client, updateMode);
     runInboundCases(dispatcher, client, capture);
+    runLogTemplateCases(dispatcher, client, updateMode);
+    runSchemaCases();
 
     dispatcher.stop();
 
@@ -0,0 +1,249 @@
+// Structural-index tests for the inbound JSON scanner (src/json_scan.cpp):
+// - every kernel the CPU supports produces the same bitmaps as a sequential
+//   reference walk, on random text dense in quotes and backslashes
+// - escape runs crossing 64-byte block boundaries
+// - the canonical inbound fixtures (tests/golden/in) index identically
+//   under every kernel
+// - the string escaper: every kernel matches the byte-at-a-time reference on a
+//   fuzz corpus and on the golden fixtures (tests/golden/in and out)
+#include "json_scan.h"
+#include "test_support.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef PHI_GOLDEN_DIR
+#error "PHI_GOLDEN_DIR must be defined by the build system"
+#endif
+
+namespace json = phicore::adapter::sdk::json;
+using Kernel = json::StructuralIndex::Kernel;
+
+namespace {
+
+const Kernel kKernels[] = {Kernel::Scalar, Kernel::Sse2, Kernel::Avx2};
+
+// Sequential reference: a backslash escapes the next byte unless it is itself
+// escaped; only unescaped quotes delimit strings.
+void referenceBits(const std::string &text, std::vector<std::uint64_t> *quotes, std::vector<std::uint64_t> *backslashes)
+{
+    const std::size_t blocks = (text.size() + 63) / 64;
+    quotes->assign(blocks, 0);
+    backslashes->assign(blocks, 0);
+    bool escaped = false;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const std::uint64_t bit = std::uint64_t{1} << (i & 63);
+        if (text[i] == '\\')
+            (*backslashes)[i >> 6] |= bit;
+        if (text[i] == '"' && !escaped)
+            (*quotes)[i >> 6] |= bit;
+        escaped = !escaped && text[i] == '\\';
+    }
+}
+
+bool checkText(const std::string &text, Kernel kernel)
+{
+    std::vector<std::uint64_t> quotes;
+    std::vector<std::uint64_t> backslashes;
+    referenceBits(text, &quotes, &backslashes);
+
+    json::StructuralIndex index;
+    index.build(text, kernel);
+    if (index.quoteBits() != quotes || index.backslashBits() != backslashes)
+        return false;
+
+    // nextQuote() from every position agrees with a linear search.
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        std::size_t expected = i + 1;
+        while (expected < text.size() && !((quotes[expected >> 6] >> (expected & 63)) & 1U))
+            ++expected;
+        const char *got = index.nextQuote(text.data() + i);
+        const std::size_t gotPos = got ? static_cast<std::size_t>(got - text.data()) : text.size();
+        if (gotPos != expected)
+            return false;
+    }
+    return true;
+}
+
+void testKernelsMatchReference()
+{
+    std::mt19937 rng(0x5eed);
+    const char alphabet[] = {'"', '\\', 'a', ' ', '{', '}', ':', ',', '\xc3', '\x9f'};
+    std::uniform_int_distribution<std::size_t> pick(0, sizeof(alphabet) - 1);
+    std::uniform_int_distribution<std::size_t> length(0, 300);
+    for (int round = 0; round < 2000; ++round) {
+        std::string text(length(rng), ' ');
+        for (char &ch : text)
+            ch = alphabet[pick(rng)];
+        for (const Kernel kernel : kKernels) {
+            CHECK_MSG(checkText(text, kernel), "kernel=%s len=%zu",
+                      json::StructuralIndex::kernelName(kernel), text.size());
+        }
+    }
+}
+
+void testEscapeRunsAcrossBlocks()
+{
+    // Backslash runs of every length ending at every offset around the first
+    // block boundary, each followed by a quote.
+    for (std::size_t run = 1; run <= 5; ++run) {
+        for (std::size_t end = 60; end <= 68; ++end) {
+            std::string text(end - run, 'x');
+            text.append(run, '\\');
+            text.append("\"tail\"");
+            const bool quoteEscaped = (run % 2) == 1;
+            json::StructuralIndex index;
+            for (const Kernel kernel : kKernels) {
+                index.build(text, kernel);
+                CHECK(index.isQuote(text.data() + end) == !quoteEscaped);
+                CHECK(checkText(text, kernel));
+            }
+        }
+    }
+}
+
+void testAnyBackslash()
+{
+    const std::string text = std::string(70, 'a') + "\\" + std::string(70, 'b');
+    json::StructuralIndex index;
+    index.build(text);
+    const char *base = text.data();
+    CHECK(!index.anyBackslash(base, base + 70));
+    CHECK(index.anyBackslash(base, base + 71));
+    CHECK(index.anyBackslash(base + 70, base + 71));
+    CHECK(!index.anyBackslash(base + 71, base + text.size()));
+    CHECK(!index.anyBackslash(base + 10, base + 10));
+}
+
+void testGoldenFixturesIndexIdentically()
+{
+    const std::filesystem::path dir = std::filesystem::path(PHI_GOLDEN_DIR) / "in";
+    std::size_t seen = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::ostringstream buffer;
+        buffer << in.rdbuf();
+        const std::string text = buffer.str();
+        ++seen;
+        for (const Kernel kernel : kKernels) {
+            CHECK_MSG(checkText(text, kernel), "fixture=%s kernel=%s",
+                      entry.path().filename().c_str(), json::StructuralIndex::kernelName(kernel));
+        }
+    }
+    CHECK(seen > 0);
+}
+
+// Byte-at-a-time escaper the SDK shipped before the vectorized one.
+std::string referenceQuoted(std::string_view text)
+{
+    std::string out = "\"";
+    for (const char ch : text) {
+        switch (ch) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                constexpr char kHex[] = "0123456789abcdef";
+                out += "\\u00";
+                out.push_back(kHex[(ch >> 4) & 0x0f]);
+                out.push_back(kHex[ch & 0x0f]);
+            } else {
+                out.push_back(ch);
+            }
+            break;
+        }
+    }
+    out.push_back('"');
+    return out;
+}
+
+bool quotesLikeReference(std::string_view text, Kernel kernel)
+{
+    // Appends after existing content, as the envelope encoders do.
+    std::string out = "prefix";
+    json::appendQuoted(out, text, kernel);
+    return out == "prefix" + referenceQuoted(text);
+}
+
+void testQuotedMatchesReference()
+{
+    std::mt19937 rng(0xe5c4);
+    // Every escape class, the bytes right around 0x1f/0x20, and bytes >= 0x80
+    // that a signed compare would misclassify as controls.
+    const char alphabet[] = {'"', '\\', 'a', ' ', '/', '\b', '\f', '\n', '\r', '\t',
+                             '\x00', '\x01', '\x1f', '\x7f', '\x80', '\xc3', '\xbc', '\xff'};
+    std::uniform_int_distribution<std::size_t> pick(0, sizeof(alphabet) - 1);
+    std::uniform_int_distribution<std::size_t> length(0, 200);
+    std::uniform_int_distribution<int> sparse(0, 15);
+    for (int round = 0; round < 3000; ++round) {
+        // Mostly plain text with sparse specials, so long clean runs cross the
+        // 16/32-byte strides; every offset into the buffer varies alignment.
+        std::string text(length(rng), 'x');
+        for (char &ch : text) {
+            if (round % 2 == 0 || sparse(rng) == 0)
+                ch = alphabet[pick(rng)];
+        }
+        for (std::size_t offset = 0; offset < std::min<std::size_t>(text.size(), 33); offset += 7) {
+            const std::string_view slice = std::string_view(text).substr(offset);
+            for (const Kernel kernel : kKernels) {
+                CHECK_MSG(quotesLikeReference(slice, kernel), "kernel=%s len=%zu",
+                          json::StructuralIndex::kernelName(kernel), slice.size());
+            }
+        }
+    }
+    for (const Kernel kernel : kKernels)
+        CHECK(quotesLikeReference({}, kernel));
+}
+
+void testGoldenFixturesQuoteIdentically()
+{
+    std::size_t seen = 0;
+    for (const char *sub : {"in", "out"}) {
+        const std::filesystem::path dir = std::filesystem::path(PHI_GOLDEN_DIR) / sub;
+        for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+            std::ifstream in(entry.path(), std::ios::binary);
+            std::ostringstream buffer;
+            buffer << in.rdbuf();
+            ++seen;
+            for (const Kernel kernel : kKernels) {
+                CHECK_MSG(quotesLikeReference(buffer.str(), kernel), "fixture=%s kernel=%s",
+                          entry.path().filename().c_str(), json::StructuralIndex::kernelName(kernel));
+            }
+        }
+    }
+    CHECK(seen > 0);
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("json_scan_tests: best kernel %s\n",
+                json::StructuralIndex::kernelName(json::StructuralIndex::bestKernel()));
+    testKernelsMatchReference();
+    testEscapeRunsAcrossBlocks();
+    testAnyBackslash();
+    testGoldenFixturesIndexIdentically();
+    testQuotedMatchesReference();
+    testGoldenFixturesQuoteIdentically();
+
+    if (phitest::g_failures == 0) {
+        std::printf("json_scan_tests: all passed\n");
+        return 0;
+    }
+    std::printf("json_scan_tests: %d failure(s)\n", phitest::g_failures);
+    return 1;
+}
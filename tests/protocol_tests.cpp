@@ -2,17 +2,26 @@
 // raw frame client (the phi-core side of the socket):
 // - request decode into typed payloads (bootstrap, channel invoke variants)
 // - result/event serialization shapes
+// - batched channel states queued in order as standard frames
+// - device snapshots reduced to the changed channels, or nothing
+// - default timestamps taken from an injected SidecarClock
 // - default response for unknown commands
 // - disconnect on invalid frame headers
 #include "phi/adapter/sdk/sidecar.h"
 #include "phi/adapter/v1/ipc_command.h"
 #include "test_support.h"
 
+#include <atomic>
 #include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace sdk = phicore::adapter::sdk;
@@ -68,7 +77,7 @@ void testBootstrapDecode()
     CHECK(seen->adapter.pluginType == "demo");
     CHECK(seen->adapter.externalId.empty());
     CHECK_MSG(contains(seen->staticConfigJson, "_hue._tcp"),
-              "staticConfigJson=%s", seen->staticConfigJson.c_str());
+              "staticConfigJson=%s", seen->staticConfigJson.str().c_str());
 
     dispatcher.stop();
 }
@@ -152,6 +161,34 @@ void testChannelInvokeDecodeAndResult()
     CHECK(!seen->hasScalarValue);
     CHECK_MSG(contains(seen->valueJson, "\"r\":1"), "valueJson=%s", seen->valueJson.c_str());
 
+    // Escape runs between plain text are copied around the escapes.
+    seen.reset();
+    request = "{\"command\":" + cmd(v1::IpcCommand::CmdChannelInvoke)
+        + ",\"cmdId\":15,\"payload\":{\"externalId\":\"inst-1\","
+          "\"deviceExternalId\":\"dev\\\\9\",\"channelExternalId\":\"ch-2\","
+          "\"value\":\"head\\tmid\\u00fc\\\\tail\"}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 15, request));
+    REQUIRE(poll([&seen]() { return seen.has_value(); }));
+    CHECK_MSG(seen->deviceExternalId == "dev\\9", "deviceExternalId=%s", seen->deviceExternalId.c_str());
+    if (const auto *s = std::get_if<v1::Utf8String>(&seen->value))
+        CHECK_MSG(*s == "head\tmid\xc3\xbc\\tail", "value=%s", s->c_str());
+    else
+        CHECK_MSG(false, "value is not string");
+
+    // Requests are decoded into reused storage: members missing from the next
+    // frame must come back empty, not as the previous frame's values.
+    seen.reset();
+    request = "{\"command\":" + cmd(v1::IpcCommand::CmdChannelInvoke)
+        + ",\"cmdId\":16,\"payload\":{\"externalId\":\"inst-1\"}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 16, request));
+    REQUIRE(poll([&seen]() { return seen.has_value(); }));
+    CHECK(seen->cmdId == 16);
+    CHECK(seen->deviceExternalId.empty());
+    CHECK(seen->channelExternalId.empty());
+    CHECK(seen->valueJson.empty());
+    CHECK(!seen->hasScalarValue);
+    CHECK(std::holds_alternative<std::monostate>(seen->value));
+
     // Result serialization back to the client.
     v1::CmdResponse response;
     response.id = 14;
@@ -252,6 +289,475 @@ void testEventEnvelopeShape()
     CHECK(contains(payload, "\"channelExternalId\":\"ch-2\""));
     CHECK(contains(payload, "\"value\":75"));
 
+    // Escapes at the start, the end and between plain runs, written in place.
+    CHECK(dispatcher.sendChannelStateUpdated("inst-1", "dev-9", "ch-2",
+                                             std::string("\x01plain\t\"q\"\\x\x1f", 13), 0, nullptr));
+    dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr); // flush
+    REQUIRE(client.readFrame(2000, &header, &payload));
+    CHECK_MSG(contains(payload, "\"value\":\"\\u0001plain\\t\\\"q\\\"\\\\x\\u001f\""),
+              "payload=%s", payload.c_str());
+
+    dispatcher.stop();
+}
+
+// The writer separates, escapes and nests by itself, refuses calls that would
+// break the text, and writes stream data straight into the frame.
+void testJsonWriter()
+{
+    sdk::JsonWriter writer;
+    writer.beginObject()
+        .member("name", "lamp \"1\"\n")
+        .member("count", 3)
+        .member("big", std::uint64_t{18446744073709551615U})
+        .member("ratio", 0.5)
+        .member("on", true)
+        .member("value", sdk::ScalarValue(static_cast<std::int64_t>(-7)));
+    writer.key("list").beginArray().value(1).null().beginObject().endObject().endArray();
+    writer.key("nan").value(std::numeric_limits<double>::quiet_NaN());
+    writer.endObject();
+    CHECK(writer.complete());
+    CHECK_MSG(writer.view() == "{\"name\":\"lamp \\\"1\\\"\\n\",\"count\":3,\"big\":18446744073709551615,"
+                               "\"ratio\":0.5,\"on\":true,\"value\":-7,\"list\":[1,null,{}],\"nan\":null}",
+              "json=%s", std::string(writer.view()).c_str());
+    const v1::JsonText taken = writer.take();
+    CHECK(contains(taken, "\"list\":[1,null,{}]"));
+    CHECK(writer.view().empty() && writer.ok() && !writer.complete());
+
+    // Misuse marks the writer failed; nothing after it is written.
+    writer.beginObject().value(1);
+    CHECK(!writer.ok());
+    writer.clear();
+    writer.beginArray().key("k");
+    CHECK(!writer.ok());
+    writer.clear();
+    writer.beginArray().endObject();
+    CHECK(!writer.ok());
+    writer.clear();
+    writer.value(1).value(2);
+    CHECK(!writer.ok());
+    writer.clear();
+    writer.beginObject().key("open");
+    CHECK(writer.ok() && !writer.complete());
+
+    // Appending to a caller's string leaves its earlier text alone.
+    std::string out = "prefix:";
+    sdk::JsonWriter appending(out);
+    appending.beginArray().value("a").endArray();
+    CHECK(appending.complete() && appending.view() == "[\"a\"]" && out == "prefix:[\"a\"]");
+    appending.clear();
+    CHECK(out == "prefix:");
+
+    const std::string path = phitest::uniqueSocketPath("jsonwriter");
+    sdk::SidecarDispatcher dispatcher(path);
+    TestClient client;
+    bool connected = false;
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected = true; };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    REQUIRE(dispatcher.start(&err));
+    REQUIRE(client.connectTo(path));
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!connected && Clock::now() < deadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connected);
+
+    constexpr std::int64_t kTsMs = 1755500000000;
+    CHECK(dispatcher.sendStreamData("inst-1", "s-1", "cmd.stream.start", 3, "{\"line\":\"hello\"}", kTsMs,
+                                    nullptr));
+    CHECK(dispatcher.sendStreamData(
+        "inst-1", "s-1", "cmd.stream.start", 3,
+        [](sdk::JsonWriter &data) { data.beginObject().member("line", "hello").endObject(); }, kTsMs, nullptr));
+    CHECK(dispatcher.sendStreamData(
+        "inst-1", "s-1", "cmd.stream.start", 4, [](sdk::JsonWriter &) {}, kTsMs, nullptr));
+    err.clear();
+    CHECK(!dispatcher.sendStreamData(
+        "inst-1", "s-1", "cmd.stream.start", 5, [](sdk::JsonWriter &data) { data.beginObject(); }, kTsMs, &err));
+    CHECK(contains(err, "complete"));
+
+    std::vector<std::string> frames;
+    const auto readDeadline = Clock::now() + std::chrono::seconds(5);
+    while (frames.size() < 3 && Clock::now() < readDeadline) {
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+        v1::FrameHeader header{};
+        std::string payload;
+        while (client.readFrame(10, &header, &payload))
+            frames.push_back(payload);
+    }
+    REQUIRE(frames.size() == 3);
+    CHECK_MSG(frames[0] == frames[1], "text=%s writer=%s", frames[0].c_str(), frames[1].c_str());
+    CHECK_MSG(contains(frames[2], "\"data\":{}"), "payload=%s", frames[2].c_str());
+
+    dispatcher.stop();
+}
+
+// Outbound validation is opt-in. Once on, a broken fragment is replaced by
+// the member default instead of corrupting the frame; trusted and remembered
+// fragments go out unchanged.
+void testOutboundJsonValidation()
+{
+    const bool validationDefault = sdk::outboundJsonValidation();
+    CHECK(!validationDefault || std::getenv("PHI_ADAPTER_SDK_VALIDATE_JSON") != nullptr);
+    sdk::setOutboundJsonValidation(true);
+    CHECK(sdk::TrustedJson::validate("{\"a\":[1,2,{\"b\":null}]}").has_value());
+    v1::Utf8String err;
+    CHECK(!sdk::TrustedJson::validate("{\"a\":", &err).has_value() && !err.empty());
+    CHECK(!sdk::TrustedJson::validate("[1] [2]").has_value());
+    CHECK(!sdk::TrustedJson::validate(std::string(100000, '[') + std::string(100000, ']')).has_value());
+    sdk::JsonWriter writer;
+    writer.beginObject();
+    CHECK(writer.takeTrusted().empty());
+    writer.beginArray().value(1).endArray();
+    const sdk::TrustedJson fromWriter = writer.takeTrusted();
+    CHECK(fromWriter.view() == "[1]");
+
+    const std::string path = phitest::uniqueSocketPath("jsoncheck");
+    sdk::SidecarDispatcher dispatcher(path);
+    TestClient client;
+    bool connected = false;
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected = true; };
+    dispatcher.setHandlers(std::move(handlers));
+    REQUIRE(dispatcher.start(&err));
+    REQUIRE(client.connectTo(path));
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!connected && Clock::now() < deadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connected);
+
+    const std::string longMeta = "{\"label\":\"" + std::string(80, 'x') + "\"}";
+    CHECK(dispatcher.sendAdapterMetaUpdated("inst-1", "{\"broken\":", nullptr));
+    CHECK(dispatcher.sendAdapterMetaUpdated("inst-1", longMeta, nullptr));
+    CHECK(dispatcher.sendAdapterMetaUpdated("inst-1", longMeta, nullptr));
+    CHECK(dispatcher.sendStreamData("inst-1", "s-1", "cmd.stream.start", 1, fromWriter, 0, nullptr));
+    // A broken promise is still caught while validation is on.
+    CHECK(dispatcher.sendStreamData(
+        "inst-1", "s-1", "cmd.stream.start", 3, sdk::TrustedJson::assumeValid("[1,"), 0, nullptr));
+    sdk::setOutboundJsonValidation(false);
+    CHECK(dispatcher.sendStreamData("inst-1", "s-1", "cmd.stream.start", 2, "[1,", 0, nullptr));
+    sdk::setOutboundJsonValidation(validationDefault);
+
+    std::vector<std::string> frames;
+    const auto readDeadline = Clock::now() + std::chrono::seconds(5);
+    while (frames.size() < 6 && Clock::now() < readDeadline) {
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+        v1::FrameHeader header{};
+        std::string payload;
+        while (client.readFrame(10, &header, &payload))
+            frames.push_back(payload);
+    }
+    REQUIRE(frames.size() == 6);
+    CHECK_MSG(contains(frames[0], "\"metaPatch\":{}"), "payload=%s", frames[0].c_str());
+    CHECK(contains(frames[1], "\"metaPatch\":" + longMeta));
+    CHECK(frames[1] == frames[2]);
+    CHECK_MSG(contains(frames[3], "\"data\":[1]"), "payload=%s", frames[3].c_str());
+    CHECK_MSG(contains(frames[4], "\"data\":{}"), "payload=%s", frames[4].c_str());
+    CHECK(contains(frames[5], "\"data\":[1,"));
+
+    dispatcher.stop();
+}
+
+// A batch goes out as standard frames, in order, byte-identical to the single
+// sends, and nothing queued after it overtakes it.
+void testChannelStatesBatchKeepsOrder()
+{
+    const std::string path = phitest::uniqueSocketPath("statesbatch");
+    sdk::SidecarDispatcher dispatcher(path);
+    TestClient client;
+    bool connected = false;
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected = true; };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    REQUIRE(dispatcher.start(&err));
+    REQUIRE(client.connectTo(path));
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!connected && Clock::now() < deadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connected);
+
+    constexpr std::int64_t kTsMs = 1755500000000;
+    const std::vector<sdk::ChannelStateUpdate> updates = {
+        {"dev-1", "on", true, kTsMs},
+        {"dev-1", "bri", static_cast<std::int64_t>(75), kTsMs + 1},
+        {"dev-\"2\"", "name", v1::Utf8String("lamp\t2"), kTsMs + 2},
+        {"dev-2", "temp", 21.5, 0},
+    };
+    CHECK(dispatcher.sendChannelStatesUpdated("inst-1", std::span<const sdk::ChannelStateUpdate>(), nullptr));
+    CHECK(dispatcher.sendChannelStatesUpdated("inst-1", updates, nullptr));
+    CHECK(dispatcher.sendConnectionStateChanged("inst-1", true, nullptr));
+    for (std::size_t i = 0; i + 1 < updates.size(); ++i) {
+        const sdk::ChannelStateUpdate &update = updates[i];
+        CHECK(dispatcher.sendChannelStateUpdated("inst-1", update.deviceExternalId, update.channelExternalId,
+                                                 update.value, update.tsMs, nullptr));
+    }
+
+    std::vector<std::string> frames;
+    const auto readDeadline = Clock::now() + std::chrono::seconds(5);
+    while (frames.size() < 2 * updates.size() && Clock::now() < readDeadline) {
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+        v1::FrameHeader header{};
+        std::string payload;
+        while (client.readFrame(10, &header, &payload))
+            frames.push_back(payload);
+    }
+    REQUIRE(frames.size() == 2 * updates.size());
+    for (std::size_t i = 0; i + 1 < updates.size(); ++i)
+        CHECK_MSG(frames[i] == frames[updates.size() + 1 + i], "batch frame %zu=%s", i, frames[i].c_str());
+    CHECK_MSG(contains(frames[3], "\"deviceExternalId\":\"dev-2\",\"channelExternalId\":\"temp\",\"value\":21.5,"
+                                  "\"tsMs\":"),
+              "payload=%s", frames[3].c_str());
+    CHECK(!contains(frames[3], "\"tsMs\":0}"));
+    CHECK(contains(frames[4], "\"command\":" + cmd(v1::IpcCommand::EventConnectionStateChanged)));
+
+    dispatcher.stop();
+}
+
+// State and log events are encoded when flushed, but carry what was true when
+// they were sent: caller data, default timestamps and order with eager frames.
+void testDeferredEventsKeepSendTimeState()
+{
+    const std::string path = phitest::uniqueSocketPath("deferred");
+    sdk::SidecarDispatcher dispatcher(path);
+    TestClient client;
+    bool connected = false;
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected = true; };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    REQUIRE(dispatcher.start(&err));
+    REQUIRE(client.connectTo(path));
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!connected && Clock::now() < deadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connected);
+
+    const auto wallMs = [] {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    };
+    v1::Utf8String deviceId = "dev-1";
+    sdk::LogEntry entry;
+    entry.message = "queued";
+    CHECK(dispatcher.sendChannelStateUpdated("inst-1", deviceId, "on", true, 0, nullptr));
+    CHECK(dispatcher.sendConnectionStateChanged("inst-1", true, nullptr));
+    CHECK(dispatcher.sendLog("inst-1", "test.plugin", entry, nullptr));
+    entry.message = v1::Utf8String(8192, 'x');
+    CHECK(dispatcher.sendLog("inst-1", "test.plugin", entry, nullptr));
+    const std::int64_t sentBy = wallMs();
+    deviceId = "dev-changed";
+    entry.message = "changed";
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+    std::vector<std::string> frames;
+    const auto readDeadline = Clock::now() + std::chrono::seconds(5);
+    while (frames.size() < 4 && Clock::now() < readDeadline) {
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+        v1::FrameHeader header{};
+        std::string payload;
+        while (client.readFrame(10, &header, &payload))
+            frames.push_back(payload);
+    }
+    REQUIRE(frames.size() == 4);
+    const auto tsMsOf = [](const std::string &frame) -> std::int64_t {
+        const std::size_t at = frame.rfind("\"tsMs\":");
+        return at == std::string::npos ? 0 : std::stoll(frame.substr(at + 7));
+    };
+    CHECK_MSG(contains(frames[0], "\"deviceExternalId\":\"dev-1\""), "payload=%s", frames[0].c_str());
+    CHECK(contains(frames[1], "\"command\":" + cmd(v1::IpcCommand::EventConnectionStateChanged)));
+    CHECK_MSG(contains(frames[2], "\"message\":\"queued\""), "payload=%s", frames[2].c_str());
+    CHECK(contains(frames[3], v1::Utf8String(8192, 'x')));
+    for (const std::size_t i : {std::size_t{0}, std::size_t{2}, std::size_t{3}}) {
+        const std::int64_t tsMs = tsMsOf(frames[i]);
+        CHECK_MSG(tsMs > 0 && tsMs <= sentBy, "frame %zu tsMs=%lld sentBy=%lld", i,
+                  static_cast<long long>(tsMs), static_cast<long long>(sentBy));
+    }
+
+    dispatcher.stop();
+}
+
+std::atomic<std::int64_t> g_fakeWallMs{0};
+
+// Default stamps come from SidecarClock, so an injected source makes them
+// deterministic; steady time points map onto it and follow a stepped clock.
+void testInjectedClockStampsDefaults()
+{
+    constexpr std::int64_t kWallMs = 1755500000000;
+    g_fakeWallMs.store(kWallMs);
+    sdk::SidecarClock::setSource(+[]() noexcept { return g_fakeWallMs.load(); });
+    CHECK(sdk::SidecarClock::nowMs() == kWallMs);
+
+    const std::string path = phitest::uniqueSocketPath("clock");
+    sdk::SidecarDispatcher dispatcher(path);
+    TestClient client;
+    bool connected = false;
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected = true; };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    REQUIRE(dispatcher.start(&err));
+    REQUIRE(client.connectTo(path));
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!connected && Clock::now() < deadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connected);
+
+    sdk::LogEntry entry;
+    entry.message = "stamped";
+    v1::CmdResponse response;
+    response.id = 7;
+    CHECK(dispatcher.sendChannelStateUpdated("inst-1", "dev-1", "on", true, 0, nullptr));
+    CHECK(dispatcher.sendLog("inst-1", "test.plugin", entry, nullptr));
+    CHECK(dispatcher.sendCmdResult(response, nullptr));
+    CHECK(dispatcher.sendStreamData("inst-1", "s-1", "tail", 1, "{}", 0, nullptr));
+
+    std::vector<std::string> frames;
+    const auto readDeadline = Clock::now() + std::chrono::seconds(5);
+    while (frames.size() < 4 && Clock::now() < readDeadline) {
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+        v1::FrameHeader header{};
+        std::string payload;
+        while (client.readFrame(10, &header, &payload))
+            frames.push_back(payload);
+    }
+    REQUIRE(frames.size() == 4);
+    for (const std::string &frame : frames)
+        CHECK_MSG(contains(frame, "\"tsMs\":" + std::to_string(kWallMs)), "payload=%s", frame.c_str());
+
+    const auto steadyNow = std::chrono::steady_clock::now();
+    const std::int64_t mapped = sdk::SidecarClock::wallMs(steadyNow);
+    CHECK_MSG(mapped >= kWallMs && mapped < kWallMs + 5000, "mapped=%lld", static_cast<long long>(mapped));
+    CHECK(sdk::SidecarClock::wallMs(steadyNow - std::chrono::seconds(2)) == mapped - 2000);
+    g_fakeWallMs.store(kWallMs + 3600000);
+    dispatcher.pollOnce(std::chrono::milliseconds(0), nullptr);
+    CHECK(sdk::SidecarClock::wallMs(steadyNow) - mapped >= 3600000 - 5000);
+
+    dispatcher.stop();
+    sdk::SidecarClock::setSource(nullptr);
+    const std::int64_t systemMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      std::chrono::system_clock::now().time_since_epoch())
+                                      .count();
+    CHECK(std::abs(sdk::SidecarClock::nowMs() - systemMs) < 1000);
+}
+
+// Repeated snapshots only send what changed; removal, invalidation and a new
+// core session bring back full snapshots.
+void testDeviceUpdatedSendsOnlyChanges()
+{
+    const std::string path = phitest::uniqueSocketPath("topology");
+    sdk::SidecarDispatcher dispatcher(path);
+    int connects = 0;
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connects]() { ++connects; };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    REQUIRE(dispatcher.start(&err));
+    auto client = std::make_unique<TestClient>();
+    REQUIRE(client->connectTo(path));
+    auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (connects == 0 && Clock::now() < deadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connects == 1);
+
+    // Everything sent since the last call, up to a connection-state marker.
+    const auto drain = [&]() -> std::vector<std::string> {
+        CHECK(dispatcher.sendConnectionStateChanged("inst-1", true, nullptr));
+        std::vector<std::string> frames;
+        const auto readDeadline = Clock::now() + std::chrono::seconds(5);
+        while (Clock::now() < readDeadline) {
+            dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+            v1::FrameHeader header{};
+            std::string payload;
+            if (!client->readFrame(10, &header, &payload))
+                continue;
+            if (contains(payload, "\"command\":" + cmd(v1::IpcCommand::EventConnectionStateChanged)))
+                break;
+            frames.push_back(payload);
+        }
+        return frames;
+    };
+    const std::string deviceUpdated = "\"command\":" + cmd(v1::IpcCommand::EventDeviceUpdated);
+    const std::string channelUpdated = "\"command\":" + cmd(v1::IpcCommand::EventChannelUpdated);
+
+    v1::Device device;
+    device.externalId = "dev-1";
+    device.name = "Lamp";
+    device.firmware = "1.0";
+    v1::ChannelList channels(2);
+    channels[0].externalId = "on";
+    channels[0].name = "Power";
+    channels[1].externalId = "bri";
+    channels[1].name = "Brightness";
+
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    auto frames = drain();
+    CHECK(frames.size() == 1 && contains(frames[0], deviceUpdated));
+
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    frames = drain();
+    CHECK_MSG(frames.empty(), "unchanged snapshot sent %zu frame(s)", frames.size());
+
+    channels[1].name = "Dimmer";
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    frames = drain();
+    REQUIRE(frames.size() == 1);
+    CHECK_MSG(contains(frames[0], channelUpdated) && contains(frames[0], "\"deviceExternalId\":\"dev-1\"")
+                  && contains(frames[0], "\"name\":\"Dimmer\"") && !contains(frames[0], "\"Power\""),
+              "payload=%s", frames[0].c_str());
+
+    // The same device under another instance is a separate entry.
+    CHECK(dispatcher.sendDeviceUpdated("inst-2", device, channels, nullptr));
+    frames = drain();
+    CHECK(frames.size() == 1 && contains(frames[0], deviceUpdated));
+
+    // sendChannelUpdated keeps the cached snapshot current: the snapshot after
+    // it adds nothing.
+    channels[0].name = "Switch";
+    CHECK(dispatcher.sendChannelUpdated("inst-1", "dev-1", channels[0], nullptr));
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    frames = drain();
+    CHECK(frames.size() == 1 && contains(frames[0], channelUpdated));
+
+    device.firmware = "1.1";
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    frames = drain();
+    CHECK(frames.size() == 1 && contains(frames[0], deviceUpdated));
+
+    channels.pop_back();
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    frames = drain();
+    CHECK(frames.size() == 1 && contains(frames[0], deviceUpdated));
+
+    CHECK(dispatcher.sendDeviceRemoved("inst-1", "dev-1", nullptr));
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    frames = drain();
+    CHECK(frames.size() == 2 && contains(frames[1], deviceUpdated));
+
+    dispatcher.invalidateTopologyCache("inst-1");
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    frames = drain();
+    CHECK(frames.size() == 1 && contains(frames[0], deviceUpdated));
+
+    const sdk::TopologyCacheStats stats = dispatcher.topologyCacheStats();
+    CHECK_MSG(stats.fullSends == 6 && stats.deltaSends == 1 && stats.skippedSends == 2
+                  && stats.skippedChannels == 5,
+              "full=%llu delta=%llu skipped=%llu skippedChannels=%llu",
+              static_cast<unsigned long long>(stats.fullSends), static_cast<unsigned long long>(stats.deltaSends),
+              static_cast<unsigned long long>(stats.skippedSends),
+              static_cast<unsigned long long>(stats.skippedChannels));
+
+    // A new core session knows nothing yet.
+    client = std::make_unique<TestClient>();
+    REQUIRE(client->connectTo(path));
+    deadline = Clock::now() + std::chrono::seconds(5);
+    while (connects < 2 && Clock::now() < deadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connects == 2);
+    CHECK(dispatcher.sendDeviceUpdated("inst-1", device, channels, nullptr));
+    frames = drain();
+    CHECK(frames.size() == 1 && contains(frames[0], deviceUpdated));
+
     dispatcher.stop();
 }
 
@@ -429,6 +935,18 @@ void testBatchedFramesAndEscapedKeys()
               "escaped key did not resolve: %s",
               seenDevices.empty() ? "(none)" : seenDevices[0].c_str());
 
+    // Member storage is reused across frames: a member the next frame does
+    // not carry must decode as absent, not as the previous frame's value.
+    seenOrder.clear();
+    seenDevices.clear();
+    const std::string sparse = "{\"command\":" + cmd(v1::IpcCommand::CmdDeviceNameUpdate)
+        + ",\"cmdId\":61,\"payload\":{\"externalId\":\"inst-1\",\"name\":\"n\"}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 61, sparse));
+    REQUIRE(poll([&seenOrder]() { return !seenOrder.empty(); }));
+    CHECK_MSG(!seenDevices.empty() && seenDevices[0].empty(),
+              "stale member leaked into next frame: %s",
+              seenDevices.empty() ? "(none)" : seenDevices[0].c_str());
+
     dispatcher.stop();
 }
 
@@ -622,6 +1140,85 @@ void testInvalidFrameHeaderDisconnects()
     dispatcher.stop();
 }
 
+void testRequestJsonOutlivesFrame()
+{
+    const std::string path = phitest::uniqueSocketPath("jsonref");
+    sdk::SidecarDispatcher dispatcher(path);
+    TestClient client;
+    bool connected = false;
+    std::vector<sdk::AdapterActionInvokeRequest> seen;
+
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected = true; };
+    handlers.onAdapterActionInvoke = [&seen](const sdk::AdapterActionInvokeRequest &r) { seen.push_back(r); };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    REQUIRE(dispatcher.start(&err));
+    REQUIRE(client.connectTo(path));
+    auto poll = [&dispatcher](const std::function<bool()> &pred) {
+        const auto deadline = Clock::now() + std::chrono::seconds(3);
+        while (!pred() && Clock::now() < deadline)
+            dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+        return pred();
+    };
+    REQUIRE(poll([&connected]() { return connected; }));
+
+    // Copies taken in the handler keep viewing their own frame after later
+    // frames have reused the receive buffer.
+    for (int i = 0; i < 3; ++i) {
+        const std::string n = std::to_string(i);
+        const std::string request = "{\"command\":" + cmd(v1::IpcCommand::CmdAdapterActionInvoke)
+            + ",\"cmdId\":" + std::to_string(40 + i) + ",\"payload\":{\"externalId\":\"inst-1\","
+              "\"actionId\":\"probe\",\"params\":{\"host\":\"bridge-" + n + "\",\"port\":8" + n
+            + ",\"n\\u0061me\":\"x\"}}}";
+        REQUIRE(client.sendFrame(v1::MessageType::Request, static_cast<std::uint64_t>(40 + i), request));
+        REQUIRE(poll([&seen, i]() { return seen.size() == static_cast<std::size_t>(i + 1); }));
+    }
+    for (int i = 0; i < 3; ++i) {
+        const std::string n = std::to_string(i);
+        const sdk::JsonRef &params = seen[static_cast<std::size_t>(i)].paramsJson;
+        CHECK_MSG(params.member("host") == "\"bridge-" + n + "\"", "params=%s", params.str().c_str());
+        CHECK(params.member("port") == "8" + n);
+        CHECK(params.member("name") == "\"x\"");
+        CHECK(params.member("missing").empty());
+        const v1::JsonText legacy = params;
+        CHECK(contains(legacy, "\"host\":\"bridge-" + n + "\""));
+    }
+
+    // A kept request shares the receive buffer; the partial frame read along
+    // with it continues in fresh storage, and the kept view stays intact.
+    seen.clear();
+    std::string batch;
+    for (const int id : {44, 45}) {
+        const std::string request = "{\"command\":" + cmd(v1::IpcCommand::CmdAdapterActionInvoke)
+            + ",\"cmdId\":" + std::to_string(id) + ",\"payload\":{\"externalId\":\"inst-1\","
+              "\"actionId\":\"probe\",\"params\":{\"id\":" + std::to_string(id) + "}}}";
+        v1::FrameHeader header;
+        header.type = static_cast<std::uint8_t>(v1::MessageType::Request);
+        header.correlationId = static_cast<std::uint64_t>(id);
+        header.payloadSize = static_cast<std::uint32_t>(request.size());
+        batch.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        batch += request;
+    }
+    const std::size_t split = batch.size() - 10;
+    REQUIRE(client.sendRaw(batch.data(), split));
+    REQUIRE(poll([&seen]() { return seen.size() == 1; }));
+    REQUIRE(client.sendRaw(batch.data() + split, batch.size() - split));
+    REQUIRE(poll([&seen]() { return seen.size() == 2; }));
+    CHECK_MSG(seen[0].paramsJson == "{\"id\":44}", "params=%s", seen[0].paramsJson.str().c_str());
+    CHECK_MSG(seen[1].paramsJson == "{\"id\":45}", "params=%s", seen[1].paramsJson.str().c_str());
+
+    // A missing params member still reads as an empty object.
+    seen.clear();
+    const std::string bare = "{\"command\":" + cmd(v1::IpcCommand::CmdAdapterActionInvoke)
+        + ",\"cmdId\":43,\"payload\":{\"externalId\":\"inst-1\",\"actionId\":\"probe\"}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 43, bare));
+    REQUIRE(poll([&seen]() { return !seen.empty(); }));
+    CHECK(seen.front().paramsJson == "{}");
+
+    dispatcher.stop();
+}
+
 } // namespace
 
 int main()
@@ -630,6 +1227,12 @@ int main()
     testChannelInvokeDecodeAndResult();
     testUnknownCommandDefaultResponse();
     testEventEnvelopeShape();
+    testJsonWriter();
+    testOutboundJsonValidation();
+    testChannelStatesBatchKeepsOrder();
+    testDeferredEventsKeepSendTimeState();
+    testInjectedClockStampsDefaults();
+    testDeviceUpdatedSendsOnlyChanges();
     testOversizeFrameLimits();
     testLogLevelWireContract();
     testInvalidFrameHeaderDisconnects();
@@ -638,6 +1241,7 @@ int main()
     testClientReplacementFiresHooks();
     testBatchedFramesAndEscapedKeys();
     testHandlerReentrancyIsSafe();
+    testRequestJsonOutlivesFrame();
 
     if (phitest::g_failures == 0) {
         std::printf("protocol_tests: all passed\n");
@@ -2,23 +2,40 @@
 // - outbound wakeup (frames must not wait for the poll timeout)
 // - bounded write deadline against a stalled peer
 // - bounded send queue with shed policy (response frames never shed)
+// - per-thread log rings: thread order kept, overflow dropped and counted,
+//   incidents never shed
 // - stop() interrupting a blocking poll
 // - factory execution backend: blocking factory hooks must not stall the poll
 //   loop, and the default (no backend) must stay inline
 // - abandoned execution threads: accounted for and reaped, and the process
 //   leaves without running static destructors underneath one
+// - pooled instance backends: per-instance order on shared workers, and a
+//   stuck worker replaced rather than blocking the pool
+// - instance-scoped requests decoded on the instance's backend, not the poll
+//   thread
+// - instance sends using identity fragments escaped at bind time produce the
+//   same bytes as the dispatcher encoding from scratch
+// - opt-in channel state dedupe with the core's comparison policy
+// - numeric channel deadband, rate limit and quantization
+// - log dedupe windows and Trace sampling with suppression counts
 #include "phi/adapter/sdk/sidecar.h"
 #include "test_support.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <sys/wait.h>
 #include <thread>
+#include <variant>
+#include <vector>
 
 namespace sdk = phicore::adapter::sdk;
 namespace v1 = phicore::adapter::v1;
@@ -188,6 +205,177 @@ void testQueueCapShedsOldestLogFrames()
     dispatcher.stop();
 }
 
+// Frames received while this thread flushes, until the peer goes quiet.
+std::vector<std::string> drainToClient(sdk::SidecarDispatcher &dispatcher, TestClient &client)
+{
+    std::atomic_bool readerRun{true};
+    std::mutex framesMutex;
+    std::vector<std::string> frames;
+    std::thread reader([&]() {
+        v1::FrameHeader header{};
+        std::string payload;
+        while (readerRun.load()) {
+            if (client.readFrame(100, &header, &payload)) {
+                std::lock_guard<std::mutex> lock(framesMutex);
+                frames.push_back(payload);
+            }
+        }
+    });
+    std::size_t lastCount = 0;
+    auto lastProgress = Clock::now();
+    while (phitest::msSince(lastProgress) < 500) {
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+        std::lock_guard<std::mutex> lock(framesMutex);
+        if (frames.size() != lastCount) {
+            lastCount = frames.size();
+            lastProgress = Clock::now();
+        }
+    }
+    readerRun.store(false);
+    reader.join();
+    return frames;
+}
+
+// Logs go through per-thread rings, yet each thread's logs keep their place
+// among its other frames; a full ring drops new logs without blocking, and an
+// incident survives a saturated queue.
+void testLogRingsKeepThreadOrder()
+{
+    const std::string path = phitest::uniqueSocketPath("logrings");
+    sdk::SidecarDispatcher dispatcher(path);
+    std::atomic_bool connected{false};
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected.store(true); };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    REQUIRE(dispatcher.start(&err));
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const auto connectDeadline = Clock::now() + std::chrono::seconds(5);
+    while (!connected.load() && Clock::now() < connectDeadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connected.load());
+
+    constexpr int kThreads = 4;
+    constexpr int kRounds = 400;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&dispatcher, t]() {
+            const std::string externalId = "t" + std::to_string(t);
+            for (int i = 0; i < kRounds; ++i) {
+                sdk::LogEntry entry;
+                entry.message = "m" + std::to_string(i);
+                CHECK(dispatcher.sendLog(externalId, "test", std::move(entry), nullptr));
+                CHECK(dispatcher.sendChannelStateUpdated(
+                    externalId, "dev", "ch", static_cast<std::int64_t>(i), 0, nullptr));
+            }
+        });
+    }
+    for (std::thread &producer : producers)
+        producer.join();
+    std::vector<std::string> frames = drainToClient(dispatcher, client);
+    CHECK_MSG(frames.size() == 2 * kThreads * kRounds, "received=%zu", frames.size());
+    for (int t = 0; t < kThreads; ++t) {
+        const std::string tag = "\"externalId\":\"t" + std::to_string(t) + "\"";
+        std::vector<std::string> expected;
+        for (int i = 0; i < kRounds; ++i) {
+            expected.push_back("\"message\":\"m" + std::to_string(i) + "\"");
+            expected.push_back("\"value\":" + std::to_string(i) + ",");
+        }
+        std::size_t next = 0;
+        for (const std::string &frame : frames) {
+            if (!phitest::contains(frame, tag))
+                continue;
+            if (next < expected.size() && phitest::contains(frame, expected[next]))
+                ++next;
+            else
+                break;
+        }
+        CHECK_MSG(next == expected.size(), "thread %d in order up to %zu of %zu", t, next, expected.size());
+    }
+
+    // Overflow: the ring keeps the newest kDocumentedQueueMaxDepth logs and
+    // the call still succeeds.
+    sdk::LogEntry flood;
+    bool allAccepted = true;
+    for (std::size_t i = 0; i < kDocumentedQueueMaxDepth + 100; ++i) {
+        flood.message = "flood " + std::to_string(i);
+        allAccepted = dispatcher.sendLog("inst", "test", flood, nullptr) && allAccepted;
+    }
+    CHECK(allAccepted);
+    frames = drainToClient(dispatcher, client);
+    CHECK_MSG(frames.size() == kDocumentedQueueMaxDepth, "received=%zu", frames.size());
+    CHECK(!frames.empty() && phitest::contains(frames.front(), "\"flood 100\""));
+
+    // Logs waiting in a ring count against the queue cap and go before events.
+    constexpr std::size_t kEvents = 500;
+    flood.message = "flood";
+    for (std::size_t i = 0; i + kEvents / 2 < kDocumentedQueueMaxDepth; ++i)
+        CHECK(dispatcher.sendLog("inst", "test", flood, nullptr));
+    for (std::size_t i = 0; i < kEvents; ++i)
+        CHECK(dispatcher.sendConnectionStateChanged("inst", true, nullptr));
+    frames = drainToClient(dispatcher, client);
+    std::size_t events = 0;
+    for (const std::string &frame : frames)
+        events += phitest::contains(frame, "\"connected\":true") ? 1 : 0;
+    CHECK_MSG(frames.size() == kDocumentedQueueMaxDepth && events == kEvents, "received=%zu events=%zu",
+              frames.size(), events);
+
+    // A saturated queue sheds events around an incident, never the incident.
+    for (std::size_t i = 0; i < kDocumentedQueueMaxDepth; ++i)
+        CHECK(dispatcher.sendConnectionStateChanged("inst", true, nullptr));
+    CHECK(dispatcher.sendError("inst", "test", sdk::LogCategory::Device, "incident"));
+    for (std::size_t i = 0; i < kDocumentedQueueMaxDepth; ++i)
+        CHECK(dispatcher.sendConnectionStateChanged("inst", false, nullptr));
+    frames = drainToClient(dispatcher, client);
+    CHECK_MSG(frames.size() == kDocumentedQueueMaxDepth, "received=%zu", frames.size());
+    std::size_t incidents = 0;
+    for (const std::string &frame : frames)
+        incidents += phitest::contains(frame, "\"message\":\"incident\"") ? 1 : 0;
+    CHECK(incidents == 1);
+
+    dispatcher.stop();
+}
+
+// The log throttle rises with the send backlog before any flush and only
+// steps back once the backlog stayed low for a while.
+void testLogThrottleFollowsBacklog()
+{
+    const std::string path = phitest::uniqueSocketPath("logthrottle");
+    sdk::SidecarDispatcher dispatcher(path);
+    std::atomic_bool connected{false};
+    sdk::SidecarHandlers handlers;
+    handlers.onConnected = [&connected]() { connected.store(true); };
+    dispatcher.setHandlers(std::move(handlers));
+    v1::Utf8String err;
+    REQUIRE(dispatcher.start(&err));
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const auto connectDeadline = Clock::now() + std::chrono::seconds(5);
+    while (!connected.load() && Clock::now() < connectDeadline)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(connected.load());
+
+    CHECK(dispatcher.logThrottleLevel() == sdk::LogLevel::Trace);
+    for (std::size_t i = 0; i < kDocumentedQueueMaxDepth / 4; ++i)
+        CHECK(dispatcher.sendConnectionStateChanged("inst", true, nullptr));
+    CHECK(dispatcher.logThrottleLevel() == sdk::LogLevel::Debug);
+    for (std::size_t i = 0; i < kDocumentedQueueMaxDepth / 4; ++i)
+        CHECK(dispatcher.sendConnectionStateChanged("inst", true, nullptr));
+    CHECK(dispatcher.logThrottleLevel() == sdk::LogLevel::Info);
+
+    const auto flushedAt = Clock::now();
+    const std::vector<std::string> frames = drainToClient(dispatcher, client);
+    CHECK_MSG(frames.size() == kDocumentedQueueMaxDepth / 2, "received=%zu", frames.size());
+    while (dispatcher.logThrottleLevel() != sdk::LogLevel::Trace && phitest::msSince(flushedAt) < 5000)
+        dispatcher.pollOnce(std::chrono::milliseconds(10), nullptr);
+    const long calmMs = phitest::msSince(flushedAt);
+    CHECK(dispatcher.logThrottleLevel() == sdk::LogLevel::Trace);
+    CHECK_MSG(calmMs >= 900, "relaxed after %ldms", calmMs);
+
+    dispatcher.stop();
+}
+
 void testStopInterruptsBlockingPoll()
 {
     const std::string path = phitest::uniqueSocketPath("stop");
@@ -471,6 +659,102 @@ void testAbandonedThreadIsReapedNotDetached()
                 phitest::msSince(t0));
 }
 
+// Pooled backends share a few workers but keep the per-instance guarantee of
+// the dedicated-thread backend: one task at a time, in submission order. A
+// stop that times out gives up only the worker stuck in that instance.
+void testPooledBackendsKeepStrandOrder()
+{
+    constexpr std::size_t kInstances = 64;
+    constexpr int kTasks = 200;
+    struct Track {
+        std::atomic<int> inFlight{0};
+        std::atomic<bool> overlapped{false};
+        std::vector<int> seen;
+    };
+    std::vector<Track> tracks(kInstances);
+    std::mutex threadsMutex;
+    std::vector<std::thread::id> threads;
+    std::vector<std::unique_ptr<sdk::InstanceExecutionBackend>> backends;
+    v1::Utf8String err;
+    for (std::size_t i = 0; i < kInstances; ++i) {
+        backends.push_back(sdk::createPooledInstanceExecutionBackend());
+        REQUIRE(backends.back()->start(&err));
+    }
+    for (int task = 0; task < kTasks; ++task) {
+        for (std::size_t i = 0; i < kInstances; ++i) {
+            Track &track = tracks[i];
+            CHECK(backends[i]->execute([&track, &threadsMutex, &threads, task]() {
+                if (track.inFlight.fetch_add(1) != 0)
+                    track.overlapped = true;
+                track.seen.push_back(task);
+                {
+                    std::lock_guard<std::mutex> lock(threadsMutex);
+                    if (std::find(threads.begin(), threads.end(), std::this_thread::get_id()) == threads.end())
+                        threads.push_back(std::this_thread::get_id());
+                }
+                track.inFlight.fetch_sub(1);
+            }, &err));
+        }
+    }
+    for (auto &backend : backends)
+        CHECK(backend->stop(std::chrono::seconds(5), &err));
+    CHECK(!backends[0]->execute([]() {}, &err));
+    for (std::size_t i = 0; i < kInstances; ++i) {
+        CHECK_MSG(!tracks[i].overlapped, "instance %zu ran two tasks at once", i);
+        bool ordered = static_cast<int>(tracks[i].seen.size()) == kTasks;
+        for (int task = 0; ordered && task < kTasks; ++task)
+            ordered = tracks[i].seen[task] == task;
+        CHECK_MSG(ordered, "instance %zu saw %zu tasks out of order", i, tracks[i].seen.size());
+    }
+    const std::size_t poolSize = std::max(2U, std::thread::hardware_concurrency());
+    CHECK_MSG(threads.size() <= poolSize, "%zu threads ran tasks, pool size %zu", threads.size(), poolSize);
+
+    // Every worker blocked until `release`: a strand that is only queued
+    // times out on stop() and its task is dropped, never run later.
+    std::atomic<bool> release{false};
+    std::atomic<std::size_t> entered{0};
+    std::vector<std::unique_ptr<sdk::InstanceExecutionBackend>> blockers;
+    for (std::size_t i = 0; i < poolSize; ++i) {
+        blockers.push_back(sdk::createPooledInstanceExecutionBackend());
+        REQUIRE(blockers.back()->start(&err));
+        CHECK(blockers.back()->execute([&release, &entered]() {
+            entered.fetch_add(1);
+            while (!release.load())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }, &err));
+    }
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (entered.load() < poolSize && Clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    REQUIRE(entered.load() == poolSize);
+    std::atomic<bool> queuedRan{false};
+    auto queued = sdk::createPooledInstanceExecutionBackend();
+    REQUIRE(queued->start(&err));
+    CHECK(queued->execute([&queuedRan]() { queuedRan = true; }, &err));
+    CHECK(!queued->stop(std::chrono::milliseconds(20), &err));
+    CHECK(sdk::reapAbandonedExecutionThreads() == 0);
+
+    // A task that outlives stop(): its worker is abandoned, the others carry on.
+    CHECK(!blockers[0]->stop(std::chrono::milliseconds(20), &err));
+    CHECK(sdk::reapAbandonedExecutionThreads() == 1);
+    for (std::size_t i = 0; i < std::min(poolSize, kInstances); ++i) {
+        std::atomic<bool> ran{false};
+        REQUIRE(backends[i]->start(&err));
+        CHECK(backends[i]->execute([&ran]() { ran = true; }, &err));
+        CHECK(backends[i]->stop(std::chrono::seconds(5), &err));
+        CHECK_MSG(ran, "backend %zu did not run while a worker was stuck", i);
+    }
+    release = true;
+    for (auto &blocker : blockers)
+        CHECK(blocker->stop(std::chrono::seconds(5), &err));
+    CHECK(blockers[0]->start(&err));
+    CHECK(blockers[0]->stop(std::chrono::seconds(1), &err));
+    CHECK(queued->start(&err));
+    CHECK(queued->stop(std::chrono::seconds(1), &err));
+    CHECK(sdk::reapAbandonedExecutionThreads(std::chrono::seconds(2)) == 0);
+    CHECK(!queuedRan);
+}
+
 // The other half of F-35: how the *process* ends when a thread was abandoned.
 // Observable only from outside, so the sidecar runs in a child. Forked before
 // any test has started a thread, which is also what makes the fork safe.
@@ -699,6 +983,678 @@ void testShutdownBudgetIsShared()
                 tookMs, budgetMs);
 }
 
+
+// Records what reached the instance and on which thread; the typed decode runs
+// in the same task, so the hook thread is also the decoding thread.
+class RoutedDecodeInstance final : public sdk::AdapterInstance
+{
+public:
+    std::atomic_int invokes{0};
+    std::thread::id hookThread{};
+    std::string deviceExternalId;
+    double value = 0.0;
+    std::string actionParams;
+
+protected:
+    bool start() override { return true; }
+
+    void onChannelInvoke(const sdk::ChannelInvokeRequest &request) override
+    {
+        hookThread = std::this_thread::get_id();
+        deviceExternalId = request.deviceExternalId;
+        if (const double *number = std::get_if<double>(&request.value))
+            value = *number;
+        invokes.fetch_add(1);
+    }
+
+    void onAdapterActionInvoke(const sdk::AdapterActionInvokeRequest &request) override
+    {
+        actionParams = request.paramsJson.str();
+        invokes.fetch_add(1);
+    }
+};
+
+// Default backend that refuses new tasks while `refuse` is set.
+class RefusingBackend final : public sdk::InstanceExecutionBackend
+{
+public:
+    RefusingBackend(std::unique_ptr<sdk::InstanceExecutionBackend> inner,
+                    const std::atomic_bool &refuse,
+                    std::atomic_int &refusals)
+        : m_inner(std::move(inner))
+        , m_refuse(refuse)
+        , m_refusals(refusals)
+    {
+    }
+
+    bool start(v1::Utf8String *error) override { return m_inner->start(error); }
+    bool execute(std::function<void()> task, v1::Utf8String *error) override
+    {
+        if (!m_refuse.load())
+            return m_inner->execute(std::move(task), error);
+        m_refusals.fetch_add(1);
+        if (error)
+            *error = "refused by test";
+        return false;
+    }
+    bool stop(std::chrono::milliseconds timeout, v1::Utf8String *error) override
+    {
+        return m_inner->stop(timeout, error);
+    }
+
+private:
+    std::unique_ptr<sdk::InstanceExecutionBackend> m_inner;
+    const std::atomic_bool &m_refuse;
+    std::atomic_int &m_refusals;
+};
+
+class RoutedDecodeFactory final : public sdk::AdapterFactory
+{
+public:
+    RoutedDecodeInstance *created = nullptr;
+    std::atomic_bool refuse{false};
+    std::atomic_int refusals{0};
+
+protected:
+    v1::Utf8String pluginType() const override { return "test.routed.decode"; }
+    std::unique_ptr<sdk::InstanceExecutionBackend> createInstanceExecutionBackend(
+        const v1::ExternalId &externalId) override
+    {
+        return std::make_unique<RefusingBackend>(sdk::AdapterFactory::createInstanceExecutionBackend(externalId),
+                                                 refuse, refusals);
+    }
+    std::unique_ptr<sdk::AdapterInstance> createInstance(const v1::ExternalId &) override
+    {
+        auto instance = std::make_unique<RoutedDecodeInstance>();
+        created = instance.get();
+        return instance;
+    }
+};
+
+void testInstanceRequestsDecodeOnBackend()
+{
+    const std::string path = phitest::uniqueSocketPath("routeddecode");
+    auto factory = std::make_unique<RoutedDecodeFactory>();
+    RoutedDecodeFactory *factoryPtr = factory.get();
+    sdk::SidecarHost host(path, std::move(factory));
+    v1::Utf8String err;
+    REQUIRE(host.start(&err));
+
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const std::string config = "{\"command\":258,\"cmdId\":1,\"payload\":{"
+                               "\"adapterId\":1,\"pluginType\":\"test.routed.decode\","
+                               "\"externalId\":\"inst-1\",\"enabled\":true}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 1, config));
+    auto deadline = Clock::now() + std::chrono::seconds(3);
+    while (host.instance("inst-1") == nullptr && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(factoryPtr->created != nullptr);
+    RoutedDecodeInstance *instance = factoryPtr->created;
+
+    // externalId is deliberately not the first member: the routing parse must
+    // find it anywhere in the payload.
+    const std::string invoke = "{\"command\":513,\"cmdId\":2,\"payload\":{"
+                               "\"deviceExternalId\":\"dev-\\\"9\\\"\",\"channelExternalId\":\"ch-2\","
+                               "\"value\":42.5,\"externalId\":\"inst-1\"}}";
+    const std::string action = "{\"command\":514,\"cmdId\":3,\"payload\":{"
+                               "\"externalId\":\"inst-1\",\"actionId\":\"import\","
+                               "\"params\":{\"path\":\"a\\\\b\"}}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 2, invoke));
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 3, action));
+    deadline = Clock::now() + std::chrono::seconds(3);
+    while (instance->invokes.load() < 2 && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(instance->invokes.load() == 2);
+
+    CHECK_MSG(instance->hookThread != std::this_thread::get_id(),
+              "routed request was decoded on the polling thread");
+    CHECK(instance->deviceExternalId == "dev-\"9\"");
+    CHECK(instance->value == 42.5);
+    CHECK(instance->actionParams == "{\"path\":\"a\\\\b\"}");
+
+    // An instance that does not exist is still answered with an error result.
+    const std::string stray = "{\"command\":513,\"cmdId\":4,\"payload\":{"
+                              "\"externalId\":\"inst-missing\",\"deviceExternalId\":\"d\","
+                              "\"channelExternalId\":\"c\",\"value\":1}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 4, stray));
+    v1::FrameHeader header{};
+    std::string payload;
+    bool gotResult = false;
+    deadline = Clock::now() + std::chrono::seconds(3);
+    while (!gotResult && Clock::now() < deadline) {
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+        if (client.readFrame(10, &header, &payload))
+            gotResult = phitest::contains(payload, "Unknown instance externalId: inst-missing");
+    }
+    CHECK_MSG(gotResult, "no error result for an unknown instance");
+
+    // A refused task is answered once, not retried through the inline handler.
+    factoryPtr->refuse = true;
+    const std::string refused = "{\"command\":513,\"cmdId\":5,\"payload\":{"
+                                "\"externalId\":\"inst-1\",\"deviceExternalId\":\"d\","
+                                "\"channelExternalId\":\"c\",\"value\":1}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 5, refused));
+    gotResult = false;
+    deadline = Clock::now() + std::chrono::seconds(3);
+    while (!gotResult && Clock::now() < deadline) {
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+        if (client.readFrame(10, &header, &payload))
+            gotResult = phitest::contains(payload, "Failed to dispatch channel invoke: refused by test");
+    }
+    CHECK_MSG(gotResult, "no error result for a refused task");
+    CHECK_MSG(factoryPtr->refusals.load() == 1, "task offered %d times", factoryPtr->refusals.load());
+    factoryPtr->refuse = false;
+
+    host.stop();
+}
+
+// Exposes the protected send API so tests can drive it from outside.
+class SendingInstance final : public sdk::AdapterInstance
+{
+public:
+    using sdk::AdapterInstance::publishHeldChannelStates;
+    using sdk::AdapterInstance::clearChannelFilter;
+    using sdk::AdapterInstance::setChannelFilter;
+    using sdk::AdapterInstance::setChannelStateDedupe;
+    using sdk::AdapterInstance::sendChannelColorStateUpdated;
+    using sdk::AdapterInstance::sendChannelStateUpdated;
+    using sdk::AdapterInstance::sendChannelStatesUpdated;
+    using sdk::AdapterInstance::sendConnectionStateChanged;
+    using sdk::AdapterInstance::sendError;
+    using sdk::AdapterInstance::sendResult;
+    using sdk::AdapterInstance::setLogDedupe;
+    using sdk::AdapterInstance::flushLogDedupe;
+    using sdk::AdapterInstance::setFlightRecorder;
+    using sdk::AdapterInstance::flushFlightRecorder;
+
+protected:
+    bool start() override { return true; }
+};
+
+class SendingFactory final : public sdk::AdapterFactory
+{
+public:
+    SendingInstance *created = nullptr;
+
+protected:
+    v1::Utf8String pluginType() const override { return "test.identity \"frames\""; }
+    std::unique_ptr<sdk::AdapterInstance> createInstance(const v1::ExternalId &) override
+    {
+        auto instance = std::make_unique<SendingInstance>();
+        created = instance.get();
+        return instance;
+    }
+};
+
+// Instance sends splice identity bytes escaped at bind time (and cached channel
+// state heads); each must match the frame the dispatcher encodes from scratch
+// for an equal id held elsewhere.
+void testInstanceIdentityFramesMatchDispatcher()
+{
+    const std::string path = phitest::uniqueSocketPath("identityframes");
+    auto factory = std::make_unique<SendingFactory>();
+    SendingFactory *factoryPtr = factory.get();
+    sdk::SidecarHost host(path, std::move(factory));
+    v1::Utf8String err;
+    REQUIRE(host.start(&err));
+
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const std::string config = "{\"command\":258,\"cmdId\":1,\"payload\":{"
+                               "\"adapterId\":1,\"pluginType\":\"test.identity \\\"frames\\\"\","
+                               "\"externalId\":\"inst-\\\"1\\\"\\\\\",\"enabled\":true}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 1, config));
+    auto deadline = Clock::now() + std::chrono::seconds(3);
+    while (host.instance("inst-\"1\"\\") == nullptr && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(factoryPtr->created != nullptr);
+    SendingInstance *instance = factoryPtr->created;
+    v1::FrameHeader header{};
+    std::string payload;
+    while (client.readFrame(50, &header, &payload)) {
+    }
+
+    sdk::SidecarDispatcher *dispatcher = host.dispatcher();
+    const v1::ExternalId externalId = instance->externalId();
+    const v1::Utf8String plugin = instance->pluginType();
+    constexpr std::int64_t kTsMs = 1755500000000;
+    const auto sendPair = [&](const char *what, const auto &fromInstance, const auto &fromDispatcher) {
+        CHECK_MSG(fromInstance(), "%s: instance send failed", what);
+        CHECK_MSG(fromDispatcher(), "%s: dispatcher send failed", what);
+        std::string frames[2];
+        for (std::string &frame : frames) {
+            deadline = Clock::now() + std::chrono::seconds(3);
+            while (Clock::now() < deadline) {
+                host.pollOnce(std::chrono::milliseconds(1), nullptr);
+                if (client.readFrame(10, &header, &payload)) {
+                    frame = payload;
+                    break;
+                }
+            }
+        }
+        CHECK_MSG(!frames[0].empty() && frames[0] == frames[1], "%s: instance frame %s != %s",
+                  what, frames[0].c_str(), frames[1].c_str());
+    };
+
+    // Twice: the first send builds the cached channel head, the second reuses it.
+    for (int round = 0; round < 2; ++round) {
+        sendPair("channel state",
+                 [&] { return instance->sendChannelStateUpdated("dev-9", "ch-\t2", 75.5, kTsMs); },
+                 [&] {
+                     return dispatcher->sendChannelStateUpdated(externalId, "dev-9", "ch-\t2", 75.5, kTsMs,
+                                                                nullptr);
+                 });
+    }
+    const sdk::ChannelStateUpdate batched[] = {{"dev-9", "ch-\t2", 76.5, kTsMs}};
+    sendPair("batched state",
+             [&] { return instance->sendChannelStatesUpdated(batched); },
+             [&] {
+                 return dispatcher->sendChannelStateUpdated(externalId, "dev-9", "ch-\t2", 76.5, kTsMs, nullptr);
+             });
+    sendPair("color state",
+             [&] { return instance->sendChannelColorStateUpdated("dev-9", "ch-3", 1.0, 0.5, 0.25, kTsMs); },
+             [&] {
+                 return dispatcher->sendChannelColorStateUpdated(externalId, "dev-9", "ch-3", 1.0, 0.5, 0.25,
+                                                                 kTsMs, nullptr);
+             });
+    sendPair("connection state",
+             [&] { return instance->sendConnectionStateChanged(true); },
+             [&] { return dispatcher->sendConnectionStateChanged(externalId, true, nullptr); });
+    sendPair("error",
+             [&] {
+                 return instance->sendError(sdk::LogCategory::Network, "lost", {}, "ctx", "{}", kTsMs);
+             },
+             [&] {
+                 return dispatcher->sendError(externalId, plugin, sdk::LogCategory::Network, "lost", {}, "ctx",
+                                              "{}", kTsMs, nullptr);
+             });
+
+    host.stop();
+}
+
+void testChannelStateDedupeDropsRepeats()
+{
+    const std::string path = phitest::uniqueSocketPath("statededupe");
+    auto factory = std::make_unique<SendingFactory>();
+    SendingFactory *factoryPtr = factory.get();
+    sdk::SidecarHost host(path, std::move(factory));
+    v1::Utf8String err;
+    REQUIRE(host.start(&err));
+
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const std::string config = "{\"command\":258,\"cmdId\":1,\"payload\":{"
+                               "\"adapterId\":1,\"pluginType\":\"test.identity \\\"frames\\\"\","
+                               "\"externalId\":\"inst-1\",\"enabled\":true}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 1, config));
+    auto deadline = Clock::now() + std::chrono::seconds(3);
+    while (host.instance("inst-1") == nullptr && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(factoryPtr->created != nullptr);
+    SendingInstance *instance = factoryPtr->created;
+    v1::FrameHeader header{};
+    std::string payload;
+    while (client.readFrame(50, &header, &payload)) {
+    }
+
+    // Channel state frames sent since the last call, up to a marker frame.
+    const auto stateFrames = [&]() {
+        CHECK(instance->sendConnectionStateChanged(true));
+        int frames = 0;
+        deadline = Clock::now() + std::chrono::seconds(3);
+        while (Clock::now() < deadline) {
+            host.pollOnce(std::chrono::milliseconds(1), nullptr);
+            if (!client.readFrame(10, &header, &payload))
+                continue;
+            if (phitest::contains(payload, "\"connected\":true"))
+                break;
+            ++frames;
+        }
+        return frames;
+    };
+
+    instance->setChannelStateDedupe({true, std::chrono::milliseconds(300)});
+    // Lenient bool, numeric coercion, exact string: the core's own policy.
+    CHECK(instance->sendChannelStateUpdated("dev", "on", true));
+    CHECK(instance->sendChannelStateUpdated("dev", "on", static_cast<std::int64_t>(1)));
+    CHECK(instance->sendChannelStateUpdated("dev", "on", v1::Utf8String("ON")));
+    CHECK(instance->sendChannelStateUpdated("dev", "on", false));
+    CHECK(instance->sendChannelStateUpdated("dev", "bri", static_cast<std::int64_t>(5)));
+    CHECK(instance->sendChannelStateUpdated("dev", "bri", 5.0));
+    CHECK(instance->sendChannelStateUpdated("dev", "bri", 5.5));
+    CHECK(instance->sendChannelStateUpdated("dev", "name", v1::Utf8String("a")));
+    CHECK(instance->sendChannelStateUpdated("dev", "name", v1::Utf8String("a")));
+    CHECK(instance->sendChannelStateUpdated("dev", "name", v1::Utf8String("A")));
+    CHECK(instance->sendChannelStateUpdated("dev", "name", v1::Utf8String(" A")));
+    CHECK(instance->sendChannelStateUpdated("other", "name", v1::Utf8String("a")));
+    CHECK(instance->sendChannelColorStateUpdated("dev", "color", 1.0, 0.5, 0.25));
+    CHECK(instance->sendChannelColorStateUpdated("dev", "color", 1.0, 0.5, 0.25));
+    CHECK(instance->sendChannelColorStateUpdated("dev", "color", 1.0, 0.5, 0.2));
+    const sdk::ChannelStateUpdate batch[] = {
+        {"dev", "bri", 5.5, 0},
+        {"dev", "temp", 21.0, 0},
+        {"dev", "on", static_cast<std::int64_t>(0), 0},
+    };
+    CHECK(instance->sendChannelStatesUpdated(batch));
+    CHECK_MSG(stateFrames() == 11, "unexpected number of state frames");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(350));
+    CHECK(instance->sendChannelStateUpdated("dev", "bri", 5.5));
+    CHECK(instance->sendChannelStateUpdated("dev", "bri", 5.5));
+    CHECK(stateFrames() == 1);
+
+    const sdk::ChannelStateDedupeStats stats = instance->channelStateDedupeStats();
+    CHECK_MSG(stats.sent == 11 && stats.suppressed == 8 && stats.refreshed == 1,
+              "sent=%llu suppressed=%llu refreshed=%llu", static_cast<unsigned long long>(stats.sent),
+              static_cast<unsigned long long>(stats.suppressed), static_cast<unsigned long long>(stats.refreshed));
+
+    instance->setChannelStateDedupe({});
+    CHECK(instance->sendChannelStateUpdated("dev", "bri", 5.5));
+    CHECK(instance->sendChannelStateUpdated("dev", "bri", 5.5));
+    CHECK(stateFrames() == 2);
+
+    host.stop();
+}
+
+// Repeats inside a window collapse into the first line plus a count; errors
+// and incidents always go out, with their repeat count.
+void testLogDedupeCountsSuppressed()
+{
+    const std::string path = phitest::uniqueSocketPath("logdedupe");
+    auto factory = std::make_unique<SendingFactory>();
+    SendingFactory *factoryPtr = factory.get();
+    sdk::SidecarHost host(path, std::move(factory));
+    v1::Utf8String err;
+    REQUIRE(host.start(&err));
+
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const std::string config = "{\"command\":258,\"cmdId\":1,\"payload\":{\"adapterId\":1,\"adapter\":{"
+                               "\"externalId\":\"inst-1\",\"pluginType\":\"test.identity \\\"frames\\\"\","
+                               "\"flags\":4,\"meta\":{\"logging\":{\"minLevel\":\"trace\"}}}}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 1, config));
+    auto deadline = Clock::now() + std::chrono::seconds(3);
+    while ((host.instance("inst-1") == nullptr || !factoryPtr->created->hasConfig()) && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(factoryPtr->created != nullptr);
+    SendingInstance &instance = *factoryPtr->created;
+    v1::FrameHeader header{};
+    std::string payload;
+    while (client.readFrame(50, &header, &payload)) {
+    }
+
+    sdk::LogDedupeOptions options;
+    options.window = std::chrono::minutes(1);
+    options.traceSampleEvery = 3;
+    instance.setLogDedupe(options);
+
+    for (int i = 0; i < 5; ++i)
+        CHECK(instance.log(sdk::LogLevel::Warn, sdk::LogCategory::Network, "timeout talking to %1", {i}));
+    for (int i = 0; i < 3; ++i)
+        CHECK(instance.log(sdk::LogLevel::Error, sdk::LogCategory::Network, "bridge lost"));
+    CHECK(instance.sendError(sdk::LogCategory::Device, "incident"));
+    CHECK(instance.sendError(sdk::LogCategory::Device, "incident"));
+    for (int i = 0; i < 7; ++i)
+        CHECK(instance.log(sdk::LogLevel::Trace, sdk::LogCategory::Device, "step " + std::to_string(i)));
+    CHECK(instance.flushLogDedupe());
+    CHECK(instance.sendConnectionStateChanged(true));
+
+    // `message` and `fields` of each log frame, up to the marker.
+    std::vector<std::string> logs;
+    deadline = Clock::now() + std::chrono::seconds(3);
+    while (Clock::now() < deadline) {
+        host.pollOnce(std::chrono::milliseconds(1), nullptr);
+        if (!client.readFrame(10, &header, &payload))
+            continue;
+        if (phitest::contains(payload, "\"connected\":true"))
+            break;
+        const std::size_t message = payload.find("\"message\":");
+        const std::size_t fields = payload.find("\"fields\":");
+        std::string line = payload.substr(message, payload.find(',', message) - message);
+        if (fields != std::string::npos)
+            line += " " + payload.substr(fields, payload.find('}', fields) + 1 - fields);
+        logs.push_back(line);
+    }
+    const std::vector<std::string> expected = {
+        "\"message\":\"timeout talking to %1\" \"fields\":{}",
+        "\"message\":\"bridge lost\" \"fields\":{}",
+        "\"message\":\"bridge lost\" \"fields\":{\"repeatCount\":2}",
+        "\"message\":\"bridge lost\" \"fields\":{\"repeatCount\":3}",
+        "\"message\":\"incident\" \"fields\":{}",
+        "\"message\":\"incident\" \"fields\":{\"repeatCount\":2}",
+        "\"message\":\"step 0\" \"fields\":{}",
+        "\"message\":\"step 3\" \"fields\":{\"suppressedCount\":2}",
+        "\"message\":\"step 6\" \"fields\":{\"suppressedCount\":2}",
+        "\"message\":\"timeout talking to %1\" \"fields\":{\"suppressedCount\":4}",
+    };
+    CHECK_MSG(logs == expected, "got %zu log(s), first=%s", logs.size(), logs.empty() ? "-" : logs.front().c_str());
+    for (std::size_t i = 0; i < logs.size() && i < expected.size(); ++i)
+        CHECK_MSG(logs[i] == expected[i], "log %zu: %s", i, logs[i].c_str());
+
+    host.stop();
+}
+
+void testFlightRecorderKeepsFilteredLogs()
+{
+    const std::string path = phitest::uniqueSocketPath("flightrec");
+    auto factory = std::make_unique<SendingFactory>();
+    SendingFactory *factoryPtr = factory.get();
+    sdk::SidecarHost host(path, std::move(factory));
+    v1::Utf8String err;
+    REQUIRE(host.start(&err));
+
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const std::string config = "{\"command\":258,\"cmdId\":1,\"payload\":{\"adapterId\":1,\"adapter\":{"
+                               "\"externalId\":\"inst-1\",\"pluginType\":\"test.identity \\\"frames\\\"\","
+                               "\"flags\":4,\"meta\":{\"logging\":{\"minLevel\":\"info\"}}}}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 1, config));
+    auto deadline = Clock::now() + std::chrono::seconds(3);
+    while ((host.instance("inst-1") == nullptr || !factoryPtr->created->hasConfig()) && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(factoryPtr->created != nullptr);
+    SendingInstance &instance = *factoryPtr->created;
+    v1::FrameHeader header{};
+    std::string payload;
+    while (client.readFrame(50, &header, &payload)) {
+    }
+
+    CHECK(!instance.isLogEnabled(sdk::LogLevel::Debug, sdk::LogCategory::Device));
+    sdk::FlightRecorderOptions options;
+    options.capacity = 6; // rounded up to 8
+    options.minLevel = sdk::LogLevel::Debug;
+    options.incidentEntries = 3;
+    instance.setFlightRecorder(options);
+    CHECK(instance.isLogEnabled(sdk::LogLevel::Debug, sdk::LogCategory::Device));
+    CHECK(!instance.isLogEnabled(sdk::LogLevel::Trace, sdk::LogCategory::Device));
+
+    for (int i = 0; i < 10; ++i)
+        CHECK(instance.log(sdk::LogLevel::Debug, sdk::LogCategory::Device, "step %1", {i}, "demo.poll"));
+    CHECK(instance.log(sdk::LogLevel::Trace, sdk::LogCategory::Device, "not recorded"));
+    CHECK(instance.log(sdk::LogLevel::Info, sdk::LogCategory::Device, "visible"));
+    CHECK(instance.sendError(sdk::LogCategory::Device, "bridge lost"));
+    CHECK(instance.log(sdk::LogLevel::Debug, sdk::LogCategory::Device, "after", {true, 1.5, v1::Utf8String("x")}, {},
+                       "{\"attempt\":2}"));
+    CHECK(instance.log(sdk::LogLevel::Debug, sdk::LogCategory::Device, std::string(300, 'm')));
+    std::int64_t seq = 7;
+    CHECK(instance.flushFlightRecorder("stream-1", "cmd.stream.start", &seq));
+    CHECK(seq == 8);
+
+    std::vector<std::string> frames;
+    deadline = Clock::now() + std::chrono::seconds(3);
+    while (frames.size() < 3 && Clock::now() < deadline) {
+        host.pollOnce(std::chrono::milliseconds(1), nullptr);
+        if (client.readFrame(10, &header, &payload))
+            frames.push_back(payload);
+    }
+    REQUIRE(frames.size() == 3);
+    CHECK_MSG(phitest::contains(frames[0], "\"message\":\"visible\""), "frame=%s", frames[0].c_str());
+    CHECK_MSG(phitest::contains(frames[1], "\"message\":\"bridge lost\"")
+                  && phitest::contains(frames[1], "\"fields\":{\"flightRecorder\":[{")
+                  && phitest::contains(frames[1], "\"params\":[7]") && phitest::contains(frames[1], "\"params\":[9]")
+                  && !phitest::contains(frames[1], "\"params\":[6]"),
+              "incident=%s", frames[1].c_str());
+    CHECK(!phitest::contains(frames[1], "not recorded"));
+    CHECK_MSG(phitest::contains(frames[2], "\"seq\":7")
+                  && phitest::contains(frames[2], "\"message\":\"after\",\"ctx\":\"\",\"params\":[true,1.5,\"x\"],"
+                                                  "\"fields\":{\"attempt\":2}}")
+                  && phitest::contains(frames[2], "\"truncated\":true}],\"dropped\":0}")
+                  && !phitest::contains(frames[2], "step"),
+              "stream=%s", frames[2].c_str());
+
+    host.stop();
+}
+
+void testNumericChannelFilter()
+{
+    v1::Channel stepped;
+    stepped.stepValue = 0.5;
+    CHECK(sdk::makeNumericChannelFilter(stepped).quantizationStep == 0.5);
+    v1::Channel ranged;
+    ranged.minValue = -100.0;
+    ranged.maxValue = 900.0;
+    CHECK(sdk::makeNumericChannelFilter(ranged).absoluteDeadband == 1.0);
+    CHECK(sdk::makeNumericChannelFilter(v1::Channel{}).absoluteDeadband == 0.0);
+
+    const std::string path = phitest::uniqueSocketPath("numericfilter");
+    auto factory = std::make_unique<SendingFactory>();
+    SendingFactory *factoryPtr = factory.get();
+    sdk::SidecarHost host(path, std::move(factory));
+    v1::Utf8String err;
+    REQUIRE(host.start(&err));
+
+    TestClient client;
+    REQUIRE(client.connectTo(path));
+    const std::string config = "{\"command\":258,\"cmdId\":1,\"payload\":{"
+                               "\"adapterId\":1,\"pluginType\":\"test.identity \\\"frames\\\"\","
+                               "\"externalId\":\"inst-1\",\"enabled\":true}}";
+    REQUIRE(client.sendFrame(v1::MessageType::Request, 1, config));
+    auto deadline = Clock::now() + std::chrono::seconds(3);
+    while (host.instance("inst-1") == nullptr && Clock::now() < deadline)
+        host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    REQUIRE(factoryPtr->created != nullptr);
+    SendingInstance *instance = factoryPtr->created;
+    v1::FrameHeader header{};
+    std::string payload;
+    while (client.readFrame(50, &header, &payload)) {
+    }
+
+    // `"channelExternalId":...,"value":...` of the state frames sent since
+    // the last call, up to a marker frame.
+    const auto published = [&]() {
+        CHECK(instance->sendConnectionStateChanged(true));
+        std::vector<std::string> values;
+        deadline = Clock::now() + std::chrono::seconds(3);
+        while (Clock::now() < deadline) {
+            host.pollOnce(std::chrono::milliseconds(1), nullptr);
+            if (!client.readFrame(10, &header, &payload))
+                continue;
+            if (phitest::contains(payload, "\"connected\":true"))
+                break;
+            const std::size_t begin = payload.find("\"channelExternalId\"");
+            const std::size_t end = payload.find(",\"tsMs\"");
+            values.push_back(payload.substr(begin, end - begin));
+        }
+        return values;
+    };
+    const auto expect = [](const std::vector<std::string> &values, const std::vector<std::string> &expected) {
+        CHECK_MSG(values == expected, "published %zu value(s), first=%s", values.size(),
+                  values.empty() ? "-" : values.front().c_str());
+    };
+
+    sdk::NumericChannelFilter power;
+    power.absoluteDeadband = 0.5;
+    power.quantizationStep = 0.1;
+    instance->setChannelFilter("dev", "power", power);
+    sdk::NumericChannelFilter rssi;
+    rssi.quantizationStep = 5;
+    instance->setChannelFilter("dev", "rssi", rssi);
+    sdk::NumericChannelFilter temp;
+    temp.relativeDeadband = 0.01;
+    instance->setChannelFilter("dev", "temp", temp);
+
+    CHECK(instance->sendChannelStateUpdated("dev", "power", 100.04));
+    CHECK(instance->sendChannelStateUpdated("dev", "power", 100.3));
+    CHECK(instance->sendChannelStateUpdated("dev", "power", 100.56));
+    CHECK(instance->sendChannelStateUpdated("dev", "power", v1::Utf8String("n/a")));
+    CHECK(instance->sendChannelStateUpdated("dev", "rssi", static_cast<std::int64_t>(-67)));
+    CHECK(instance->sendChannelStateUpdated("dev", "rssi", static_cast<std::int64_t>(-66)));
+    CHECK(instance->sendChannelStateUpdated("dev", "temp", 20.0));
+    CHECK(instance->sendChannelStateUpdated("dev", "temp", 20.1));
+    CHECK(instance->sendChannelStateUpdated("dev", "other", 20.1));
+    const sdk::ChannelStateUpdate batch[] = {
+        {"dev", "temp", 20.5, 0},
+        {"dev", "power", 100.61, 0},
+    };
+    CHECK(instance->sendChannelStatesUpdated(batch));
+    expect(published(), {
+        "\"channelExternalId\":\"power\",\"value\":100",
+        "\"channelExternalId\":\"power\",\"value\":100.6",
+        "\"channelExternalId\":\"power\",\"value\":\"n/a\"",
+        "\"channelExternalId\":\"rssi\",\"value\":-65",
+        "\"channelExternalId\":\"temp\",\"value\":20",
+        "\"channelExternalId\":\"other\",\"value\":20.1",
+        "\"channelExternalId\":\"temp\",\"value\":20.5",
+    });
+
+    // Rate limit with a held change, which the poll loop publishes once due
+    // without another send.
+    const auto idle = [&](std::chrono::milliseconds duration) {
+        const auto until = Clock::now() + duration;
+        while (Clock::now() < until)
+            host.pollOnce(std::chrono::milliseconds(10), nullptr);
+    };
+    sdk::NumericChannelFilter lux;
+    lux.minInterval = std::chrono::milliseconds(200);
+    instance->setChannelFilter("dev", "lux", lux);
+    CHECK(instance->sendChannelStateUpdated("dev", "lux", 10.0));
+    CHECK(instance->sendChannelStateUpdated("dev", "lux", 20.0));
+    CHECK(instance->publishHeldChannelStates());
+    expect(published(), {"\"channelExternalId\":\"lux\",\"value\":10"});
+    idle(std::chrono::milliseconds(300));
+    expect(published(), {"\"channelExternalId\":\"lux\",\"value\":20"});
+
+    // A held change that falls back to the published value is dropped.
+    CHECK(instance->sendChannelStateUpdated("dev", "lux", 30.0));
+    CHECK(instance->sendChannelStateUpdated("dev", "lux", 20.0));
+    idle(std::chrono::milliseconds(300));
+    CHECK(instance->publishHeldChannelStates());
+    expect(published(), {});
+
+    // Max-age forcing of an unchanged value, also from the poll loop.
+    sdk::NumericChannelFilter volt;
+    volt.maxAge = std::chrono::milliseconds(200);
+    instance->setChannelFilter("dev", "volt", volt);
+    CHECK(instance->sendChannelStateUpdated("dev", "volt", 230.0));
+    CHECK(instance->sendChannelStateUpdated("dev", "volt", 230.0));
+    expect(published(), {"\"channelExternalId\":\"volt\",\"value\":230"});
+    idle(std::chrono::milliseconds(300));
+    CHECK(instance->sendChannelStateUpdated("dev", "volt", 230.0));
+    expect(published(), {"\"channelExternalId\":\"volt\",\"value\":230"});
+    instance->clearChannelFilter("dev", "volt");
+
+    // Integers beyond 2^53 are compared and rounded exactly.
+    sdk::NumericChannelFilter ticks;
+    ticks.absoluteDeadband = 0.5;
+    instance->setChannelFilter("dev", "ticks", ticks);
+    sdk::NumericChannelFilter energy;
+    energy.quantizationStep = 10;
+    instance->setChannelFilter("dev", "energy", energy);
+    CHECK(instance->sendChannelStateUpdated("dev", "ticks", static_cast<std::int64_t>(4611686018427387904)));
+    CHECK(instance->sendChannelStateUpdated("dev", "ticks", static_cast<std::int64_t>(4611686018427387905)));
+    CHECK(instance->sendChannelStateUpdated("dev", "energy", static_cast<std::int64_t>(4611686018427387911)));
+    CHECK(instance->sendChannelStateUpdated("dev", "energy", std::numeric_limits<std::int64_t>::max()));
+    expect(published(), {
+        "\"channelExternalId\":\"ticks\",\"value\":4611686018427387904",
+        "\"channelExternalId\":\"ticks\",\"value\":4611686018427387905",
+        "\"channelExternalId\":\"energy\",\"value\":4611686018427387910",
+        "\"channelExternalId\":\"energy\",\"value\":9223372036854775800",
+    });
+
+    host.stop();
+}
+
 } // namespace
 
 int main()
@@ -710,12 +1666,21 @@ int main()
     testWakeupLatency();
     testWriteDeadlineOnStalledPeer();
     testQueueCapShedsOldestLogFrames();
+    testLogRingsKeepThreadOrder();
+    testLogThrottleFollowsBacklog();
     testStopInterruptsBlockingPoll();
     testFactoryBackendKeepsPollResponsive();
     testFactoryBackendDefaultsToInline();
     testAbandonedThreadIsReapedNotDetached();
+    testPooledBackendsKeepStrandOrder();
     testShutdownBudgetIsShared();
     testStopRequestReachesBlockedInstance();
+    testInstanceRequestsDecodeOnBackend();
+    testInstanceIdentityFramesMatchDispatcher();
+    testChannelStateDedupeDropsRepeats();
+    testNumericChannelFilter();
+    testLogDedupeCountsSuppressed();
+    testFlightRecorderKeepsFilteredLogs();
 
     if (phitest::g_failures == 0) {
         std::printf("runtime_tests: all passed\n");